@@ -0,0 +1,248 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using UnityEngine;
+using Debug = UnityEngine.Debug;
+
+/// <summary>
+/// Shapes a generated document (one paragraph per line) through
+/// ut_hb_shape_paragraphs at increasing thread counts and reports wall time
+/// and speedup over one thread, with the word cache off and on.
+///
+/// Setup:
+///   1. Add to any GameObject in a scene.
+///   2. Set Font Path (absolute, or relative to the project folder).
+///   3. Play → press Space or click "Run Benchmark" in Inspector.
+/// </summary>
+public class ParagraphShapingBenchmark : MonoBehaviour
+{
+#if (UNITY_IOS || UNITY_WEBGL) && !UNITY_EDITOR
+    const string NativeLib = "__Internal";
+#else
+    const string NativeLib = "unitext_native";
+#endif
+
+    const int HbMemoryModeReadonly = 1;
+    const int HbDirectionLtr = 4;
+    const uint HbScriptLatin = 0x4C61746E; // 'Latn'
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct Run
+    {
+        public IntPtr font;
+        public uint offset;
+        public int length;
+        public int direction;
+        public uint scriptTag;
+        public IntPtr language;
+        public uint flags;
+        public IntPtr features;
+        public uint numFeatures;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct Glyph
+    {
+        public uint glyphId;
+        public uint cluster;
+        public int xAdvance;
+        public int yAdvance;
+        public int xOffset;
+        public int yOffset;
+        public int runIndex;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct Paragraph
+    {
+        public IntPtr text;
+        public int textLength;
+        public int textUnit;        // 4 (or 0) = code points, 2 = UTF-16, 1 = UTF-8
+        public IntPtr runs;
+        public int runCount;
+        public int clusterLevel;    // buffer settings; 0 = HarfBuzz defaults
+        public uint replacement;
+        public uint invisible;
+        public uint notFound;
+        public IntPtr outGlyphs;
+        public int capacity;
+        public int glyphCount;
+        public int result;
+    }
+
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_blob_create(IntPtr data, uint length, int mode, IntPtr userData, IntPtr destroy);
+    [DllImport(NativeLib)] static extern void ut_hb_blob_destroy(IntPtr blob);
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_face_create(IntPtr blob, uint index);
+    [DllImport(NativeLib)] static extern void ut_hb_face_destroy(IntPtr face);
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_font_create(IntPtr face);
+    [DllImport(NativeLib)] static extern void ut_hb_font_destroy(IntPtr font);
+    [DllImport(NativeLib)] static extern int ut_hb_shape_paragraphs(IntPtr paragraphs, int count, int maxThreads);
+    [DllImport(NativeLib)] static extern void ut_hb_word_cache_enable(IntPtr maxBytes); // C long
+    [DllImport(NativeLib)]
+    static extern void ut_hb_word_cache_stats(out int entries, out IntPtr bytes, out uint hits, out uint misses, out uint fallbacks); // bytes: C long
+
+    [Header("Document")]
+    public string fontPath = "";
+    public int lines = 10000;
+    [TextArea(3, 6)]
+    public string vocabulary = "the quick brown fox jumps over lazy dog message sent received today yesterday " +
+                               "settings volume audio video language continue cancel player level score inventory";
+    public int minWords = 4;
+    public int maxWords = 16;
+
+    [Header("Settings")]
+    public int iterations = 5;
+    public int wordCacheBytes = 4 << 20;
+
+    [Header("Status")]
+    [SerializeField, TextArea(15, 30)] string lastResult = "";
+
+    readonly StringBuilder report = new();
+
+    void Update()
+    {
+        if (Input.GetKeyDown(KeyCode.Space))
+            RunBenchmark();
+    }
+
+    [ContextMenu("Run Benchmark")]
+    public void RunBenchmark()
+    {
+        report.Clear();
+        report.AppendLine("═══════════════════════════════════════════════");
+        report.AppendLine("         PARAGRAPH SHAPING BENCHMARK");
+        report.AppendLine("═══════════════════════════════════════════════");
+
+        string fullPath = Path.IsPathRooted(fontPath) ? fontPath : Path.Combine(Application.dataPath, "..", fontPath);
+        if (!File.Exists(fullPath))
+        {
+            report.AppendLine($"  {fontPath}: not found");
+            Finish();
+            return;
+        }
+
+        byte[] data = File.ReadAllBytes(fullPath);
+        GCHandle dataPin = GCHandle.Alloc(data, GCHandleType.Pinned);
+        IntPtr blob = ut_hb_blob_create(dataPin.AddrOfPinnedObject(), (uint)data.Length, HbMemoryModeReadonly, IntPtr.Zero, IntPtr.Zero);
+        IntPtr face = ut_hb_face_create(blob, 0);
+        IntPtr font = ut_hb_font_create(face);
+        try
+        {
+            RunDocument(font);
+        }
+        finally
+        {
+            ut_hb_font_destroy(font);
+            ut_hb_face_destroy(face);
+            ut_hb_blob_destroy(blob);
+            dataPin.Free();
+        }
+        Finish();
+    }
+
+    void RunDocument(IntPtr font)
+    {
+        // One LTR run per line over a shared codepoint array; each line's glyph
+        // slice gets 2× its length, plenty for Latin text.
+        string[] words = vocabulary.Split(' ', StringSplitOptions.RemoveEmptyEntries);
+        var random = new System.Random(1);
+        var lineStarts = new int[lines + 1];
+        var text = new StringBuilder();
+        for (int i = 0; i < lines; i++)
+        {
+            lineStarts[i] = text.Length;
+            int count = random.Next(minWords, maxWords + 1);
+            for (int w = 0; w < count; w++)
+            {
+                if (w > 0) text.Append(' ');
+                text.Append(words[random.Next(words.Length)]);
+            }
+        }
+        lineStarts[lines] = text.Length;
+
+        var codepoints = new uint[text.Length];
+        for (int i = 0; i < text.Length; i++) codepoints[i] = text[i];
+        var runs = new Run[lines];
+        var glyphStarts = new int[lines + 1];
+        for (int i = 0; i < lines; i++)
+        {
+            runs[i] = new Run { font = font, length = -1, direction = HbDirectionLtr, scriptTag = HbScriptLatin };
+            glyphStarts[i + 1] = glyphStarts[i] + 2 * (lineStarts[i + 1] - lineStarts[i]);
+        }
+        var glyphs = new Glyph[glyphStarts[lines]];
+        var paragraphs = new Paragraph[lines];
+
+        GCHandle cpPin = GCHandle.Alloc(codepoints, GCHandleType.Pinned);
+        GCHandle runPin = GCHandle.Alloc(runs, GCHandleType.Pinned);
+        GCHandle glyphPin = GCHandle.Alloc(glyphs, GCHandleType.Pinned);
+        GCHandle paraPin = GCHandle.Alloc(paragraphs, GCHandleType.Pinned);
+        try
+        {
+            IntPtr cpBase = cpPin.AddrOfPinnedObject();
+            IntPtr runBase = runPin.AddrOfPinnedObject();
+            IntPtr glyphBase = glyphPin.AddrOfPinnedObject();
+            int runSize = Marshal.SizeOf<Run>(), glyphSize = Marshal.SizeOf<Glyph>();
+            for (int i = 0; i < lines; i++)
+            {
+                paragraphs[i].text = cpBase + lineStarts[i] * sizeof(uint);
+                paragraphs[i].textLength = lineStarts[i + 1] - lineStarts[i];
+                paragraphs[i].runs = runBase + i * runSize;
+                paragraphs[i].runCount = 1;
+                paragraphs[i].outGlyphs = glyphBase + glyphStarts[i] * glyphSize;
+                paragraphs[i].capacity = glyphStarts[i + 1] - glyphStarts[i];
+            }
+
+            IntPtr paraBase = paraPin.AddrOfPinnedObject();
+            if (ut_hb_shape_paragraphs(paraBase, lines, 0) != 0)
+            {
+                report.AppendLine("  shaping failed (a line outgrew 2× its length, or bad font)");
+                return;
+            }
+            int totalGlyphs = 0;
+            foreach (var p in paragraphs) totalGlyphs += p.glyphCount;
+            report.AppendLine($"  {Path.GetFileName(fontPath)}: {lines} lines, {codepoints.Length} codepoints, {totalGlyphs} glyphs");
+            report.AppendLine($"    {"Threads",-9}{"Word cache",-12}{"ms",10}{"Speedup",10}");
+
+            int cores = SystemInfo.processorCount;
+            foreach (bool cache in new[] { false, true })
+            {
+                ut_hb_word_cache_enable((IntPtr)(cache ? wordCacheBytes : 0));
+                double baseline = 0;
+                for (int threads = 1; ; threads = Math.Min(threads * 2, cores))
+                {
+                    ut_hb_shape_paragraphs(paraBase, lines, threads); // warm-up (fills the word cache)
+                    var sw = Stopwatch.StartNew();
+                    for (int it = 0; it < iterations; it++)
+                        ut_hb_shape_paragraphs(paraBase, lines, threads);
+                    double ms = sw.Elapsed.TotalMilliseconds / iterations;
+                    if (threads == 1) baseline = ms;
+                    report.AppendLine($"    {threads,-9}{(cache ? "on" : "off"),-12}{ms,10:F2}{baseline / ms,9:F2}×");
+                    if (threads >= cores) break;
+                }
+                if (cache)
+                {
+                    ut_hb_word_cache_stats(out int entries, out IntPtr bytes, out uint hits, out uint misses, out uint fallbacks);
+                    float rate = hits + misses > 0 ? 100f * hits / (hits + misses) : 0f;
+                    report.AppendLine($"    word cache: {entries} entries, {bytes.ToInt64() / 1024} KB, {rate:F1}% hits, {fallbacks} fallback runs");
+                }
+            }
+            ut_hb_word_cache_enable(IntPtr.Zero);
+        }
+        finally
+        {
+            paraPin.Free();
+            glyphPin.Free();
+            runPin.Free();
+            cpPin.Free();
+        }
+    }
+
+    void Finish()
+    {
+        report.AppendLine("═══════════════════════════════════════════════");
+        lastResult = report.ToString();
+        Debug.Log(lastResult);
+    }
+}
@@ -0,0 +1,152 @@
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using UnityEngine;
+using Debug = UnityEngine.Debug;
+
+/// <summary>
+/// Compares the native SDF backends (coverage EDT, FreeType sdf, FreeType bsdf,
+/// analytic) across a font corpus: mean render time per glyph and max / mean
+/// distance error in pixels against the analytic (exact outline) reference.
+///
+/// Setup:
+///   1. Add to any GameObject in a scene.
+///   2. List font files in Font Paths (absolute, or relative to the project folder).
+///   3. Play → press Space or click "Run Benchmark" in Inspector.
+/// </summary>
+public class SdfBackendBenchmark : MonoBehaviour
+{
+#if (UNITY_IOS || UNITY_WEBGL) && !UNITY_EDITOR
+    const string NativeLib = "__Internal";
+#else
+    const string NativeLib = "unitext_native";
+#endif
+
+    const int FtLoadNoHinting = 1 << 1;
+    static readonly string[] BackendNames = { "EDT", "FT sdf", "FT bsdf", "Analytic" };
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct BenchStats
+    {
+        public double usPerGlyph;
+        public float maxError;
+        public float meanError;
+        public int glyphs;
+        public int failures;
+    }
+
+    [DllImport(NativeLib)] static extern int ut_ft_init(out IntPtr library);
+    [DllImport(NativeLib)] static extern int ut_ft_done(IntPtr library);
+    [DllImport(NativeLib)] static extern int ut_ft_new_memory_face(IntPtr library, IntPtr data, IntPtr size, IntPtr faceIndex, out IntPtr face); // C long
+    [DllImport(NativeLib)] static extern int ut_ft_done_face(IntPtr face);
+    [DllImport(NativeLib)] static extern uint ut_ft_get_char_index(IntPtr face, uint charcode);
+    [DllImport(NativeLib)] static extern int ut_ft_set_pixel_sizes(IntPtr face, uint width, uint height);
+    [DllImport(NativeLib)]
+    static extern int ut_sdf_bench_backend(IntPtr face, uint[] glyphs, int count, int loadFlags, int spread,
+                                           int backend, int iterations, out BenchStats stats);
+
+    [Header("Corpus")]
+    public string[] fontPaths = { };
+    public string characters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789@&%?";
+
+    [Header("Settings")]
+    public int[] pixelSizes = { 16, 32, 64 };
+    [Tooltip("Spread in pixels per size = size / spreadDivisor (FreeType accepts 2..32).")]
+    public int spreadDivisor = 8;
+    public int iterations = 3;
+
+    [Header("Status")]
+    [SerializeField, TextArea(15, 30)] string lastResult = "";
+
+    readonly StringBuilder report = new();
+
+    void Update()
+    {
+        if (Input.GetKeyDown(KeyCode.Space))
+            RunBenchmark();
+    }
+
+    [ContextMenu("Run Benchmark")]
+    public void RunBenchmark()
+    {
+        report.Clear();
+        report.AppendLine("═══════════════════════════════════════════════");
+        report.AppendLine("            SDF BACKEND BENCHMARK");
+        report.AppendLine("═══════════════════════════════════════════════");
+
+        if (ut_ft_init(out IntPtr library) != 0)
+        {
+            report.AppendLine("  FreeType init failed");
+            Finish();
+            return;
+        }
+
+        foreach (string path in fontPaths)
+        {
+            string fullPath = Path.IsPathRooted(path) ? path : Path.Combine(Application.dataPath, "..", path);
+            if (!File.Exists(fullPath))
+            {
+                report.AppendLine($"  {path}: not found");
+                continue;
+            }
+            RunFont(library, Path.GetFileName(path), File.ReadAllBytes(fullPath));
+        }
+
+        ut_ft_done(library);
+        Finish();
+    }
+
+    void RunFont(IntPtr library, string name, byte[] data)
+    {
+        GCHandle pin = GCHandle.Alloc(data, GCHandleType.Pinned);
+        try
+        {
+            if (ut_ft_new_memory_face(library, pin.AddrOfPinnedObject(), (IntPtr)data.Length, IntPtr.Zero, out IntPtr face) != 0)
+            {
+                report.AppendLine($"  {name}: not a font");
+                return;
+            }
+
+            var glyphs = new uint[characters.Length];
+            int count = 0;
+            foreach (char c in characters)
+            {
+                uint glyph = ut_ft_get_char_index(face, c);
+                if (glyph != 0) glyphs[count++] = glyph;
+            }
+
+            report.AppendLine($"  {name} ({count} glyphs)");
+            report.AppendLine($"    {"Size",-6}{"Backend",-10}{"µs/glyph",12}{"Max px",10}{"Mean px",10}{"Failed",8}");
+
+            foreach (int size in pixelSizes)
+            {
+                ut_ft_set_pixel_sizes(face, 0, (uint)size);
+                int spread = Mathf.Clamp(size / Mathf.Max(1, spreadDivisor), 2, 32);
+                for (int backend = 0; backend < BackendNames.Length; backend++)
+                {
+                    if (count == 0 || ut_sdf_bench_backend(face, glyphs, count, FtLoadNoHinting, spread,
+                                                           backend, iterations, out BenchStats s) != 0)
+                    {
+                        report.AppendLine($"    {size,-6}{BackendNames[backend],-10}  not available");
+                        continue;
+                    }
+                    report.AppendLine($"    {size,-6}{BackendNames[backend],-10}{s.usPerGlyph,12:F1}{s.maxError,10:F3}{s.meanError,10:F4}{s.failures,8}");
+                }
+            }
+
+            ut_ft_done_face(face);
+        }
+        finally
+        {
+            pin.Free();
+        }
+    }
+
+    void Finish()
+    {
+        report.AppendLine("═══════════════════════════════════════════════");
+        lastResult = report.ToString();
+        Debug.Log(lastResult);
+    }
+}
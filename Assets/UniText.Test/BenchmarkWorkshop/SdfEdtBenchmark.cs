@@ -0,0 +1,211 @@
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using UnityEngine;
+using Debug = UnityEngine.Debug;
+
+/// <summary>
+/// Measures the native 2D EDT used by SDF glyph rendering on synthetic square grids.
+/// Compares the strided column pass against the cache-blocked (tiled transpose) one,
+/// and the tiled transform against its narrow-band form (spread = size / 16),
+/// in float and in fixed point (integer envelope, for cores with slow float division).
+/// With fonts listed, also renders their glyphs as R8 and R16 SDF tiles with the float
+/// and the fixed-point EDT: time per glyph and texel difference in format codes
+/// (R16 always renders on the float EDT, so it should report 1x and 0).
+/// Starts with a check of the fixed-point kernel against the float one on sites just
+/// below the narrow-band cutoff (spreads 1..256); it should report 0 disagreeing texels.
+///
+/// Setup:
+///   1. Add to any GameObject in a scene.
+///   2. Optionally list font files in Font Paths (absolute, or relative to the project folder).
+///   3. Play → press Space or click "Run Benchmark" in Inspector.
+/// </summary>
+public class SdfEdtBenchmark : MonoBehaviour
+{
+#if (UNITY_IOS || UNITY_WEBGL) && !UNITY_EDITOR
+    const string NativeLib = "__Internal";
+#else
+    const string NativeLib = "unitext_native";
+#endif
+
+    const int VariantStrided = 0;
+    const int VariantTiled = 1;
+    const int VariantBand = 2;
+    const int VariantBandInt = 3;
+
+    const int FtLoadNoHinting = 1 << 1;
+    const int FormatR8 = 1;
+    const int FormatR16 = 2;
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct GlyphStats
+    {
+        public double usFloat;
+        public double usInt;
+        public int maxDiff;
+        public float meanDiff;
+        public long texels;
+        public long differing;
+        public int glyphs;
+        public int failures;
+    }
+
+    [DllImport(NativeLib)]
+    static extern double ut_sdf_bench_edt(int size, int iterations, int variant);
+    [DllImport(NativeLib)] static extern int ut_sdf_check_edt_fix(int maxSpread);
+
+    [DllImport(NativeLib)] static extern int ut_ft_init(out IntPtr library);
+    [DllImport(NativeLib)] static extern int ut_ft_done(IntPtr library);
+    [DllImport(NativeLib)] static extern int ut_ft_new_memory_face(IntPtr library, IntPtr data, IntPtr size, IntPtr faceIndex, out IntPtr face); // C long
+    [DllImport(NativeLib)] static extern int ut_ft_done_face(IntPtr face);
+    [DllImport(NativeLib)] static extern uint ut_ft_get_char_index(IntPtr face, uint charcode);
+    [DllImport(NativeLib)] static extern int ut_ft_set_pixel_sizes(IntPtr face, uint width, uint height);
+    [DllImport(NativeLib)]
+    static extern int ut_sdf_bench_edt_glyphs(IntPtr face, uint[] glyphs, int count, int loadFlags, int spread,
+                                              int format, int iterations, out GlyphStats stats);
+
+    [Header("Settings")]
+    public int[] gridSizes = { 32, 64, 128, 256, 512, 1024 };
+    [Tooltip("Transforms per grid size; large grids run proportionally fewer.")]
+    public int iterations = 50;
+    public int warmupIterations = 2;
+
+    [Header("Glyph Set")]
+    public string[] fontPaths = { };
+    public string characters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789@&%?";
+    public int[] pixelSizes = { 32, 64, 128 };
+    [Tooltip("Spread in pixels per size = size / spreadDivisor.")]
+    public int spreadDivisor = 8;
+    public int glyphIterations = 3;
+
+    [Header("Status")]
+    [SerializeField, TextArea(15, 30)] string lastResult = "";
+
+    readonly StringBuilder report = new();
+
+    void Update()
+    {
+        if (Input.GetKeyDown(KeyCode.Space))
+            RunBenchmark();
+    }
+
+    [ContextMenu("Run Benchmark")]
+    public void RunBenchmark()
+    {
+        report.Clear();
+        report.AppendLine("═══════════════════════════════════════════════");
+        report.AppendLine("              SDF EDT BENCHMARK");
+        report.AppendLine("═══════════════════════════════════════════════");
+
+        int edgeCheck = ut_sdf_check_edt_fix(256);
+        report.AppendLine(edgeCheck < 0 ? "  Fixed-point cutoff edge check: not available on this platform"
+                        : edgeCheck == 0 ? "  Fixed-point cutoff edge check: ok"
+                        : $"  Fixed-point cutoff edge check: FAILED ({edgeCheck} texels disagree)");
+        report.AppendLine($"  {"Grid",-10}{"Strided µs",14}{"Tiled µs",14}{"Band µs",14}{"Band int µs",14}{"Tiled",8}{"Band",8}{"Int",8}");
+
+        for (int i = 0; i < gridSizes.Length; i++)
+        {
+            int size = gridSizes[i];
+            int iters = Mathf.Max(1, iterations * 128 * 128 / Mathf.Max(size * size, 128 * 128));
+
+            ut_sdf_bench_edt(size, warmupIterations, VariantStrided);
+            ut_sdf_bench_edt(size, warmupIterations, VariantTiled);
+            ut_sdf_bench_edt(size, warmupIterations, VariantBand);
+            ut_sdf_bench_edt(size, warmupIterations, VariantBandInt);
+
+            double strided = ut_sdf_bench_edt(size, iters, VariantStrided);
+            double tiled = ut_sdf_bench_edt(size, iters, VariantTiled);
+            double band = ut_sdf_bench_edt(size, iters, VariantBand);
+            double bandInt = ut_sdf_bench_edt(size, iters, VariantBandInt);
+
+            if (strided < 0 || tiled < 0 || band < 0 || bandInt < 0)
+            {
+                report.AppendLine($"  {size}²: not available on this platform");
+                continue;
+            }
+
+            report.AppendLine($"  {size + "²",-10}{strided,14:F1}{tiled,14:F1}{band,14:F1}{bandInt,14:F1}{strided / tiled,7:F2}x{strided / band,7:F2}x{strided / bandInt,7:F2}x");
+        }
+
+        if (fontPaths.Length > 0)
+            RunGlyphSet();
+
+        report.AppendLine("═══════════════════════════════════════════════");
+        lastResult = report.ToString();
+        Debug.Log(lastResult);
+    }
+
+    void RunGlyphSet()
+    {
+        report.AppendLine("───────────────────────────────────────────────");
+        report.AppendLine("  Glyph set: float vs fixed-point EDT");
+
+        if (ut_ft_init(out IntPtr library) != 0)
+        {
+            report.AppendLine("  FreeType init failed");
+            return;
+        }
+
+        foreach (string path in fontPaths)
+        {
+            string fullPath = Path.IsPathRooted(path) ? path : Path.Combine(Application.dataPath, "..", path);
+            if (!File.Exists(fullPath))
+            {
+                report.AppendLine($"  {path}: not found");
+                continue;
+            }
+            RunFont(library, Path.GetFileName(path), File.ReadAllBytes(fullPath));
+        }
+
+        ut_ft_done(library);
+    }
+
+    void RunFont(IntPtr library, string name, byte[] data)
+    {
+        GCHandle pin = GCHandle.Alloc(data, GCHandleType.Pinned);
+        try
+        {
+            if (ut_ft_new_memory_face(library, pin.AddrOfPinnedObject(), (IntPtr)data.Length, IntPtr.Zero, out IntPtr face) != 0)
+            {
+                report.AppendLine($"  {name}: not a font");
+                return;
+            }
+
+            var glyphs = new uint[characters.Length];
+            int count = 0;
+            foreach (char c in characters)
+            {
+                uint glyph = ut_ft_get_char_index(face, c);
+                if (glyph != 0) glyphs[count++] = glyph;
+            }
+
+            report.AppendLine($"  {name} ({count} glyphs)");
+            report.AppendLine($"    {"Size",-6}{"Format",-8}{"Float µs",12}{"Int µs",12}{"Int",8}{"Max",8}{"Mean",8}{"Differ %",10}");
+
+            foreach (int size in pixelSizes)
+            {
+                ut_ft_set_pixel_sizes(face, 0, (uint)size);
+                int spread = Mathf.Max(1, size / Mathf.Max(1, spreadDivisor));
+                foreach (int format in new[] { FormatR8, FormatR16 })
+                {
+                    string formatName = format == FormatR8 ? "R8" : "R16";
+                    if (count == 0 || ut_sdf_bench_edt_glyphs(face, glyphs, count, FtLoadNoHinting, spread,
+                                                              format, glyphIterations, out GlyphStats s) != 0)
+                    {
+                        report.AppendLine($"    {size,-6}{formatName,-8}  not available");
+                        continue;
+                    }
+                    double differ = s.texels > 0 ? 100.0 * s.differing / s.texels : 0.0;
+                    report.AppendLine($"    {size,-6}{formatName,-8}{s.usFloat,12:F1}{s.usInt,12:F1}{s.usFloat / s.usInt,7:F2}x{s.maxDiff,8}{s.meanDiff,8:F2}{differ,10:F3}");
+                }
+            }
+
+            ut_ft_done_face(face);
+        }
+        finally
+        {
+            pin.Free();
+        }
+    }
+}
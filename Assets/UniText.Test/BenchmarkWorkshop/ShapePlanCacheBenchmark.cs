@@ -0,0 +1,186 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using UnityEngine;
+using Debug = UnityEngine.Debug;
+
+/// <summary>
+/// Times ut_hb_shape_run on short runs (one word each) with the native shape plan
+/// cache off (plain hb_shape, which looks the plan up in the face's own list) and on,
+/// for a few feature lists. The cache ships disabled; this is the measurement that
+/// decides whether ut_hb_shape_plan_cache_set_enabled is worth turning on.
+///
+/// Setup:
+///   1. Add to any GameObject in a scene.
+///   2. Set Font Path (absolute, or relative to the project folder).
+///   3. Play → press Space or click "Run Benchmark" in Inspector.
+/// </summary>
+public class ShapePlanCacheBenchmark : MonoBehaviour
+{
+#if (UNITY_IOS || UNITY_WEBGL) && !UNITY_EDITOR
+    const string NativeLib = "__Internal";
+#else
+    const string NativeLib = "unitext_native";
+#endif
+
+    const int HbMemoryModeReadonly = 1;
+    const int HbDirectionLtr = 4;
+    const uint HbScriptLatin = 0x4C61746E; // 'Latn'
+
+    [StructLayout(LayoutKind.Sequential)]
+    struct Feature
+    {
+        public uint tag;
+        public uint value;
+        public uint start;
+        public uint end;
+    }
+
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_blob_create(IntPtr data, uint length, int mode, IntPtr userData, IntPtr destroy);
+    [DllImport(NativeLib)] static extern void ut_hb_blob_destroy(IntPtr blob);
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_face_create(IntPtr blob, uint index);
+    [DllImport(NativeLib)] static extern void ut_hb_face_destroy(IntPtr face);
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_font_create(IntPtr face);
+    [DllImport(NativeLib)] static extern void ut_hb_font_destroy(IntPtr font);
+    [DllImport(NativeLib)] static extern IntPtr ut_hb_buffer_create();
+    [DllImport(NativeLib)] static extern void ut_hb_buffer_destroy(IntPtr buffer);
+    [DllImport(NativeLib)]
+    static extern int ut_hb_shape_run(IntPtr font, IntPtr buffer, uint[] codepoints, int textLength,
+                                      uint itemOffset, int itemLength, int direction, uint scriptTag, uint flags,
+                                      Feature[] features, uint numFeatures, out IntPtr infos, out IntPtr positions);
+    [DllImport(NativeLib)] static extern void ut_hb_shape_plan_cache_set_enabled(int enabled);
+    [DllImport(NativeLib)] static extern void ut_hb_shape_plan_cache_stats(out uint hits, out uint misses);
+
+    [Header("Text")]
+    public string fontPath = "";
+    [TextArea(3, 6)]
+    public string vocabulary = "the quick brown fox jumps over lazy dog message sent received today yesterday " +
+                               "settings volume audio video language continue cancel player level score inventory";
+    public int runs = 20000;
+
+    [Header("Settings")]
+    public int iterations = 5;
+
+    [Header("Status")]
+    [SerializeField, TextArea(15, 30)] string lastResult = "";
+
+    readonly StringBuilder report = new();
+
+    void Update()
+    {
+        if (Input.GetKeyDown(KeyCode.Space))
+            RunBenchmark();
+    }
+
+    [ContextMenu("Run Benchmark")]
+    public void RunBenchmark()
+    {
+        report.Clear();
+        report.AppendLine("═══════════════════════════════════════════════");
+        report.AppendLine("          SHAPE PLAN CACHE BENCHMARK");
+        report.AppendLine("═══════════════════════════════════════════════");
+
+        string fullPath = Path.IsPathRooted(fontPath) ? fontPath : Path.Combine(Application.dataPath, "..", fontPath);
+        if (!File.Exists(fullPath))
+        {
+            report.AppendLine($"  {fontPath}: not found");
+            Finish();
+            return;
+        }
+
+        byte[] data = File.ReadAllBytes(fullPath);
+        GCHandle dataPin = GCHandle.Alloc(data, GCHandleType.Pinned);
+        IntPtr blob = ut_hb_blob_create(dataPin.AddrOfPinnedObject(), (uint)data.Length, HbMemoryModeReadonly, IntPtr.Zero, IntPtr.Zero);
+        IntPtr face = ut_hb_face_create(blob, 0);
+        IntPtr font = ut_hb_font_create(face);
+        IntPtr buffer = ut_hb_buffer_create();
+        try
+        {
+            RunWords(font, buffer);
+        }
+        finally
+        {
+            ut_hb_shape_plan_cache_set_enabled(0);
+            ut_hb_buffer_destroy(buffer);
+            ut_hb_font_destroy(font);
+            ut_hb_face_destroy(face);
+            ut_hb_blob_destroy(blob);
+            dataPin.Free();
+        }
+        Finish();
+    }
+
+    void RunWords(IntPtr font, IntPtr buffer)
+    {
+        // All words back to back in one codepoint array; each run is one word.
+        string[] words = vocabulary.Split(' ', StringSplitOptions.RemoveEmptyEntries);
+        var text = new StringBuilder();
+        var wordStarts = new int[words.Length + 1];
+        for (int i = 0; i < words.Length; i++)
+        {
+            wordStarts[i] = text.Length;
+            text.Append(words[i]);
+        }
+        wordStarts[words.Length] = text.Length;
+        var codepoints = new uint[text.Length];
+        for (int i = 0; i < text.Length; i++) codepoints[i] = text[i];
+
+        var random = new System.Random(1);
+        var order = new int[runs];
+        for (int i = 0; i < runs; i++) order[i] = random.Next(words.Length);
+
+        var featureSets = new (string name, Feature[] features)[]
+        {
+            ("none", null),
+            ("-kern", new[] { Tag("kern", 0) }),
+            ("-liga +smcp +onum +tnum", new[] { Tag("liga", 0), Tag("smcp", 1), Tag("onum", 1), Tag("tnum", 1) }),
+        };
+
+        report.AppendLine($"  {Path.GetFileName(fontPath)}: {runs} runs of {codepoints.Length / (double)words.Length:F1} codepoints");
+        report.AppendLine($"    {"Features",-26}{"Off ns/run",12}{"On ns/run",12}{"Gain",8}");
+
+        foreach (var (name, features) in featureSets)
+        {
+            uint numFeatures = features != null ? (uint)features.Length : 0;
+            double off = 0, on = 0;
+            foreach (bool cache in new[] { false, true })
+            {
+                ut_hb_shape_plan_cache_set_enabled(cache ? 1 : 0);
+                ShapeAll(font, buffer, codepoints, wordStarts, order, features, numFeatures); // warm-up (compiles the plans)
+                var sw = Stopwatch.StartNew();
+                for (int it = 0; it < iterations; it++)
+                    ShapeAll(font, buffer, codepoints, wordStarts, order, features, numFeatures);
+                double ns = sw.Elapsed.TotalMilliseconds * 1e6 / ((double)iterations * runs);
+                if (cache) on = ns;
+                else off = ns;
+            }
+            report.AppendLine($"    {name,-26}{off,12:F0}{on,12:F0}{off / on,7:F2}×");
+        }
+
+        ut_hb_shape_plan_cache_stats(out uint hits, out uint misses);
+        report.AppendLine($"    plan cache: {hits} hits, {misses} misses");
+    }
+
+    static void ShapeAll(IntPtr font, IntPtr buffer, uint[] codepoints, int[] wordStarts, int[] order,
+                         Feature[] features, uint numFeatures)
+    {
+        foreach (int w in order)
+            ut_hb_shape_run(font, buffer, codepoints, codepoints.Length, (uint)wordStarts[w], wordStarts[w + 1] - wordStarts[w],
+                            HbDirectionLtr, HbScriptLatin, 0, features, numFeatures, out _, out _);
+    }
+
+    static Feature Tag(string tag, uint value)
+    {
+        uint t = ((uint)tag[0] << 24) | ((uint)tag[1] << 16) | ((uint)tag[2] << 8) | tag[3];
+        return new Feature { tag = t, value = value, start = 0, end = uint.MaxValue };
+    }
+
+    void Finish()
+    {
+        report.AppendLine("═══════════════════════════════════════════════");
+        lastResult = report.ToString();
+        Debug.Log(lastResult);
+    }
+}
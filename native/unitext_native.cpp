@@ -23,6 +23,11 @@
 #define BL_STATIC
 #include <blend2d/blend2d.h>
 
+#include <atomic>
+#include <chrono>
+
+#include "gpu_upload_common.h"
+
 #ifdef _WIN32
 #define UNITEXT_EXPORT extern "C" __declspec(dllexport)
 #else
@@ -50,7 +55,12 @@ UNITEXT_EXPORT int ut_ft_new_memory_face(FT_Library library, const unsigned char
     return FT_New_Memory_Face(library, data, size, face_index, face);
 }
 
+// Bumped on every face destruction; invalidates the per-thread face clones
+// kept by ut_ft_render_sdf_glyphs_batch.
+static std::atomic<unsigned> g_face_generation{0};
+
 UNITEXT_EXPORT int ut_ft_done_face(FT_Face face) {
+    g_face_generation.fetch_add(1, std::memory_order_release);
     return FT_Done_Face(face);
 }
 
@@ -135,891 +145,6363 @@ static void edt_1d(const float* f, float* d, int* v, float* z, int n) {
     }
 }
 
-// 2D squared EDT in-place. grid[w*h], row-major.
-// Caller provides workspace: f[maxdim], d[maxdim], z[maxdim+1], v[maxdim].
-static void edt_2d(float* grid, int w, int h, float* f, float* d, float* z, int* v) {
-    // Transform columns
-    for (int x = 0; x < w; x++) {
-        for (int y = 0; y < h; y++) f[y] = grid[y * w + x];
-        edt_1d(f, d, v, z, h);
-        for (int y = 0; y < h; y++) grid[y * w + x] = d[y];
+// Narrow-band edt_1d, in place: only results below `cutoff` must be exact —
+// the SDF clamps at the spread, so anything farther is written as "far" anyway.
+// - Texels with f >= cutoff are not parabola sites (never the nearest of a
+//   texel whose result is below cutoff)
+// - Inside a run of zeros only the run's ends are sites: they dominate every
+//   texel outside the run, and texels in the run stay 0
+// - Each envelope parabola only visits the texels it owns where it is still
+//   below cutoff; everything else keeps its (>= cutoff) input
+// Solid interiors and empty padding thus cost a scan instead of envelope work.
+// fv[n] holds site values (f is overwritten). Owned texels take the envelope
+// value as edt_1d writes it (not min'd with f), so cutoff = EDT_INF gives
+// bit-identical distances and the band output quantizes identically.
+
+static inline bool edt_band_is_site(const float* f, int q, int n, float cutoff) {
+    float fq = f[q];
+    if (!(fq < cutoff)) return false;
+    return !(fq == 0.0f && q > 0 && q < n - 1 && f[q - 1] == 0.0f && f[q + 1] == 0.0f);
+}
+
+// Adds site q to the lower envelope (v, fv, z; *k = last parabola, -1 = empty).
+static inline void edt_band_push(int q, float fq, int* k, int* v, float* fv, float* z) {
+    int j = *k;
+    if (j < 0) {
+        v[0] = q;
+        fv[0] = fq;
+        z[0] = -EDT_INF;
+        z[1] = +EDT_INF;
+        *k = 0;
+        return;
     }
-    // Transform rows
-    for (int y = 0; y < h; y++) {
-        edt_1d(grid + y * w, d, v, z, w);
-        memcpy(grid + y * w, d, w * sizeof(float));
+    float s = ((fq + (float)(q * q)) - (fv[j] + (float)(v[j] * v[j])))
+              / (float)(2 * q - 2 * v[j]);
+    while (s <= z[j]) {
+        j--;
+        s = ((fq + (float)(q * q)) - (fv[j] + (float)(v[j] * v[j])))
+            / (float)(2 * q - 2 * v[j]);
     }
+    j++;
+    v[j] = q;
+    fv[j] = fq;
+    z[j] = s;
+    z[j + 1] = +EDT_INF;
+    *k = j;
 }
 
-// === Combined SDF Glyph Render (FT_RENDER_MODE_NORMAL + EDT) =================
-//
-// Renders glyph as anti-aliased bitmap, then computes SDF via Felzenszwalb EDT.
-// Output is Alpha8 SDF with spread-pixel padding. bmp_buffer is malloc'd —
-// caller MUST free via ut_ft_free_sdf_buffer().
-
-typedef struct {
-    int success;          // 0 = ok, non-zero = FreeType error
-    // Outline metrics (26.6 fixed-point >> 6, read BEFORE render)
-    int metric_width;
-    int metric_height;
-    int metric_bearing_x;
-    int metric_bearing_y;
-    int metric_advance_x; // 26.6 raw (NOT shifted), caller divides by 64
-    // SDF bitmap (padded by spread on each side)
-    int bmp_width;
-    int bmp_height;
-    int bmp_pitch;
-    int bitmap_left;
-    int bitmap_top;
-    void* bmp_buffer;     // malloc'd Alpha8 SDF — caller must free
-} ut_sdf_glyph_result;
-
-UNITEXT_EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
-                                           int load_flags, int spread,
-                                           ut_sdf_glyph_result* out_result) {
-    if (!out_result) return -1;
-    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
-    if (!face) { out_result->success = -1; return -1; }
-
-    // Step 1: Load glyph outline
-    FT_Error err = FT_Load_Glyph(face, glyph_index, load_flags);
-    if (err) { out_result->success = (int)err; return (int)err; }
-
-    // Step 2: Read outline metrics (before render, unaffected by spread)
-    FT_Glyph_Metrics* m = &face->glyph->metrics;
-    out_result->metric_width     = (int)(m->width >> 6);
-    out_result->metric_height    = (int)(m->height >> 6);
-    out_result->metric_bearing_x = (int)(m->horiBearingX >> 6);
-    out_result->metric_bearing_y = (int)(m->horiBearingY >> 6);
-    out_result->metric_advance_x = (int)m->horiAdvance; // raw 26.6
-
-    // Step 3: Render as normal anti-aliased grayscale (fast — ~0.1ms)
-    err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
-    if (err) { out_result->success = (int)err; return (int)err; }
-
-    FT_Bitmap* b = &face->glyph->bitmap;
-    int bw = (int)b->width;
-    int bh = (int)b->rows;
+static inline void edt_band_write(float* f, int n, int k, const int* v, const float* fv, const float* z,
+                                  float cutoff) {
+    if (k < 0) return;
 
-    // Zero-size glyph (space, control chars)
-    if (bw <= 0 || bh <= 0) {
-        out_result->bitmap_left = face->glyph->bitmap_left;
-        out_result->bitmap_top  = face->glyph->bitmap_top;
-        out_result->success = 0;
-        return 0;
+    // Dense envelope (most texels near an edge): plain edt_1d output walk.
+    if ((k + 1) * 8 > n) {
+        int j = 0;
+        for (int q = 0; q < n; q++) {
+            while (z[j + 1] < (float)q) j++;
+            if (f[q] != 0.0f) f[q] = (float)((q - v[j]) * (q - v[j])) + fv[j];
+        }
+        return;
     }
 
-    // Step 4: Allocate workspace — one malloc for grids + EDT scratch
-    int pw = bw + 2 * spread;
-    int ph = bh + 2 * spread;
-    int pcount = pw * ph;
-    int maxdim = pw > ph ? pw : ph;
-
-    size_t ws_size = (size_t)pcount * sizeof(float) * 2    // outside + inside
-                   + (size_t)maxdim * sizeof(float) * 2    // edt_f + edt_d
-                   + (size_t)(maxdim + 1) * sizeof(float)  // edt_z
-                   + (size_t)maxdim * sizeof(int);          // edt_v
-    char* ws = (char*)malloc(ws_size);
-    if (!ws) { out_result->success = -1; return -1; }
+    // Sparse: parabola j owns texels q with z[j] < q <= z[j + 1]; visit only
+    // those where it is still below cutoff.
+    for (int j = 0; j <= k; j++) {
+        float reach = sqrtf(cutoff - fv[j]);
+        float lo = fmaxf(fmaxf(floorf(z[j]) + 1.0f, ceilf((float)v[j] - reach)), 0.0f);
+        float hi = fminf(fminf(floorf(z[j + 1]), floorf((float)v[j] + reach)), (float)(n - 1));
+        for (int q = (int)lo; q <= (int)hi; q++)
+            if (f[q] != 0.0f) f[q] = (float)((q - v[j]) * (q - v[j])) + fv[j];
+    }
+}
 
-    float* outside = (float*)ws;
-    float* inside  = outside + pcount;
-    float* edt_f   = inside + pcount;
-    float* edt_d   = edt_f + maxdim;
-    float* edt_z   = edt_d + maxdim;
-    int*   edt_v   = (int*)(edt_z + maxdim + 1);
+static void edt_1d_band(float* f, float* fv, int* v, float* z, int n, float cutoff) {
+    int k = -1;
+    for (int q = 0; q < n; q++)
+        if (edt_band_is_site(f, q, n, cutoff)) edt_band_push(q, f[q], &k, v, fv, z);
+    edt_band_write(f, n, k, v, fv, z, cutoff);
+}
 
-    // Initialize: outside = far, inside = 0
-    for (int i = 0; i < pcount; i++) {
-        outside[i] = EDT_INF;
-        inside[i]  = 0.0f;
+// edt_1d_band over the same line of both SDF fields in one sweep. The site
+// sets are near-complementary (a zero run in one field is a far run in the
+// other), so each texel usually feeds one envelope, and the two independent
+// envelope builds overlap instead of running back to back.
+// Scratch: fv[2n], v[2n], z[2(n + 1)].
+static void edt_1d_band_pair(float* fo, float* fi, float* fv, int* v, float* z, int n, float cutoff) {
+    float* fvi = fv + n;
+    int*   vi  = v + n;
+    float* zi  = z + n + 1;
+    int ko = -1, ki = -1;
+    for (int q = 0; q < n; q++) {
+        if (edt_band_is_site(fo, q, n, cutoff)) edt_band_push(q, fo[q], &ko, v, fv, z);
+        if (edt_band_is_site(fi, q, n, cutoff)) edt_band_push(q, fi[q], &ki, vi, fvi, zi);
     }
+    edt_band_write(fo, n, ko, v, fv, z, cutoff);
+    edt_band_write(fi, n, ki, vi, fvi, zi, cutoff);
+}
 
-    // Fill glyph region using gradient-corrected sub-pixel distances (edtaa3 approach).
-    // The gradient magnitude of the alpha field encodes the edge angle, allowing
-    // accurate distance estimation for diagonal edges and curves — not just axis-aligned ones.
-    for (int y = 0; y < bh; y++) {
-        const unsigned char* row = b->buffer + y * b->pitch;
-        for (int x = 0; x < bw; x++) {
-            int pi = (y + spread) * pw + (x + spread);
-            unsigned char a = row[x];
-            if (a == 0) {
-                outside[pi] = EDT_INF;
-                inside[pi]  = 0.0f;
-            } else if (a == 255) {
-                outside[pi] = 0.0f;
-                inside[pi]  = EDT_INF;
-            } else {
-                // Read 4-neighbors (0 outside bitmap = outside glyph)
-                float al = x > 0      ? (float)row[x - 1] : 0.0f;
-                float ar = x < bw - 1 ? (float)row[x + 1] : 0.0f;
-                float au = y > 0      ? (float)(b->buffer + (y - 1) * b->pitch)[x] : 0.0f;
-                float ad = y < bh - 1 ? (float)(b->buffer + (y + 1) * b->pitch)[x] : 0.0f;
-
-                float gx = (ar - al) * 0.5f;
-                float gy = (ad - au) * 0.5f;
-                float gmag = sqrtf(gx * gx + gy * gy);
+// === SDF Kernels: scalar reference + SIMD (SSE4.1 / AVX2 / NEON) ============
+//
+// The per-pixel passes of the SDF pipeline — coverage → squared-distance seeds,
+// the EDT column-pass transposes, and the sqrt/subtract/quantize combine —
+// have SIMD variants selected once at runtime (CPUID on x86; NEON is baseline on
+// ARM64). Each SIMD kernel performs the same IEEE operations in the same order
+// as the scalar helpers (sqrt/div are correctly rounded), so output is
+// bit-identical to the scalar fallback. That needs every product feeding an
+// add rounded on its own: GCC and Clang fuse a*b+c into an FMA wherever the
+// target has one (ARM64 always), so such products pass through UT_FP_ROUND.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define UT_SDF_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define UT_TARGET_SSE41
+#define UT_TARGET_AVX2
+#else
+#define UT_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define UT_TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define UT_SDF_NEON 1
+#include <arm_neon.h>
+#endif
 
-                float d;
-                if (gmag > 1.0f) {
-                    // Gradient-corrected: d = (midpoint - alpha) / |gradient|
-                    // Vertical edge:  |∇α|≈255  →  same as linear
-                    // 45° diagonal:   |∇α|≈180  →  distance scaled by ~√2 (correct)
-                    d = (127.5f - (float)a) / gmag;
-                } else {
-                    // Flat region fallback (rare for 0 < a < 255)
-                    d = 0.5f - (float)a / 255.0f;
-                }
+// Pins v (float or vector) in a register so it cannot be fused into a
+// following add. Free at runtime. MSVC only contracts under /fp:contract,
+// which the pragma turns off for the rest of the file.
+#if defined(__GNUC__) && defined(__aarch64__)
+#define UT_FP_ROUND(v) __asm__("" : "+w"(v))
+#elif defined(__GNUC__) && defined(__x86_64__) && defined(__FMA__)
+#define UT_FP_ROUND(v) __asm__("" : "+x"(v))
+#else
+#define UT_FP_ROUND(v) ((void)0)
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma fp_contract(off)
+#endif
 
-                outside[pi] = d > 0.0f ? d * d : 0.0f;
-                inside[pi]  = d < 0.0f ? d * d : 0.0f;
-            }
+// Coverage → squared outside/inside distance seeds for one texel.
+// Partial coverage uses gradient-corrected sub-pixel distances (edtaa3
+// approach): the gradient magnitude of the alpha field encodes the edge angle,
+// allowing accurate distance estimation for diagonal edges and curves — not
+// just axis-aligned ones.
+static inline void sdf_seed_texel(unsigned char a, float al, float ar, float au, float ad,
+                                  float* outside, float* inside) {
+    if (a == 0) {
+        *outside = EDT_INF;
+        *inside  = 0.0f;
+    } else if (a == 255) {
+        *outside = 0.0f;
+        *inside  = EDT_INF;
+    } else {
+        float gx = (ar - al) * 0.5f;
+        float gy = (ad - au) * 0.5f;
+        float gx2 = gx * gx, gy2 = gy * gy;
+        UT_FP_ROUND(gx2);
+        UT_FP_ROUND(gy2);
+        float gmag = sqrtf(gx2 + gy2);
+
+        float d;
+        if (gmag > 1.0f) {
+            // Gradient-corrected: d = (midpoint - alpha) / |gradient|
+            // Vertical edge:  |∇α|≈255  →  same as linear
+            // 45° diagonal:   |∇α|≈180  →  distance scaled by ~√2 (correct)
+            d = (127.5f - (float)a) / gmag;
+        } else {
+            // Flat region fallback (rare for 0 < a < 255)
+            d = 0.5f - (float)a / 255.0f;
         }
+
+        *outside = d > 0.0f ? d * d : 0.0f;
+        *inside  = d < 0.0f ? d * d : 0.0f;
     }
+}
 
-    // Step 5: Compute 2D EDT for both fields
-    edt_2d(outside, pw, ph, edt_f, edt_d, edt_z, edt_v);
-    edt_2d(inside, pw, ph, edt_f, edt_d, edt_z, edt_v);
+// Squared outside/inside distances → Alpha8 (128 = edge, inside > 128).
+// val is clamped in float before the int conversion: anything outside
+// [-1, 256] quantizes to 0/255 either way, and the clamp keeps the cast defined.
+static inline unsigned char sdf_quantize_texel(float outside, float inside, float inv_spread) {
+    float dist = sqrtf(outside) - sqrtf(inside);
+    float scaled = dist * inv_spread;
+    UT_FP_ROUND(scaled);
+    float val = 128.0f - scaled;
+    val = val < -1.0f ? -1.0f : (val > 256.0f ? 256.0f : val);
+    int ival = (int)(val + 0.5f);
+    return (unsigned char)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
+}
 
-    // Step 6: Combine into Alpha8 SDF with Y-flip (FreeType top-down → Unity bottom-up).
-    unsigned char* sdf = (unsigned char*)malloc(pcount);
-    if (!sdf) { free(ws); out_result->success = -1; return -1; }
+// Seeds x in [x0, x1) of one bitmap row; requires 1 <= x0, x1 <= bw - 1 and
+// real rows above/below (border texels go through sdf_seed_texel directly).
+typedef void (*sdf_seed_span_fn)(const unsigned char* up, const unsigned char* row, const unsigned char* down,
+                                 int x0, int x1, float* outside, float* inside);
+// n texels of one grid row → n Alpha8 values.
+typedef void (*sdf_quantize_span_fn)(const float* outside, const float* inside, int n,
+                                     float inv_spread, unsigned char* dst);
+// Transposes a group×group block: dst[c * ds + r] = src[r * ss + c].
+typedef void (*sdf_transpose_fn)(const float* src, int ss, float* dst, int ds);
+
+struct sdf_kernels {
+    const char* name;
+    int group;                    // transpose block size (group×group); 1 = scalar, no kernel
+    sdf_seed_span_fn seed_span;
+    sdf_quantize_span_fn quantize_span;
+    sdf_transpose_fn transpose;
+};
+
+static void sdf_seed_span_scalar(const unsigned char* up, const unsigned char* row, const unsigned char* down,
+                                 int x0, int x1, float* outside, float* inside) {
+    for (int x = x0; x < x1; x++)
+        sdf_seed_texel(row[x], (float)row[x - 1], (float)row[x + 1], (float)up[x], (float)down[x],
+                       &outside[x], &inside[x]);
+}
 
-    float inv_spread = spread > 0 ? 128.0f / (float)spread : 128.0f;
+static void sdf_quantize_span_scalar(const float* outside, const float* inside, int n,
+                                     float inv_spread, unsigned char* dst) {
+    for (int x = 0; x < n; x++)
+        dst[x] = sdf_quantize_texel(outside[x], inside[x], inv_spread);
+}
 
-    for (int y = 0; y < ph; y++) {
-        int src_row = y * pw;
-        int dst_row = (ph - 1 - y) * pw;  // Y-flip
-        for (int x = 0; x < pw; x++) {
-            float dist = sqrtf(outside[src_row + x]) - sqrtf(inside[src_row + x]);
-            float val = 128.0f - dist * inv_spread;
-            int ival = (int)(val + 0.5f);
-            sdf[dst_row + x] = (unsigned char)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
-        }
+static inline int32_t sdf_load_u32(const unsigned char* p) {
+    int32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+#if UT_SDF_X86
+
+UT_TARGET_SSE41 static void sdf_seed_span_sse41(const unsigned char* up, const unsigned char* row,
+                                                const unsigned char* down, int x0, int x1,
+                                                float* outside, float* inside) {
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f), mid = _mm_set1_ps(127.5f);
+    const __m128 c255 = _mm_set1_ps(255.0f), inf = _mm_set1_ps(EDT_INF), zero = _mm_setzero_ps();
+    int x = x0;
+    for (; x + 4 <= x1; x += 4) {
+        __m128 a  = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(sdf_load_u32(row + x))));
+        __m128 al = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(sdf_load_u32(row + x - 1))));
+        __m128 ar = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(sdf_load_u32(row + x + 1))));
+        __m128 au = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(sdf_load_u32(up + x))));
+        __m128 ad = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(sdf_load_u32(down + x))));
+
+        __m128 gx = _mm_mul_ps(_mm_sub_ps(ar, al), half);
+        __m128 gy = _mm_mul_ps(_mm_sub_ps(ad, au), half);
+        __m128 gx2 = _mm_mul_ps(gx, gx), gy2 = _mm_mul_ps(gy, gy);
+        UT_FP_ROUND(gx2);
+        UT_FP_ROUND(gy2);
+        __m128 gmag = _mm_sqrt_ps(_mm_add_ps(gx2, gy2));
+        __m128 d = _mm_blendv_ps(_mm_sub_ps(half, _mm_div_ps(a, c255)),
+                                 _mm_div_ps(_mm_sub_ps(mid, a), gmag),
+                                 _mm_cmpgt_ps(gmag, one));
+        __m128 dd = _mm_mul_ps(d, d);
+        __m128 o = _mm_and_ps(_mm_cmpgt_ps(d, zero), dd);
+        __m128 i = _mm_and_ps(_mm_cmplt_ps(d, zero), dd);
+
+        __m128 is0 = _mm_cmpeq_ps(a, zero), is255 = _mm_cmpeq_ps(a, c255);
+        o = _mm_blendv_ps(_mm_blendv_ps(o, inf, is0), zero, is255);
+        i = _mm_blendv_ps(_mm_blendv_ps(i, zero, is0), inf, is255);
+        _mm_storeu_ps(outside + x, o);
+        _mm_storeu_ps(inside + x, i);
     }
+    sdf_seed_span_scalar(up, row, down, x, x1, outside, inside);
+}
 
-    free(ws);
+UT_TARGET_SSE41 static void sdf_quantize_span_sse41(const float* outside, const float* inside, int n,
+                                                    float inv_spread, unsigned char* dst) {
+    const __m128 c128 = _mm_set1_ps(128.0f), lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(256.0f);
+    const __m128 half = _mm_set1_ps(0.5f), inv = _mm_set1_ps(inv_spread);
+    int x = 0;
+    for (; x + 4 <= n; x += 4) {
+        __m128 dist = _mm_sub_ps(_mm_sqrt_ps(_mm_loadu_ps(outside + x)), _mm_sqrt_ps(_mm_loadu_ps(inside + x)));
+        __m128 scaled = _mm_mul_ps(dist, inv);
+        UT_FP_ROUND(scaled);
+        __m128 val = _mm_sub_ps(c128, scaled);
+        val = _mm_min_ps(_mm_max_ps(val, lo), hi);
+        __m128i iv = _mm_cvttps_epi32(_mm_add_ps(val, half));
+        __m128i b = _mm_packus_epi16(_mm_packs_epi32(iv, iv), _mm_setzero_si128());
+        int32_t packed = _mm_cvtsi128_si32(b);
+        memcpy(dst + x, &packed, 4);
+    }
+    sdf_quantize_span_scalar(outside + x, inside + x, n - x, inv_spread, dst + x);
+}
 
-    // Step 7: Fill result
-    out_result->bmp_width   = pw;
-    out_result->bmp_height  = ph;
-    out_result->bmp_pitch   = pw;
-    out_result->bitmap_left = face->glyph->bitmap_left - spread;
-    out_result->bitmap_top  = face->glyph->bitmap_top + spread;
-    out_result->bmp_buffer  = sdf;
-    out_result->success = 0;
-    return 0;
+UT_TARGET_SSE41 static void sdf_transpose4_sse41(const float* src, int ss, float* dst, int ds) {
+    __m128 r0 = _mm_loadu_ps(src);
+    __m128 r1 = _mm_loadu_ps(src + ss);
+    __m128 r2 = _mm_loadu_ps(src + 2 * ss);
+    __m128 r3 = _mm_loadu_ps(src + 3 * ss);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + ds, r1);
+    _mm_storeu_ps(dst + 2 * ds, r2);
+    _mm_storeu_ps(dst + 3 * ds, r3);
 }
 
-UNITEXT_EXPORT void ut_ft_free_sdf_buffer(void* buffer) {
-    free(buffer);
+UT_TARGET_AVX2 static void sdf_seed_span_avx2(const unsigned char* up, const unsigned char* row,
+                                              const unsigned char* down, int x0, int x1,
+                                              float* outside, float* inside) {
+    const __m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f), mid = _mm256_set1_ps(127.5f);
+    const __m256 c255 = _mm256_set1_ps(255.0f), inf = _mm256_set1_ps(EDT_INF), zero = _mm256_setzero_ps();
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m256 a  = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(row + x))));
+        __m256 al = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(row + x - 1))));
+        __m256 ar = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(row + x + 1))));
+        __m256 au = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(up + x))));
+        __m256 ad = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(down + x))));
+
+        __m256 gx = _mm256_mul_ps(_mm256_sub_ps(ar, al), half);
+        __m256 gy = _mm256_mul_ps(_mm256_sub_ps(ad, au), half);
+        __m256 gx2 = _mm256_mul_ps(gx, gx), gy2 = _mm256_mul_ps(gy, gy);
+        UT_FP_ROUND(gx2);
+        UT_FP_ROUND(gy2);
+        __m256 gmag = _mm256_sqrt_ps(_mm256_add_ps(gx2, gy2));
+        __m256 d = _mm256_blendv_ps(_mm256_sub_ps(half, _mm256_div_ps(a, c255)),
+                                    _mm256_div_ps(_mm256_sub_ps(mid, a), gmag),
+                                    _mm256_cmp_ps(gmag, one, _CMP_GT_OQ));
+        __m256 dd = _mm256_mul_ps(d, d);
+        __m256 o = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_GT_OQ), dd);
+        __m256 i = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_LT_OQ), dd);
+
+        __m256 is0 = _mm256_cmp_ps(a, zero, _CMP_EQ_OQ), is255 = _mm256_cmp_ps(a, c255, _CMP_EQ_OQ);
+        o = _mm256_blendv_ps(_mm256_blendv_ps(o, inf, is0), zero, is255);
+        i = _mm256_blendv_ps(_mm256_blendv_ps(i, zero, is0), inf, is255);
+        _mm256_storeu_ps(outside + x, o);
+        _mm256_storeu_ps(inside + x, i);
+    }
+    sdf_seed_span_scalar(up, row, down, x, x1, outside, inside);
 }
 
-// =============================================================================
-// Unified HarfBuzz API (ut_hb_*)
-// =============================================================================
+UT_TARGET_AVX2 static void sdf_quantize_span_avx2(const float* outside, const float* inside, int n,
+                                                  float inv_spread, unsigned char* dst) {
+    const __m256 c128 = _mm256_set1_ps(128.0f), lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(256.0f);
+    const __m256 half = _mm256_set1_ps(0.5f), inv = _mm256_set1_ps(inv_spread);
+    int x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m256 dist = _mm256_sub_ps(_mm256_sqrt_ps(_mm256_loadu_ps(outside + x)),
+                                    _mm256_sqrt_ps(_mm256_loadu_ps(inside + x)));
+        __m256 scaled = _mm256_mul_ps(dist, inv);
+        UT_FP_ROUND(scaled);
+        __m256 val = _mm256_sub_ps(c128, scaled);
+        val = _mm256_min_ps(_mm256_max_ps(val, lo), hi);
+        __m256i iv = _mm256_cvttps_epi32(_mm256_add_ps(val, half));
+        __m128i w16 = _mm_packs_epi32(_mm256_castsi256_si128(iv), _mm256_extracti128_si256(iv, 1));
+        _mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(w16, w16));
+    }
+    sdf_quantize_span_scalar(outside + x, inside + x, n - x, inv_spread, dst + x);
+}
 
-UNITEXT_EXPORT hb_blob_t* ut_hb_blob_create(const char* data, unsigned int length, hb_memory_mode_t mode, void* user_data, hb_destroy_func_t destroy) {
-    return hb_blob_create(data, length, mode, user_data, destroy);
+UT_TARGET_AVX2 static void sdf_transpose8_avx2(const float* src, int ss, float* dst, int ds) {
+    __m256 r0 = _mm256_loadu_ps(src);
+    __m256 r1 = _mm256_loadu_ps(src + ss);
+    __m256 r2 = _mm256_loadu_ps(src + 2 * ss);
+    __m256 r3 = _mm256_loadu_ps(src + 3 * ss);
+    __m256 r4 = _mm256_loadu_ps(src + 4 * ss);
+    __m256 r5 = _mm256_loadu_ps(src + 5 * ss);
+    __m256 r6 = _mm256_loadu_ps(src + 6 * ss);
+    __m256 r7 = _mm256_loadu_ps(src + 7 * ss);
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm256_storeu_ps(dst,          _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(dst + ds,     _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(dst + 2 * ds, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(dst + 3 * ds, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(dst + 4 * ds, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(dst + 5 * ds, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(dst + 6 * ds, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(dst + 7 * ds, _mm256_permute2f128_ps(s3, s7, 0x31));
 }
 
-UNITEXT_EXPORT void ut_hb_blob_destroy(hb_blob_t* blob) {
-    hb_blob_destroy(blob);
+static bool sdf_cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
 }
 
-UNITEXT_EXPORT hb_face_t* ut_hb_face_create(hb_blob_t* blob, unsigned int index) {
-    return hb_face_create(blob, index);
+static bool sdf_cpu_has_sse41() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.1");
+#endif
 }
 
-UNITEXT_EXPORT void ut_hb_face_destroy(hb_face_t* face) {
-    hb_face_destroy(face);
+#endif // UT_SDF_X86
+
+#if UT_SDF_NEON
+
+static void sdf_seed_span_neon(const unsigned char* up, const unsigned char* row, const unsigned char* down,
+                               int x0, int x1, float* outside, float* inside) {
+    const float32x4_t half = vdupq_n_f32(0.5f), one = vdupq_n_f32(1.0f), mid = vdupq_n_f32(127.5f);
+    const float32x4_t c255 = vdupq_n_f32(255.0f), inf = vdupq_n_f32(EDT_INF), zero = vdupq_n_f32(0.0f);
+    int x = x0;
+    for (; x + 4 <= x1; x += 4) {
+        #define UT_U8X4_TO_F32(p) vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8( \
+            vreinterpret_u8_u32(vdup_n_u32((uint32_t)sdf_load_u32(p)))))))
+        float32x4_t a  = UT_U8X4_TO_F32(row + x);
+        float32x4_t al = UT_U8X4_TO_F32(row + x - 1);
+        float32x4_t ar = UT_U8X4_TO_F32(row + x + 1);
+        float32x4_t au = UT_U8X4_TO_F32(up + x);
+        float32x4_t ad = UT_U8X4_TO_F32(down + x);
+        #undef UT_U8X4_TO_F32
+
+        float32x4_t gx = vmulq_f32(vsubq_f32(ar, al), half);
+        float32x4_t gy = vmulq_f32(vsubq_f32(ad, au), half);
+        float32x4_t gx2 = vmulq_f32(gx, gx), gy2 = vmulq_f32(gy, gy);
+        UT_FP_ROUND(gx2);
+        UT_FP_ROUND(gy2);
+        float32x4_t gmag = vsqrtq_f32(vaddq_f32(gx2, gy2));
+        float32x4_t d = vbslq_f32(vcgtq_f32(gmag, one),
+                                  vdivq_f32(vsubq_f32(mid, a), gmag),
+                                  vsubq_f32(half, vdivq_f32(a, c255)));
+        float32x4_t dd = vmulq_f32(d, d);
+        float32x4_t o = vbslq_f32(vcgtq_f32(d, zero), dd, zero);
+        float32x4_t i = vbslq_f32(vcltq_f32(d, zero), dd, zero);
+
+        uint32x4_t is0 = vceqq_f32(a, zero), is255 = vceqq_f32(a, c255);
+        o = vbslq_f32(is255, zero, vbslq_f32(is0, inf, o));
+        i = vbslq_f32(is255, inf, vbslq_f32(is0, zero, i));
+        vst1q_f32(outside + x, o);
+        vst1q_f32(inside + x, i);
+    }
+    sdf_seed_span_scalar(up, row, down, x, x1, outside, inside);
 }
 
-UNITEXT_EXPORT unsigned int ut_hb_face_get_upem(const hb_face_t* face) {
-    return hb_face_get_upem(face);
+static void sdf_quantize_span_neon(const float* outside, const float* inside, int n,
+                                   float inv_spread, unsigned char* dst) {
+    const float32x4_t c128 = vdupq_n_f32(128.0f), lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(256.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f), inv = vdupq_n_f32(inv_spread);
+    int x = 0;
+    for (; x + 8 <= n; x += 8) {
+        float32x4_t d0 = vsubq_f32(vsqrtq_f32(vld1q_f32(outside + x)), vsqrtq_f32(vld1q_f32(inside + x)));
+        float32x4_t d1 = vsubq_f32(vsqrtq_f32(vld1q_f32(outside + x + 4)), vsqrtq_f32(vld1q_f32(inside + x + 4)));
+        float32x4_t s0 = vmulq_f32(d0, inv), s1 = vmulq_f32(d1, inv);
+        UT_FP_ROUND(s0);
+        UT_FP_ROUND(s1);
+        float32x4_t v0 = vminq_f32(vmaxq_f32(vsubq_f32(c128, s0), lo), hi);
+        float32x4_t v1 = vminq_f32(vmaxq_f32(vsubq_f32(c128, s1), lo), hi);
+        int32x4_t i0 = vcvtq_s32_f32(vaddq_f32(v0, half));
+        int32x4_t i1 = vcvtq_s32_f32(vaddq_f32(v1, half));
+        vst1_u8(dst + x, vqmovun_s16(vcombine_s16(vqmovn_s32(i0), vqmovn_s32(i1))));
+    }
+    sdf_quantize_span_scalar(outside + x, inside + x, n - x, inv_spread, dst + x);
 }
 
-UNITEXT_EXPORT hb_font_t* ut_hb_font_create(hb_face_t* face) {
-    return hb_font_create(face);
+static void sdf_transpose4_neon(const float* src, int ss, float* dst, int ds) {
+    float32x4x2_t t01 = vtrnq_f32(vld1q_f32(src), vld1q_f32(src + ss));
+    float32x4x2_t t23 = vtrnq_f32(vld1q_f32(src + 2 * ss), vld1q_f32(src + 3 * ss));
+    vst1q_f32(dst,          vcombine_f32(vget_low_f32(t01.val[0]),  vget_low_f32(t23.val[0])));
+    vst1q_f32(dst + ds,     vcombine_f32(vget_low_f32(t01.val[1]),  vget_low_f32(t23.val[1])));
+    vst1q_f32(dst + 2 * ds, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+    vst1q_f32(dst + 3 * ds, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
 }
 
-UNITEXT_EXPORT void ut_hb_font_destroy(hb_font_t* font) {
-    hb_font_destroy(font);
+#endif // UT_SDF_NEON
+
+static const sdf_kernels k_sdf_kernels_scalar = {
+    "scalar", 1, sdf_seed_span_scalar, sdf_quantize_span_scalar, nullptr
+};
+
+static const sdf_kernels* sdf_select_kernels() {
+#if UT_SDF_X86
+    static const sdf_kernels avx2  = { "avx2",  8, sdf_seed_span_avx2,  sdf_quantize_span_avx2,  sdf_transpose8_avx2 };
+    static const sdf_kernels sse41 = { "sse4.1", 4, sdf_seed_span_sse41, sdf_quantize_span_sse41, sdf_transpose4_sse41 };
+    if (sdf_cpu_has_avx2()) return &avx2;
+    if (sdf_cpu_has_sse41()) return &sse41;
+#elif UT_SDF_NEON
+    static const sdf_kernels neon = { "neon", 4, sdf_seed_span_neon, sdf_quantize_span_neon, sdf_transpose4_neon };
+    return &neon;
+#endif
+    return &k_sdf_kernels_scalar;
 }
 
-UNITEXT_EXPORT void ut_hb_ot_font_set_funcs(hb_font_t* font) {
-    hb_ot_font_set_funcs(font);
+static const sdf_kernels* sdf_kernels_get() {
+    static const sdf_kernels* kernels = sdf_select_kernels();
+    return kernels;
 }
 
-UNITEXT_EXPORT int ut_hb_font_get_glyph_h_advance(hb_font_t* font, unsigned int glyph) {
-    return hb_font_get_glyph_h_advance(font, glyph);
+// Name of the SDF kernel set picked by runtime dispatch ("avx2", "sse4.1", "neon", "scalar").
+UNITEXT_EXPORT const char* ut_ft_get_sdf_kernel_name() {
+    return sdf_kernels_get()->name;
 }
 
-UNITEXT_EXPORT int ut_hb_font_get_glyph(hb_font_t* font, unsigned int unicode, unsigned int variation_selector, unsigned int* glyph) {
-    return hb_font_get_glyph(font, unicode, variation_selector, glyph);
+// Cache-blocked transpose of a w×h row-major grid: dst[x * h + y] = src[y * w + x].
+// Walks TILE×TILE tiles so both the read and the write side stay within a
+// few dozen cache lines; full group×group blocks inside a tile go through the
+// SIMD transpose kernel. The _rect form covers only src columns [x0, x1) and
+// rows [y0, y1), for strip-wise passes.
+#define SDF_TRANSPOSE_TILE 32
+
+static void sdf_transpose_rect(const float* src, int w, int h, float* dst, int x0, int x1, int y0, int y1) {
+    const sdf_kernels* k = sdf_kernels_get();
+    int g = k->group;
+    for (int ty = y0; ty < y1; ty += SDF_TRANSPOSE_TILE) {
+        int ty1 = ty + SDF_TRANSPOSE_TILE < y1 ? ty + SDF_TRANSPOSE_TILE : y1;
+        for (int tx = x0; tx < x1; tx += SDF_TRANSPOSE_TILE) {
+            int tx1 = tx + SDF_TRANSPOSE_TILE < x1 ? tx + SDF_TRANSPOSE_TILE : x1;
+            int y = ty;
+            if (g > 1) {
+                for (; y + g <= ty1; y += g) {
+                    int x = tx;
+                    for (; x + g <= tx1; x += g) k->transpose(src + y * w + x, w, dst + x * h + y, h);
+                    for (; x < tx1; x++)
+                        for (int r = 0; r < g; r++) dst[x * h + y + r] = src[(y + r) * w + x];
+                }
+            }
+            for (; y < ty1; y++)
+                for (int x = tx; x < tx1; x++) dst[x * h + y] = src[y * w + x];
+        }
+    }
 }
 
-UNITEXT_EXPORT hb_face_t* ut_hb_font_get_face(hb_font_t* font) {
-    return hb_font_get_face(font);
+static void sdf_transpose_grid(const float* src, int w, int h, float* dst) {
+    sdf_transpose_rect(src, w, h, dst, 0, w, 0, h);
 }
 
-UNITEXT_EXPORT hb_buffer_t* ut_hb_buffer_create() {
-    return hb_buffer_create();
+// Column pass, reference form: gathers each column with a stride of w floats.
+// Kept for ut_sdf_bench_edt comparisons.
+static void edt_columns_strided(float* grid, int w, int h, float* f, float* d, float* z, int* v) {
+    for (int x = 0; x < w; x++) {
+        for (int y = 0; y < h; y++) f[y] = grid[y * w + x];
+        edt_1d(f, d, v, z, h);
+        for (int y = 0; y < h; y++) grid[y * w + x] = d[y];
+    }
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_destroy(hb_buffer_t* buffer) {
-    hb_buffer_destroy(buffer);
+// Column pass, cache-blocked: transpose grid into scratch[w*h] so every column
+// becomes a contiguous row, run the row kernel, transpose back.
+static void edt_columns_tiled(float* grid, int w, int h, float* d, float* z, int* v, float* scratch,
+                              float cutoff) {
+    sdf_transpose_grid(grid, w, h, scratch);
+    for (int x = 0; x < w; x++) edt_1d_band(scratch + x * h, d, v, z, h, cutoff);
+    sdf_transpose_grid(scratch, h, w, grid);
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_clear_contents(hb_buffer_t* buffer) {
-    hb_buffer_clear_contents(buffer);
+static void edt_rows(float* grid, int w, int h, float* d, float* z, int* v, float cutoff) {
+    for (int y = 0; y < h; y++) edt_1d_band(grid + y * w, d, v, z, w, cutoff);
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_set_direction(hb_buffer_t* buffer, hb_direction_t direction) {
-    hb_buffer_set_direction(buffer, direction);
+// The paired column pass walks strips of SDF_EDT_STRIP columns, so its
+// transpose scratch is one strip of both fields (2 × SDF_EDT_STRIP × h) that
+// stays in cache from the transpose in, through the EDT, to the transpose out.
+// Strips are independent (the parallel EDT hands one to each slot).
+#define SDF_EDT_STRIP 32
+
+// Strip scratch, in floats, for an h-row grid.
+static inline size_t edt_strip_scratch(int h) {
+    return (size_t)2 * SDF_EDT_STRIP * h;
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_set_script(hb_buffer_t* buffer, hb_script_t script) {
-    hb_buffer_set_script(buffer, script);
+// Column pass over columns [x0, x1) (at most SDF_EDT_STRIP) of both fields:
+// transpose the strip into scratch[edt_strip_scratch(h)], run edt_1d_band_pair
+// on each now-contiguous column, transpose back.
+static void edt_pair_columns(float* outside, float* inside, int w, int h, int x0, int x1,
+                             float* d, float* z, int* v, float* scratch, float cutoff) {
+    int n = x1 - x0;
+    float* so = scratch;
+    float* si = scratch + (size_t)n * h;
+    sdf_transpose_rect(outside + x0, w, h, so, 0, n, 0, h);
+    sdf_transpose_rect(inside + x0, w, h, si, 0, n, 0, h);
+    for (int x = 0; x < n; x++) edt_1d_band_pair(so + x * h, si + x * h, d, v, z, h, cutoff);
+    sdf_transpose_rect(so, h, w, outside + x0, 0, h, 0, n);
+    sdf_transpose_rect(si, h, w, inside + x0, 0, h, 0, n);
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_set_content_type(hb_buffer_t* buffer, hb_buffer_content_type_t content_type) {
-    hb_buffer_set_content_type(buffer, content_type);
+static void edt_pair_rows(float* outside, float* inside, int w, int y0, int y1,
+                          float* d, float* z, int* v, float cutoff) {
+    for (int y = y0; y < y1; y++) edt_1d_band_pair(outside + y * w, inside + y * w, d, v, z, w, cutoff);
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_set_flags(hb_buffer_t* buffer, hb_buffer_flags_t flags) {
-    hb_buffer_set_flags(buffer, flags);
+// 2D squared EDT in-place on both SDF fields, row-major [w*h].
+// Caller provides workspace: d[2 * maxdim], z[2 * (maxdim + 1)], v[2 * maxdim],
+// scratch[edt_strip_scratch(h)].
+// Results below cutoff (squared) are exact, the rest are only known to be
+// >= cutoff; EDT_INF = full transform. The column pass may drop sites at or
+// beyond cutoff too: a row result below cutoff only reads column results below it.
+//
+// The two fields are fused per pass, not transformed as one: each line still
+// builds two envelopes. What is shared is the sweep over the line, the strip
+// transposes and their cache residency; that measured 7–10% over two separate
+// edt_2d calls, not a halved pass cost.
+static void edt_2d_pair(float* outside, float* inside, int w, int h, float* d, float* z, int* v,
+                        float* scratch, float cutoff) {
+    for (int x0 = 0; x0 < w; x0 += SDF_EDT_STRIP) {
+        int x1 = x0 + SDF_EDT_STRIP < w ? x0 + SDF_EDT_STRIP : w;
+        edt_pair_columns(outside, inside, w, h, x0, x1, d, z, v, scratch, cutoff);
+    }
+    edt_pair_rows(outside, inside, w, 0, h, d, z, v, cutoff);
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_add_codepoints(hb_buffer_t* buffer, const unsigned int* text, int text_length, unsigned int item_offset, int item_length) {
-    hb_buffer_add_codepoints(buffer, text, text_length, item_offset, item_length);
+// Squared narrow-band cutoff for a spread: one texel beyond the distance where
+// both the 8- and 16-bit encodings saturate.
+static inline float sdf_band_cutoff(int spread) {
+    float r = (float)(spread > 0 ? spread : 1) + 1.0f;
+    return r * r;
 }
 
-UNITEXT_EXPORT unsigned int ut_hb_buffer_get_length(const hb_buffer_t* buffer) {
-    return hb_buffer_get_length(buffer);
+// === Fixed-point EDT ==========================================================
+//
+// Integer form of the narrow-band EDT for cores where float division is slow
+// (low-end ARM). Sites enter the envelope in fixed point with `shift`
+// fractional bits, chosen per cutoff so cutoff << shift stays below 2^24:
+// every fixed result is then exact as a float, and the grids stay float
+// between passes (same transposes as the float path). Parabola intersections
+// stay exact rationals, num / (2 (q - v) << shift), and are only ever compared
+// by cross-multiplying in int64, so building the envelope needs no division.
+// Results at or beyond cutoff are written as EDT_INF, since a clamped encoding
+// saturates there. The transform is exact on the rounded seeds; seed rounding
+// (< 2^-(shift+1) px²) moves a distance by under 1/10 of an 8-bit quantization
+// step at any spread. R8 output only: near an edge, where d² is small, the same
+// rounding can reach ~100 R16 codes, so R16 and RHalf keep the float transform.
+// Lines up to EDT_FIX_MAX_DIM keep every cross product within int64.
+
+#define EDT_FIX_MAX_SHIFT 20
+#define EDT_FIX_MAX_DIM   4096
+
+static std::atomic<int> g_sdf_integer_edt{0};
+
+// Selects the fixed-point EDT (non-zero) or the float one (0, default) for
+// Alpha8/R8 SDF renders (plain, R8 format, into/region). R16 and RHalf
+// always use the float EDT.
+UNITEXT_EXPORT void ut_ft_set_sdf_integer_edt(int enabled) {
+    g_sdf_integer_edt.store(enabled != 0, std::memory_order_relaxed);
 }
 
-UNITEXT_EXPORT hb_glyph_info_t* ut_hb_buffer_get_glyph_infos(hb_buffer_t* buffer, unsigned int* length) {
-    return hb_buffer_get_glyph_infos(buffer, length);
+// Fractional bits for a (squared, px²) cutoff: as many as keep cutoff below 2^24.
+static int edt_fix_shift(float cutoff) {
+    int shift = EDT_FIX_MAX_SHIFT;
+    while (shift > 0 && cutoff * (float)(1 << shift) > (float)(1 << 24)) shift--;
+    return shift;
 }
 
-UNITEXT_EXPORT hb_glyph_position_t* ut_hb_buffer_get_glyph_positions(hb_buffer_t* buffer, unsigned int* length) {
-    return hb_buffer_get_glyph_positions(buffer, length);
+// Envelope scratch: zn[n] (int64), zd[n], fv[n], v[n]. Parabola j owns
+// z[j] < q <= z[j + 1] with z[j] = zn[j] / (zd[j] << shift); z[0] = -inf and
+// z[k + 1] = +inf are implicit.
+struct edt_fix_line {
+    int64_t* zn;
+    int32_t* zd;
+    int32_t* fv;
+    int* v;
+};
+
+static size_t edt_fix_line_bytes(int maxdim) {
+    return (size_t)maxdim * (sizeof(int64_t) + sizeof(int32_t) * 2 + sizeof(int));
 }
 
-UNITEXT_EXPORT void ut_hb_shape(hb_font_t* font, hb_buffer_t* buffer, const hb_feature_t* features, unsigned int num_features) {
-    hb_shape(font, buffer, features, num_features);
+static void edt_fix_line_init(edt_fix_line* l, char* buf, int maxdim) {
+    l->zn = (int64_t*)buf;
+    l->zd = (int32_t*)(l->zn + maxdim);
+    l->fv = l->zd + maxdim;
+    l->v  = (int*)(l->fv + maxdim);
 }
 
-UNITEXT_EXPORT int ut_hb_shape_run(
-    hb_font_t* font, hb_buffer_t* buffer,
-    const unsigned int* codepoints, int text_length,
-    unsigned int item_offset, int item_length,
-    hb_direction_t direction, unsigned int script_tag, unsigned int flags,
-    const hb_feature_t* features, unsigned int num_features,
-    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
-{
-    hb_buffer_clear_contents(buffer);
-    hb_buffer_set_direction(buffer, direction);
-    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
-    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
-    hb_buffer_add_codepoints(buffer, codepoints, text_length, item_offset, item_length);
-    hb_shape(font, buffer, features, num_features);
-    unsigned int count = 0;
-    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
-    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
-    return (int)count;
+static inline void edt_fix_push(int q, int32_t fq, int* k, const edt_fix_line* l, int shift) {
+    int j = *k;
+    int64_t hq = (int64_t)fq + ((int64_t)q * q << shift);
+    int64_t sn = 0;
+    int32_t sd = 0;
+    while (j >= 0) {
+        sn = hq - ((int64_t)l->fv[j] + ((int64_t)l->v[j] * l->v[j] << shift));
+        sd = 2 * (q - l->v[j]);
+        // s > z[j] (sn / sd > zn / zd): parabola j keeps a non-empty interval
+        if (j == 0 || sn * l->zd[j] > l->zn[j] * sd) break;
+        j--;
+    }
+    j++;
+    l->v[j] = q;
+    l->fv[j] = fq;
+    l->zn[j] = sn;
+    l->zd[j] = sd;
+    *k = j;
 }
 
-UNITEXT_EXPORT hb_language_t ut_hb_language_from_string(const char* str, int len) {
-    if (!str) return HB_LANGUAGE_INVALID;
-    return hb_language_from_string(str, len);
+// q > z[j] / q <= z[j + 1], with the implicit infinite envelope bounds.
+static inline bool edt_fix_after(const edt_fix_line* l, int j, int q, int shift) {
+    return j == 0 || ((int64_t)q * l->zd[j] << shift) > l->zn[j];
 }
 
-UNITEXT_EXPORT void ut_hb_buffer_set_language(hb_buffer_t* buffer, hb_language_t language) {
-    hb_buffer_set_language(buffer, language);
+static inline bool edt_fix_before(const edt_fix_line* l, int j, int k, int q, int shift) {
+    return j == k || ((int64_t)q * l->zd[j + 1] << shift) <= l->zn[j + 1];
 }
 
-UNITEXT_EXPORT int ut_hb_shape_run_lang(
-    hb_font_t* font, hb_buffer_t* buffer,
-    const unsigned int* codepoints, int text_length,
-    unsigned int item_offset, int item_length,
-    hb_direction_t direction, unsigned int script_tag, hb_language_t language, unsigned int flags,
-    const hb_feature_t* features, unsigned int num_features,
-    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
-{
-    hb_buffer_clear_contents(buffer);
-    hb_buffer_set_direction(buffer, direction);
-    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
-    if (language != HB_LANGUAGE_INVALID)
-        hb_buffer_set_language(buffer, language);
-    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
-    hb_buffer_add_codepoints(buffer, codepoints, text_length, item_offset, item_length);
-    hb_shape(font, buffer, features, num_features);
-    unsigned int count = 0;
-    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
-    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
-    return (int)count;
+// Envelope value of parabola (v, fv) at q as a float; EDT_INF at or beyond cutoff.
+static inline float edt_fix_value(int q, int v, int32_t fv, int32_t cutoff, int shift, float inv_scale) {
+    int64_t val = ((int64_t)(q - v) * (q - v) << shift) + fv;
+    return val < cutoff ? (float)val * inv_scale : EDT_INF;
 }
 
-// =============================================================================
-// Variable Font API
-// =============================================================================
+// edt_1d_band with a fixed-point envelope, in place on a float line. Same
+// site rules (edt_band_is_site) and dense / sparse write split as the float
+// kernel; sites are rounded to fixed point as they are pushed.
+static void edt_fix_1d_band(float* f, int n, const edt_fix_line* l, float cutoff, int shift) {
+    float scale = (float)(1 << shift);
+    float inv_scale = 1.0f / scale;
+    int32_t cut = (int32_t)(cutoff * scale);
 
-// --- HarfBuzz variable font ---
+    int k = -1;
+    for (int q = 0; q < n; q++) {
+        if (!edt_band_is_site(f, q, n, cutoff)) continue;
+        // A site just below cutoff can round up to cut; keep it inside the band
+        int32_t fq = (int32_t)(f[q] * scale + 0.5f);
+        edt_fix_push(q, fq < cut ? fq : cut - 1, &k, l, shift);
+    }
 
-UNITEXT_EXPORT unsigned int ut_hb_ot_var_get_axis_count(hb_face_t* face) {
-    return hb_ot_var_get_axis_count(face);
+    if (k < 0) return;
+
+    if ((k + 1) * 8 > n) {
+        int j = 0;
+        for (int q = 0; q < n; q++) {
+            while (!edt_fix_before(l, j, k, q, shift)) j++;
+            if (f[q] != 0.0f) f[q] = edt_fix_value(q, l->v[j], l->fv[j], cut, shift, inv_scale);
+        }
+        return;
+    }
+
+    // Owned intervals partition the line in order, so a cursor c (every texel
+    // below c lies left of the current parabola's interval) keeps the interval
+    // search O(n + k) without dividing to find floor(z).
+    int c = 0;
+    for (int j = 0; j <= k; j++) {
+        // reach = largest r with (r² << shift) + fv < cutoff (fv < cut, so m >= 0)
+        int32_t m = (cut - l->fv[j] - 1) >> shift;
+        int reach = (int)sqrtf((float)m);
+        while (reach > 0 && (int64_t)reach * reach > m) reach--;
+        while ((int64_t)(reach + 1) * (reach + 1) <= m) reach++;
+        int hi = l->v[j] + reach < n - 1 ? l->v[j] + reach : n - 1;
+        int q = l->v[j] - reach > c ? l->v[j] - reach : c;
+        if (q <= hi && !edt_fix_after(l, j, q, shift)) {
+            do q++; while (q <= hi && !edt_fix_after(l, j, q, shift));
+            c = q;
+        }
+        int q0 = q;
+        for (; q <= hi && edt_fix_before(l, j, k, q, shift); q++)
+            if (f[q] != 0.0f) f[q] = edt_fix_value(q, l->v[j], l->fv[j], cut, shift, inv_scale);
+        if (q > q0) c = q;
+    }
 }
 
-UNITEXT_EXPORT unsigned int ut_hb_ot_var_get_axis_infos(hb_face_t* face, unsigned int start_offset,
-    unsigned int* axes_count, hb_ot_var_axis_info_t* axes_info) {
-    return hb_ot_var_get_axis_infos(face, start_offset, axes_count, axes_info);
+// Fixed-point counterparts of edt_pair_columns / edt_pair_rows / edt_2d_pair.
+// l sized for max(w, h).
+static void edt_fix_pair_columns(float* outside, float* inside, int w, int h, int x0, int x1,
+                                 const edt_fix_line* l, float* scratch, float cutoff, int shift) {
+    int n = x1 - x0;
+    float* so = scratch;
+    float* si = scratch + (size_t)n * h;
+    sdf_transpose_rect(outside + x0, w, h, so, 0, n, 0, h);
+    sdf_transpose_rect(inside + x0, w, h, si, 0, n, 0, h);
+    for (int x = 0; x < n; x++) {
+        edt_fix_1d_band(so + x * h, h, l, cutoff, shift);
+        edt_fix_1d_band(si + x * h, h, l, cutoff, shift);
+    }
+    sdf_transpose_rect(so, h, w, outside + x0, 0, h, 0, n);
+    sdf_transpose_rect(si, h, w, inside + x0, 0, h, 0, n);
 }
 
-UNITEXT_EXPORT void ut_hb_font_set_variations(hb_font_t* font, const hb_variation_t* variations, unsigned int variations_length) {
-    hb_font_set_variations(font, variations, variations_length);
+static void edt_fix_pair_rows(float* outside, float* inside, int w, int y0, int y1,
+                              const edt_fix_line* l, float cutoff, int shift) {
+    for (int y = y0; y < y1; y++) {
+        edt_fix_1d_band(outside + y * w, w, l, cutoff, shift);
+        edt_fix_1d_band(inside + y * w, w, l, cutoff, shift);
+    }
 }
 
-// --- FreeType variable font ---
+// line = edt_fix_line_bytes(max(w, h)), scratch[edt_strip_scratch(h)].
+static void edt_fix_2d_pair(float* outside, float* inside, int w, int h, char* line, float* scratch,
+                            float cutoff) {
+    int shift = edt_fix_shift(cutoff);
+    edt_fix_line l;
+    edt_fix_line_init(&l, line, w > h ? w : h);
+    for (int x0 = 0; x0 < w; x0 += SDF_EDT_STRIP) {
+        int x1 = x0 + SDF_EDT_STRIP < w ? x0 + SDF_EDT_STRIP : w;
+        edt_fix_pair_columns(outside, inside, w, h, x0, x1, &l, scratch, cutoff, shift);
+    }
+    edt_fix_pair_rows(outside, inside, w, 0, h, &l, cutoff, shift);
+}
 
-UNITEXT_EXPORT int ut_ft_get_mm_var(FT_Face face, FT_MM_Var** amaster) {
-    return FT_Get_MM_Var(face, amaster);
+// Single-grid form for ut_sdf_bench_edt. scratch[w * h].
+static void edt_fix_2d(float* grid, int w, int h, char* line, float* scratch, float cutoff) {
+    int shift = edt_fix_shift(cutoff);
+    edt_fix_line l;
+    edt_fix_line_init(&l, line, w > h ? w : h);
+    sdf_transpose_grid(grid, w, h, scratch);
+    for (int x = 0; x < w; x++) edt_fix_1d_band(scratch + x * h, h, &l, cutoff, shift);
+    sdf_transpose_grid(scratch, h, w, grid);
+    for (int y = 0; y < h; y++) edt_fix_1d_band(grid + y * w, w, &l, cutoff, shift);
 }
 
-UNITEXT_EXPORT int ut_ft_done_mm_var(FT_Library library, FT_MM_Var* amaster) {
-    return FT_Done_MM_Var(library, amaster);
-}
+// Column pass strategy for ut_sdf_bench_edt. BAND = tiled with the narrow-band
+// cutoff of a spread of size / 16 (typical glyph tile proportions). BAND_INT =
+// the same band transform in fixed point, float conversions included.
+#define UT_EDT_BENCH_STRIDED  0
+#define UT_EDT_BENCH_TILED    1
+#define UT_EDT_BENCH_BAND     2
+#define UT_EDT_BENCH_BAND_INT 3
+
+// Times a size×size 2D EDT (columns + rows) on a synthetic field — a ring
+// outline, so the envelopes carry a realistic mix of near and far seeds.
+// Returns mean microseconds per transform, or -1 on bad args / OOM.
+// Seeding is excluded from the timing.
+UNITEXT_EXPORT double ut_sdf_bench_edt(int size, int iterations, int variant) {
+    if (size <= 0 || iterations <= 0) return -1.0;
+    if (variant < UT_EDT_BENCH_STRIDED || variant > UT_EDT_BENCH_BAND_INT) return -1.0;
+    if (variant == UT_EDT_BENCH_BAND_INT && size > EDT_FIX_MAX_DIM) return -1.0;
+
+    size_t count = (size_t)size * size;
+    size_t ws_size = edt_fix_line_bytes(size)                 // fixed-point envelope
+                   + count * sizeof(float) * 3                // seed + grid + scratch
+                   + (size_t)size * sizeof(float) * 2         // f + d
+                   + (size_t)(size + 1) * sizeof(float)       // z
+                   + (size_t)size * sizeof(int);              // v
+    char* ws = (char*)malloc(ws_size);
+    if (!ws) return -1.0;
+
+    char*  line    = ws;
+    float* seed    = (float*)(ws + edt_fix_line_bytes(size));
+    float* grid    = seed + count;
+    float* scratch = grid + count;
+    float* f       = scratch + count;
+    float* d       = f + size;
+    float* z       = d + size;
+    int*   v       = (int*)(z + size + 1);
+
+    float c = (size - 1) * 0.5f;
+    float r_out = size * 0.375f, r_in = size * 0.25f;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float dx = x - c, dy = y - c;
+            float rr = sqrtf(dx * dx + dy * dy);
+            seed[y * size + x] = (rr <= r_out && rr >= r_in) ? 0.0f : EDT_INF;
+        }
+    }
 
-UNITEXT_EXPORT int ut_ft_set_var_design_coordinates(FT_Face face, unsigned int num_coords, int* coords) {
-    if (sizeof(FT_Fixed) == sizeof(int)) {
-        return FT_Set_Var_Design_Coordinates(face, num_coords, (FT_Fixed*)coords);
+    bool band = variant == UT_EDT_BENCH_BAND || variant == UT_EDT_BENCH_BAND_INT;
+    float cutoff = band ? sdf_band_cutoff(size / 16) : EDT_INF;
+    double total_us = 0.0;
+    for (int i = 0; i < iterations; i++) {
+        memcpy(grid, seed, count * sizeof(float));
+        auto t0 = std::chrono::steady_clock::now();
+        if (variant == UT_EDT_BENCH_BAND_INT) {
+            edt_fix_2d(grid, size, size, line, scratch, cutoff);
+        } else {
+            if (variant == UT_EDT_BENCH_STRIDED)
+                edt_columns_strided(grid, size, size, f, d, z, v);
+            else
+                edt_columns_tiled(grid, size, size, d, z, v, scratch, cutoff);
+            edt_rows(grid, size, size, d, z, v, cutoff);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        total_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
     }
-    FT_Fixed buf[64];
-    unsigned int n = num_coords < 64 ? num_coords : 64;
-    for (unsigned int i = 0; i < n; i++)
-        buf[i] = (FT_Fixed)coords[i];
-    return FT_Set_Var_Design_Coordinates(face, n, buf);
-}
 
-// === sbix Diagnostic ===
-// Reads the graphicType from the first glyph in the sbix table
-// Returns 1 on success, 0 on failure
-// outGraphicType must be at least 5 bytes (4 chars + null terminator)
-UNITEXT_EXPORT int ut_debug_sbix_graphic_type(FT_Face face, char* outGraphicType, int* outNumStrikes) {
-    if (!face || !outGraphicType) return 0;
+    free(ws);
+    return total_us / iterations;
+}
 
-    outGraphicType[0] = 0;
-    if (outNumStrikes) *outNumStrikes = 0;
+// Checks the fixed-point band kernel against the float one at the cutoff
+// edge: for spreads 1..max_spread, lines whose sites sit a few float steps
+// below the (squared) cutoff, which round up to it in fixed point. Texels must
+// agree on which side of the cutoff they fall and, below it, to within one
+// fixed-point step. Returns the number of disagreeing texels (0 = pass), or
+// -1 on bad args.
+UNITEXT_EXPORT int ut_sdf_check_edt_fix(int max_spread) {
+    if (max_spread <= 0 || max_spread > 1024) return -1;
+
+    const int n = 64;
+    float fix[n], ref[n], fv[n], z[n + 1];
+    int v[n];
+    char line[n * (sizeof(int64_t) + sizeof(int32_t) * 2 + sizeof(int))];
+    edt_fix_line l;
+    edt_fix_line_init(&l, line, n);
+
+    int bad = 0;
+    for (int spread = 1; spread <= max_spread; spread++) {
+        float cutoff = sdf_band_cutoff(spread);
+        int shift = edt_fix_shift(cutoff);
+        float tol = 1.0f / (float)(1 << shift);
+        for (int ulps = 1; ulps <= 4; ulps++) {
+            float edge = cutoff;
+            for (int u = 0; u < ulps; u++) edge = nextafterf(edge, 0.0f);
+            // One edge site alone, an edge site next to a near site, and a
+            // run of edge sites (dense envelope)
+            for (int pattern = 0; pattern < 3; pattern++) {
+                for (int q = 0; q < n; q++) ref[q] = EDT_INF;
+                if (pattern == 0) ref[n / 2] = edge;
+                if (pattern == 1) { ref[n / 2] = edge; ref[n / 2 + 3] = 1.0f; }
+                if (pattern == 2) for (int q = 0; q < n; q += 2) ref[q] = edge;
+                memcpy(fix, ref, sizeof(ref));
+                edt_1d_band(ref, fv, v, z, n, cutoff);
+                edt_fix_1d_band(fix, n, &l, cutoff, shift);
+                for (int q = 0; q < n; q++) {
+                    bool in_ref = ref[q] < cutoff, in_fix = fix[q] < cutoff;
+                    if (in_ref != in_fix || (in_ref && fabsf(ref[q] - fix[q]) > tol)) bad++;
+                }
+            }
+        }
+    }
+    return bad;
+}
 
-    // Get sbix table size
-    FT_ULong length = 0;
-    FT_Error err = FT_Load_Sfnt_Table(face, FT_MAKE_TAG('s','b','i','x'), 0, NULL, &length);
-    if (err != 0 || length < 16) return 0;
+// Seeds the padded outside/inside grids (pw × ph) from an Alpha8 coverage
+// bitmap placed at (spread, spread).
+static void sdf_seed_fields(const FT_Bitmap* b, int spread, int pw, int ph, float* outside, float* inside) {
+    int bw = (int)b->width;
+    int bh = (int)b->rows;
 
-    // Load sbix table
-    FT_Byte* buffer = (FT_Byte*)malloc(length);
-    if (!buffer) return 0;
+    // Padding: outside = far, inside = 0
+    for (int y = 0; y < ph; y++) {
+        bool glyph_row = y >= spread && y < spread + bh;
+        int x_end = glyph_row ? spread : pw;
+        for (int x = 0; x < x_end; x++) { outside[y * pw + x] = EDT_INF; inside[y * pw + x] = 0.0f; }
+        if (!glyph_row) continue;
+        for (int x = spread + bw; x < pw; x++) { outside[y * pw + x] = EDT_INF; inside[y * pw + x] = 0.0f; }
+    }
 
-    err = FT_Load_Sfnt_Table(face, FT_MAKE_TAG('s','b','i','x'), 0, buffer, &length);
-    if (err != 0) {
-        free(buffer);
-        return 0;
+    const sdf_kernels* k = sdf_kernels_get();
+    for (int y = 0; y < bh; y++) {
+        const unsigned char* row  = b->buffer + y * b->pitch;
+        const unsigned char* up   = y > 0      ? row - b->pitch : nullptr;
+        const unsigned char* down = y < bh - 1 ? row + b->pitch : nullptr;
+        float* o = outside + (y + spread) * pw + spread;
+        float* in = inside + (y + spread) * pw + spread;
+
+        // Neighbors outside the bitmap read as 0 (outside glyph).
+        if (up && down && bw > 2) {
+            sdf_seed_texel(row[0], 0.0f, (float)row[1], (float)up[0], (float)down[0], &o[0], &in[0]);
+            k->seed_span(up, row, down, 1, bw - 1, o, in);
+            sdf_seed_texel(row[bw - 1], (float)row[bw - 2], 0.0f, (float)up[bw - 1], (float)down[bw - 1],
+                           &o[bw - 1], &in[bw - 1]);
+            continue;
+        }
+        for (int x = 0; x < bw; x++) {
+            float al = x > 0      ? (float)row[x - 1] : 0.0f;
+            float ar = x < bw - 1 ? (float)row[x + 1] : 0.0f;
+            float au = up         ? (float)up[x]      : 0.0f;
+            float ad = down       ? (float)down[x]    : 0.0f;
+            sdf_seed_texel(row[x], al, ar, au, ad, &o[x], &in[x]);
+        }
     }
+}
 
-    // sbix table structure:
-    // [0-1]  version (uint16)
-    // [2-3]  flags (uint16)
-    // [4-7]  numStrikes (uint32)
-    // [8...] strikeOffsets[] (uint32 each)
+// Combines the transformed fields into Alpha8 with Y-flip
+// (FreeType top-down → Unity bottom-up). dst rows are dst_pitch bytes apart.
+static void sdf_quantize_fields(const float* outside, const float* inside, int pw, int ph, int spread,
+                                unsigned char* dst, int dst_pitch) {
+    const sdf_kernels* k = sdf_kernels_get();
+    float inv_spread = spread > 0 ? 128.0f / (float)spread : 128.0f;
+    for (int y = 0; y < ph; y++)
+        k->quantize_span(outside + y * pw, inside + y * pw, pw, inv_spread, dst + (ph - 1 - y) * dst_pitch);
+}
 
-    uint32_t numStrikes = ((uint32_t)buffer[4] << 24) | ((uint32_t)buffer[5] << 16) |
-                          ((uint32_t)buffer[6] << 8) | buffer[7];
-    if (outNumStrikes) *outNumStrikes = (int)numStrikes;
+// IEEE half from float, round-to-nearest-even (overflow → ±inf).
+static inline uint16_t sdf_float_to_half(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000u;
+    x &= 0x7fffffffu;
+    if (x >= 0x47800000u)                     // ≥ 65536 (or inf/NaN)
+        return (uint16_t)(sign | (x > 0x7f800000u ? 0x7e00u : 0x7c00u));
+    if (x < 0x38800000u) {                    // below 2^-14 → subnormal / zero
+        float a;
+        memcpy(&a, &x, sizeof(a));
+        a += 0.5f;                            // aligns the mantissa at 2^-24 steps
+        memcpy(&x, &a, sizeof(x));
+        return (uint16_t)(sign | (x - 0x3f000000u));
+    }
+    uint32_t odd = (x >> 13) & 1u;
+    x += 0xc8000fffu + odd;                   // rebias exponent 127 → 15, round
+    return (uint16_t)(sign | (x >> 13));
+}
 
-    if (numStrikes == 0) {
-        free(buffer);
-        return 0;
+// Bytes per texel of an SDF output format, 0 if unsupported.
+static inline int sdf_format_bpp(int format) {
+    switch (format) {
+        case GPU_UPLOAD_FMT_R8:    return 1;
+        case GPU_UPLOAD_FMT_R16:   return 2;
+        case GPU_UPLOAD_FMT_RHALF: return 2;
+        default:                   return 0;
     }
+}
 
-    // Get first strike offset
-    uint32_t strikeOffset = ((uint32_t)buffer[8] << 24) | ((uint32_t)buffer[9] << 16) |
-                            ((uint32_t)buffer[10] << 8) | buffer[11];
+// Format-aware sdf_quantize_fields (dst_pitch in bytes):
+// - R8    → Alpha8, 128 = edge, inside > 128, ±spread range
+// - R16   → unorm16, 32768 = edge, same ±spread range at 256× the precision
+// - RHALF → signed distance in pixels (inside > 0), NOT clamped to the spread:
+//           the shader picks its own range, so one tile serves any outline/glow
+//           width that fits inside the padding
+static void sdf_encode_fields(const float* outside, const float* inside, int pw, int ph, int spread,
+                              int format, unsigned char* dst, int dst_pitch) {
+    if (format == GPU_UPLOAD_FMT_R8) {
+        sdf_quantize_fields(outside, inside, pw, ph, spread, dst, dst_pitch);
+        return;
+    }
+    float inv_spread = spread > 0 ? 32768.0f / (float)spread : 32768.0f;
+    for (int y = 0; y < ph; y++) {
+        const float* o = outside + y * pw;
+        const float* in = inside + y * pw;
+        uint16_t* row = (uint16_t*)(dst + (ph - 1 - y) * dst_pitch);
+        if (format == GPU_UPLOAD_FMT_RHALF) {
+            for (int x = 0; x < pw; x++) row[x] = sdf_float_to_half(sqrtf(in[x]) - sqrtf(o[x]));
+            continue;
+        }
+        for (int x = 0; x < pw; x++) {
+            float val = 32768.0f - (sqrtf(o[x]) - sqrtf(in[x])) * inv_spread;
+            val = val < 0.0f ? 0.0f : (val > 65535.0f ? 65535.0f : val);
+            row[x] = (uint16_t)(val + 0.5f);
+        }
+    }
+}
 
-    // Strike structure:
-    // [0-1]  ppem (uint16)
-    // [2-3]  ppi (uint16)
-    // [4...] glyphDataOffsets[] (uint32 each, numGlyphs+1 entries)
+// === Native Worker Pool ======================================================
+//
+// Persistent pool of (hardware_concurrency - 1) threads; the calling thread
+// always participates as slot 0, so a job never waits on an idle pool.
+// Jobs are index ranges pulled through an atomic counter. Each participant
+// gets a stable slot id for the duration of a job (for per-slot state such as
+// cloned FT_Faces). Calls made from inside a pool job run inline — nested
+// parallelism never deadlocks.
+//
+// The pool is intentionally leaked: joining threads from static destructors
+// deadlocks under the Windows loader lock on DLL unload.
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+typedef void (*ut_pool_fn)(void* ctx, int index, int slot);
+
+struct ut_pool_job {
+    ut_pool_fn fn;
+    void* ctx;
+    int count;
+    int max_slots;
+    std::atomic<int> next;
+    std::atomic<int> slots;
+    int active;               // helpers inside fn loop (guarded by pool mutex)
+};
+
+struct ut_pool {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<ut_pool_job*> queue;
+    int thread_count;
+};
+
+static thread_local bool t_in_pool_job = false;
+
+static void pool_run_slot(ut_pool_job* job, int slot) {
+    bool was_in_job = t_in_pool_job;
+    t_in_pool_job = true;
+    int i;
+    while ((i = job->next.fetch_add(1, std::memory_order_relaxed)) < job->count)
+        job->fn(job->ctx, i, slot);
+    t_in_pool_job = was_in_job;
+}
 
-    if (strikeOffset + 8 >= length) {
-        free(buffer);
-        return 0;
+static void pool_worker_main(ut_pool* pool) {
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    for (;;) {
+        pool->wake.wait(lock, [pool] { return !pool->queue.empty(); });
+        ut_pool_job* job = pool->queue.front();
+        int slot = job->slots.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= job->max_slots || job->next.load(std::memory_order_relaxed) >= job->count) {
+            // Job is saturated — retire it so other queued jobs get served.
+            pool->queue.pop_front();
+            continue;
+        }
+        job->active++;
+        lock.unlock();
+        pool_run_slot(job, slot);
+        lock.lock();
+        if (--job->active == 0) pool->idle.notify_all();
     }
+}
 
-    // Get number of glyphs to find first non-empty glyph data
-    FT_ULong numGlyphs = face->num_glyphs;
+static ut_pool* pool_get() {
+    static ut_pool* pool = [] {
+        ut_pool* p = new ut_pool();
+        unsigned hc = std::thread::hardware_concurrency();
+        p->thread_count = hc > 1 ? (int)(hc > 64 ? 63 : hc - 1) : 0;
+        for (int t = 0; t < p->thread_count; t++)
+            std::thread(pool_worker_main, p).detach();
+        return p;
+    }();
+    return pool;
+}
 
-    // Find first glyph with actual data
-    for (FT_ULong g = 0; g < numGlyphs && g < 10000; g++) {
-        uint32_t offsetIdx = strikeOffset + 4 + g * 4;
-        if (offsetIdx + 8 > length) break;
+// Runs fn(ctx, i, slot) for i in [0, count) on up to max_slots threads.
+// slot is in [0, max_slots). Returns after every index has completed.
+static void pool_parallel_for(int count, int max_slots, ut_pool_fn fn, void* ctx) {
+    if (count <= 0) return;
+    ut_pool* pool = pool_get();
+    int limit = pool->thread_count + 1;
+    if (max_slots <= 0 || max_slots > limit) max_slots = limit;
+    if (max_slots > count) max_slots = count;
+    if (max_slots <= 1 || t_in_pool_job) {
+        for (int i = 0; i < count; i++) fn(ctx, i, 0);
+        return;
+    }
 
-        uint32_t glyphDataOffset = ((uint32_t)buffer[offsetIdx] << 24) |
-                                   ((uint32_t)buffer[offsetIdx + 1] << 16) |
-                                   ((uint32_t)buffer[offsetIdx + 2] << 8) |
-                                   buffer[offsetIdx + 3];
-        uint32_t nextGlyphDataOffset = ((uint32_t)buffer[offsetIdx + 4] << 24) |
-                                       ((uint32_t)buffer[offsetIdx + 5] << 16) |
-                                       ((uint32_t)buffer[offsetIdx + 6] << 8) |
-                                       buffer[offsetIdx + 7];
+    ut_pool_job job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.count = count;
+    job.max_slots = max_slots;
+    job.next.store(0, std::memory_order_relaxed);
+    job.slots.store(1, std::memory_order_relaxed);  // slot 0 = caller
+    job.active = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->queue.push_back(&job);
+    }
+    pool->wake.notify_all();
 
-        // Check if this glyph has data
-        if (nextGlyphDataOffset > glyphDataOffset) {
-            // Glyph data structure:
-            // [0-1]  originOffsetX (int16)
-            // [2-3]  originOffsetY (int16)
-            // [4-7]  graphicType (4 chars)
-            // [8...] data
+    pool_run_slot(&job, 0);
 
-            uint32_t dataPos = strikeOffset + glyphDataOffset;
-            if (dataPos + 8 <= length) {
-                outGraphicType[0] = (char)buffer[dataPos + 4];
-                outGraphicType[1] = (char)buffer[dataPos + 5];
-                outGraphicType[2] = (char)buffer[dataPos + 6];
-                outGraphicType[3] = (char)buffer[dataPos + 7];
-                outGraphicType[4] = 0;
-                free(buffer);
-                return 1;
-            }
-        }
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    for (auto it = pool->queue.begin(); it != pool->queue.end(); ++it) {
+        if (*it == &job) { pool->queue.erase(it); break; }
     }
-
-    free(buffer);
-    return 0;
+    pool->idle.wait(lock, [&job] { return job.active == 0; });
 }
 
-// =============================================================================
-// FreeType Wrapper Functions
-// =============================================================================
+// === Intra-glyph Parallel EDT ================================================
+//
+// A single huge glyph (512–1024 px emoji, splash-screen titles) keeps one core
+// busy for tens of milliseconds, and batch parallelism does not help it. At or
+// above a padded pixel-count threshold, sdf_render_fields splits both EDT
+// passes across the pool: the column pass in strips of SDF_EDT_STRIP columns,
+// the row pass in groups of SDF_EDT_STRIP rows, each slot with its own d/z/v
+// line and strip scratch. Every line runs the same kernel as the serial path,
+// so output is bit-identical. Renders already inside a pool job (batch) stay
+// serial.
+
+static std::atomic<int> g_sdf_parallel_pixels{256 * 256};
+
+// Padded glyph size (width × height, spread included) from which a single SDF
+// render splits its EDT across the worker pool. <= 0 disables. Default 65536.
+UNITEXT_EXPORT void ut_ft_set_sdf_parallel_threshold(int pixel_count) {
+    g_sdf_parallel_pixels.store(pixel_count, std::memory_order_relaxed);
+}
 
-UNITEXT_EXPORT void ut_ft_get_face_info(FT_Face face, long long* out_face_flags, int* out_num_glyphs,
-                                              int* out_units_per_em, int* out_num_fixed_sizes,
-                                              int* out_num_faces, int* out_face_index,
-                                              short* out_ascender, short* out_descender, short* out_height) {
-    if (!face) return;
-    if (out_face_flags) *out_face_flags = (long long)face->face_flags;
-    if (out_num_glyphs) *out_num_glyphs = (int)face->num_glyphs;
-    if (out_units_per_em) *out_units_per_em = face->units_per_EM;
-    if (out_num_fixed_sizes) *out_num_fixed_sizes = face->num_fixed_sizes;
-    if (out_num_faces) *out_num_faces = (int)face->num_faces;
-    if (out_face_index) *out_face_index = (int)face->face_index;
-    if (out_ascender) *out_ascender = face->ascender;
-    if (out_descender) *out_descender = face->descender;
-    if (out_height) *out_height = face->height;
+// Slots a pw×ph EDT should use: 1 below the threshold, inside a pool job, or
+// on a single-core machine.
+static int sdf_edt_slot_count(int pw, int ph) {
+    int threshold = g_sdf_parallel_pixels.load(std::memory_order_relaxed);
+    if (threshold <= 0 || (long long)pw * ph < threshold || t_in_pool_job) return 1;
+    int slots = pool_get()->thread_count + 1;
+    int strips = ((pw < ph ? pw : ph) + SDF_EDT_STRIP - 1) / SDF_EDT_STRIP;
+    return slots < strips ? slots : strips;
 }
 
-// Reads OS/2 table metrics + post table underline + face names + weight/style.
-// Returns 1 if OS/2 table was found, 0 otherwise. Post/name/style data is always filled if available.
-UNITEXT_EXPORT int ut_ft_get_extended_face_info(FT_Face face,
-    // OS/2 table
-    short* out_cap_height, short* out_x_height,
-    short* out_y_superscript_y_offset, short* out_y_superscript_y_size,
-    short* out_y_subscript_y_offset, short* out_y_subscript_y_size,
-    short* out_y_strikeout_position, short* out_y_strikeout_size,
-    // post table (via FT_FaceRec)
-    short* out_underline_position, short* out_underline_thickness,
-    // name table (via FT_FaceRec)
-    const char** out_family_name, const char** out_style_name,
-    // weight & style (OS/2 usWeightClass + FT_FaceRec style_flags)
-    short* out_weight_class, int* out_style_flags)
-{
-    if (!face) return 0;
+// Per-slot line scratch for edt_1d_band_pair — d[2 * maxdim], z[2 * (maxdim + 1)],
+// v[2 * maxdim] — or the fixed-point envelope, whichever is larger, rounded to
+// a cache line so neighbouring slots never share one.
+static size_t sdf_edt_line_bytes(int maxdim) {
+    size_t bytes = (size_t)maxdim * sizeof(float) * 2 + (size_t)(maxdim + 1) * sizeof(float) * 2
+                 + (size_t)maxdim * sizeof(int) * 2;
+    size_t fix_bytes = edt_fix_line_bytes(maxdim);
+    if (fix_bytes > bytes) bytes = fix_bytes;
+    return (bytes + 63) & ~(size_t)63;
+}
 
-    // Post table fields from FT_FaceRec
-    if (out_underline_position) *out_underline_position = face->underline_position;
-    if (out_underline_thickness) *out_underline_thickness = face->underline_thickness;
+struct sdf_edt_job {
+    float* outside;
+    float* inside;
+    float* scratch;           // slot s strip at scratch + s * edt_strip_scratch(h)
+    char* lines;              // slot s scratch at lines + s * line_bytes
+    size_t line_bytes;
+    int w, h, maxdim;
+    float cutoff;
+    int fix_shift;            // fixed-point EDT with this shift; < 0 = float
+};
+
+static void sdf_edt_job_lines(const sdf_edt_job* job, int slot, float** d, float** z, int** v) {
+    *d = (float*)(job->lines + (size_t)slot * job->line_bytes);
+    *z = *d + job->maxdim * 2;
+    *v = (int*)(*z + (job->maxdim + 1) * 2);
+}
 
-    // Name table fields from FT_FaceRec
-    if (out_family_name) *out_family_name = face->family_name;
-    if (out_style_name) *out_style_name = face->style_name;
+static void sdf_edt_column_strip(void* ctx, int index, int slot) {
+    const sdf_edt_job* job = (const sdf_edt_job*)ctx;
+    float* d; float* z; int* v;
+    sdf_edt_job_lines(job, slot, &d, &z, &v);
+    float* scratch = job->scratch + (size_t)slot * edt_strip_scratch(job->h);
+    int x0 = index * SDF_EDT_STRIP;
+    int x1 = x0 + SDF_EDT_STRIP < job->w ? x0 + SDF_EDT_STRIP : job->w;
+    if (job->fix_shift >= 0) {
+        edt_fix_line l;
+        edt_fix_line_init(&l, (char*)d, job->maxdim);
+        edt_fix_pair_columns(job->outside, job->inside, job->w, job->h, x0, x1, &l, scratch,
+                             job->cutoff, job->fix_shift);
+        return;
+    }
+    edt_pair_columns(job->outside, job->inside, job->w, job->h, x0, x1, d, z, v, scratch, job->cutoff);
+}
 
-    // Style flags from FT_FaceRec (always available)
-    if (out_style_flags) *out_style_flags = (int)face->style_flags;
+static void sdf_edt_row_group(void* ctx, int index, int slot) {
+    const sdf_edt_job* job = (const sdf_edt_job*)ctx;
+    float* d; float* z; int* v;
+    sdf_edt_job_lines(job, slot, &d, &z, &v);
+    int y0 = index * SDF_EDT_STRIP;
+    int y1 = y0 + SDF_EDT_STRIP < job->h ? y0 + SDF_EDT_STRIP : job->h;
+    if (job->fix_shift >= 0) {
+        edt_fix_line l;
+        edt_fix_line_init(&l, (char*)d, job->maxdim);
+        edt_fix_pair_rows(job->outside, job->inside, job->w, y0, y1, &l, job->cutoff, job->fix_shift);
+        return;
+    }
+    edt_pair_rows(job->outside, job->inside, job->w, y0, y1, d, z, v, job->cutoff);
+}
 
-    // Default weight class (overwritten below if OS/2 exists)
-    if (out_weight_class) *out_weight_class = 0;
+// edt_2d_pair (or edt_fix_2d_pair when `fixed`) across `slots` pool slots.
+// lines holds slots × sdf_edt_line_bytes(maxdim), scratch slots × edt_strip_scratch(h).
+static void edt_2d_pair_parallel(float* outside, float* inside, int w, int h, char* lines,
+                                 float* scratch, float cutoff, bool fixed, int slots) {
+    sdf_edt_job job;
+    job.outside = outside;
+    job.inside = inside;
+    job.scratch = scratch;
+    job.lines = lines;
+    job.w = w;
+    job.h = h;
+    job.maxdim = w > h ? w : h;
+    job.line_bytes = sdf_edt_line_bytes(job.maxdim);
+    job.cutoff = cutoff;
+    job.fix_shift = fixed ? edt_fix_shift(cutoff) : -1;
+    pool_parallel_for((w + SDF_EDT_STRIP - 1) / SDF_EDT_STRIP, slots, sdf_edt_column_strip, &job);
+    pool_parallel_for((h + SDF_EDT_STRIP - 1) / SDF_EDT_STRIP, slots, sdf_edt_row_group, &job);
+}
 
-    // OS/2 table
-    TT_OS2* os2 = (TT_OS2*)FT_Get_Sfnt_Table(face, FT_SFNT_OS2);
-    if (!os2) return 0;
+// === Per-face Outline Cache ==================================================
+//
+// Unscaled (design unit) outlines + metrics, decoded once per glyph and read
+// by ut_ft_outline_decompose(_packed/_batch), ut_ft_glyph_to_blpath and the
+// coverage SDF path, so a glyph drawn as SDF + Blend2D layer + curves is
+// parsed once. Opt-in per face (ut_ft_outline_cache_enable); LRU-evicted to
+// a byte cap. Lives in face->generic, so FT_Done_Face frees it, and follows
+// the face's threading rules. Entries belong to the blend coordinates and the
+// FT_Set_Transform matrix/delta they were decoded at (FreeType transforms
+// NO_SCALE loads too): a lookup that finds different ones, however they were
+// set, flushes the cache first.
+//
+// The decompose paths read it exactly (they load NO_SCALE anyway). The SDF
+// path serves unhinted, non-colour, untransformed loads from it by scaling the
+// points with FT_MulFix and rasterizing via FT_Outline_Get_Bitmap. That only
+// matches FreeType's scaled load for simple glyf glyphs whose hmtx lsb equals
+// their header xMin, in a face without variations: the TrueType driver scales
+// the points and phantom points one by one, so the origin shift (pp1.x =
+// xMin - lsb) and the advance come out of scaled values, and composites and
+// variation deltas are scaled separately too. Every other glyph, and every
+// CFF/Type 1 glyph (whose charstrings round in design units before scaling),
+// goes through FreeType.
+
+#define OUTLINE_CACHE_MAX_COORDS 16
+
+struct outline_cache_entry {
+    unsigned int glyph;
+    bool is_outline;            // false: bitmap/colour-only glyph, fall back to FreeType
+    bool scales_exactly;        // FT_MulFix of the points == the driver's scaled load
+    FT_Glyph_Metrics metrics;   // unscaled (FT_LOAD_NO_SCALE)
+    FT_Outline outline;         // views this entry's trailing storage
+    size_t bytes;
+    outline_cache_entry* hash_next;
+    outline_cache_entry* lru_prev;   // toward most recent
+    outline_cache_entry* lru_next;   // toward least recent
+};
+
+struct outline_cache {
+    outline_cache_entry** buckets = nullptr;
+    unsigned bucket_mask = 0;
+    outline_cache_entry* lru_head = nullptr;    // most recent
+    outline_cache_entry* lru_tail = nullptr;
+    size_t max_bytes = 0;
+    size_t used_bytes = 0;
+    int entries = 0;
+    unsigned hits = 0;
+    unsigned misses = 0;
+    bool truetype = false;      // glyf outlines: the only ones the SDF path may scale itself
+    FT_Fixed coords[OUTLINE_CACHE_MAX_COORDS] = {};  // blend coordinates the entries belong to
+    FT_Matrix matrix = {0x10000, 0, 0, 0x10000};     // transform the entries belong to
+    FT_Vector delta = {0, 0};
+};
+
+static void outline_cache_finalize(void* object);
+
+// The face's cache, or NULL when disabled (or the generic slot belongs to someone else).
+static outline_cache* outline_cache_of(FT_Face face) {
+    return face && face->generic.finalizer == outline_cache_finalize ? (outline_cache*)face->generic.data : nullptr;
+}
 
-    if (out_cap_height) *out_cap_height = os2->sCapHeight;
-    if (out_x_height) *out_x_height = os2->sxHeight;
-    if (out_y_superscript_y_offset) *out_y_superscript_y_offset = os2->ySuperscriptYOffset;
-    if (out_y_superscript_y_size) *out_y_superscript_y_size = os2->ySuperscriptYSize;
-    if (out_y_subscript_y_offset) *out_y_subscript_y_offset = os2->ySubscriptYOffset;
-    if (out_y_subscript_y_size) *out_y_subscript_y_size = os2->ySubscriptYSize;
-    if (out_y_strikeout_position) *out_y_strikeout_position = os2->yStrikeoutPosition;
-    if (out_y_strikeout_size) *out_y_strikeout_size = os2->yStrikeoutSize;
-    if (out_weight_class) *out_weight_class = (short)os2->usWeightClass;
+static void outline_cache_clear(outline_cache* c) {
+    for (outline_cache_entry* e = c->lru_head; e;) {
+        outline_cache_entry* next = e->lru_next;
+        free(e);
+        e = next;
+    }
+    memset(c->buckets, 0, sizeof(outline_cache_entry*) * (c->bucket_mask + 1));
+    c->lru_head = c->lru_tail = nullptr;
+    c->used_bytes = 0;
+    c->entries = 0;
+}
 
-    return 1;
+static void outline_cache_finalize(void* object) {
+    FT_Face face = (FT_Face)object;
+    outline_cache* c = (outline_cache*)face->generic.data;
+    if (!c) return;
+    outline_cache_clear(c);
+    free(c->buckets);
+    delete c;
+    face->generic.data = nullptr;
 }
 
-UNITEXT_EXPORT int ut_ft_get_fixed_size(FT_Face face, int index) {
-    if (!face || index < 0 || index >= face->num_fixed_sizes) return 0;
-    return face->available_sizes[index].height;
+static void outline_cache_unlink(outline_cache* c, outline_cache_entry* e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next; else c->lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev; else c->lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = nullptr;
 }
 
-UNITEXT_EXPORT void ut_ft_get_glyph_metrics(FT_Face face, int* out_width, int* out_height,
-                                                  int* out_bearing_x, int* out_bearing_y,
-                                                  int* out_advance_x, int* out_advance_y) {
-    if (!face || !face->glyph) return;
-    FT_Glyph_Metrics* m = &face->glyph->metrics;
-    if (out_width) *out_width = (int)(m->width >> 6);
-    if (out_height) *out_height = (int)(m->height >> 6);
-    if (out_bearing_x) *out_bearing_x = (int)(m->horiBearingX >> 6);
-    if (out_bearing_y) *out_bearing_y = (int)(m->horiBearingY >> 6);
-    if (out_advance_x) *out_advance_x = (int)m->horiAdvance;
-    if (out_advance_y) *out_advance_y = (int)m->vertAdvance;
+static void outline_cache_push_front(outline_cache* c, outline_cache_entry* e) {
+    e->lru_prev = nullptr;
+    e->lru_next = c->lru_head;
+    if (c->lru_head) c->lru_head->lru_prev = e; else c->lru_tail = e;
+    c->lru_head = e;
 }
 
-UNITEXT_EXPORT void ut_ft_get_bitmap_info(FT_Face face, int* out_width, int* out_height,
-                                                int* out_pitch, int* out_pixel_mode, void** out_buffer) {
-    if (!face || !face->glyph) return;
-    FT_Bitmap* b = &face->glyph->bitmap;
-    if (out_width) *out_width = (int)b->width;
-    if (out_height) *out_height = (int)b->rows;
-    if (out_pitch) *out_pitch = b->pitch;
-    if (out_pixel_mode) *out_pixel_mode = b->pixel_mode;
-    if (out_buffer) *out_buffer = b->buffer;
+static void outline_cache_evict(outline_cache* c, outline_cache_entry* e) {
+    outline_cache_entry** link = &c->buckets[e->glyph & c->bucket_mask];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+    outline_cache_unlink(c, e);
+    c->used_bytes -= e->bytes;
+    c->entries--;
+    free(e);
 }
 
-UNITEXT_EXPORT FT_GlyphSlot ut_ft_get_glyph_slot(FT_Face face) {
-    return face ? face->glyph : nullptr;
+// Reads a big-endian 2- or 4-byte value at offset in an sfnt table. Returns
+// false when the table is missing or too short.
+static bool sfnt_read_be(FT_Face face, FT_ULong tag, FT_Long offset, int bytes, FT_ULong* out) {
+    FT_Byte b[4];
+    FT_ULong length = (FT_ULong)bytes;
+    if (FT_Load_Sfnt_Table(face, tag, offset, b, &length) || length != (FT_ULong)bytes) return false;
+    FT_ULong v = 0;
+    for (int i = 0; i < bytes; i++) v = (v << 8) | b[i];
+    *out = v;
+    return true;
 }
 
-UNITEXT_EXPORT int ut_ft_get_bitmap_top(FT_Face face) {
-    if (!face || !face->glyph) return 0;
-    return face->glyph->bitmap_top;
+// True for a simple (non-composite) glyf glyph whose hmtx lsb equals its
+// header xMin, i.e. the TrueType driver's pp1.x is 0. Empty glyphs count when
+// their lsb is 0.
+static bool tt_glyph_simple_at_lsb(FT_Face face, unsigned int glyph_index) {
+    TT_Header* head = (TT_Header*)FT_Get_Sfnt_Table(face, FT_SFNT_HEAD);
+    TT_HoriHeader* hhea = (TT_HoriHeader*)FT_Get_Sfnt_Table(face, FT_SFNT_HHEA);
+    if (!head || !hhea || glyph_index >= (unsigned)face->num_glyphs) return false;
+
+    const FT_ULong loca = FT_MAKE_TAG('l', 'o', 'c', 'a');
+    const FT_ULong hmtx = FT_MAKE_TAG('h', 'm', 't', 'x');
+    const FT_ULong glyf = FT_MAKE_TAG('g', 'l', 'y', 'f');
+    FT_ULong start, end;
+    if (head->Index_To_Loc_Format) {
+        if (!sfnt_read_be(face, loca, (FT_Long)glyph_index * 4, 4, &start) ||
+            !sfnt_read_be(face, loca, (FT_Long)glyph_index * 4 + 4, 4, &end)) return false;
+    } else {
+        if (!sfnt_read_be(face, loca, (FT_Long)glyph_index * 2, 2, &start) ||
+            !sfnt_read_be(face, loca, (FT_Long)glyph_index * 2 + 2, 2, &end)) return false;
+        start *= 2;
+        end *= 2;
+    }
+
+    unsigned num_h = hhea->number_Of_HMetrics;
+    if (num_h == 0) return false;
+    FT_Long lsb_offset = glyph_index < num_h ? (FT_Long)glyph_index * 4 + 2
+                                             : (FT_Long)num_h * 4 + (FT_Long)(glyph_index - num_h) * 2;
+    FT_ULong lsb;
+    if (!sfnt_read_be(face, hmtx, lsb_offset, 2, &lsb)) return false;
+
+    if (end <= start) return lsb == 0;
+    FT_ULong contours, x_min;
+    if (!sfnt_read_be(face, glyf, (FT_Long)start, 2, &contours) ||
+        !sfnt_read_be(face, glyf, (FT_Long)start + 2, 2, &x_min)) return false;
+    return (int16_t)contours >= 0 && x_min == lsb;
 }
 
-UNITEXT_EXPORT int ut_ft_get_bitmap_left(FT_Face face) {
-    if (!face || !face->glyph) return 0;
-    return face->glyph->bitmap_left;
+// Flushes the cache when the face's blend coordinates or transform moved since
+// the last lookup. Excess coordinates come back as 0, so the axis count is not
+// needed.
+static void outline_cache_sync(FT_Face face, outline_cache* c) {
+    FT_Fixed coords[OUTLINE_CACHE_MAX_COORDS] = {};
+    if (FT_HAS_MULTIPLE_MASTERS(face))
+        FT_Get_Var_Blend_Coordinates(face, OUTLINE_CACHE_MAX_COORDS, coords);
+    FT_Matrix matrix;
+    FT_Vector delta;
+    FT_Get_Transform(face, &matrix, &delta);
+    if (memcmp(coords, c->coords, sizeof(coords)) == 0 &&
+        matrix.xx == c->matrix.xx && matrix.xy == c->matrix.xy &&
+        matrix.yx == c->matrix.yx && matrix.yy == c->matrix.yy &&
+        delta.x == c->delta.x && delta.y == c->delta.y) return;
+    outline_cache_clear(c);
+    memcpy(c->coords, coords, sizeof(coords));
+    c->matrix = matrix;
+    c->delta = delta;
 }
 
-// =============================================================================
-// FreeType Outline to Blend2D Path
-// =============================================================================
+// Cached outline of glyph_index, decoding it on a miss. Returns NULL when the
+// face has no cache (or on OOM) and sets *err on a FreeType load error; the
+// entry stays valid until the next cache call on the same face.
+static const outline_cache_entry* outline_cache_get(FT_Face face, unsigned int glyph_index, int* err) {
+    *err = 0;
+    outline_cache* c = outline_cache_of(face);
+    if (!c) return nullptr;
+    outline_cache_sync(face, c);
+
+    for (outline_cache_entry* e = c->buckets[glyph_index & c->bucket_mask]; e; e = e->hash_next) {
+        if (e->glyph != glyph_index) continue;
+        c->hits++;
+        if (c->lru_head != e) {
+            outline_cache_unlink(c, e);
+            outline_cache_push_front(c, e);
+        }
+        return e;
+    }
 
-UNITEXT_EXPORT int ut_ft_outline_to_blpath(FT_Face face, void* blPath) {
-    if (!face || !face->glyph || !blPath) return 0;
+    c->misses++;
+    bool scales_exactly = c->truetype && !FT_HAS_MULTIPLE_MASTERS(face) &&
+                          tt_glyph_simple_at_lsb(face, glyph_index);
+    FT_Error ft_err = FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_BITMAP | FT_LOAD_NO_SCALE);
+    if (ft_err) { *err = (int)ft_err; return nullptr; }
+
+    const FT_Outline* src = &face->glyph->outline;
+    bool is_outline = face->glyph->format == FT_GLYPH_FORMAT_OUTLINE;
+    int n_points = is_outline && src->n_points > 0 ? src->n_points : 0;
+    int n_contours = n_points ? src->n_contours : 0;
+    size_t points_bytes = (size_t)n_points * sizeof(FT_Vector);
+    size_t contours_bytes = (size_t)n_contours * sizeof(*src->contours);
+    size_t bytes = sizeof(outline_cache_entry) + points_bytes + contours_bytes + (size_t)n_points;
+
+    // Evict from the cold end; a single glyph over the cap still gets cached.
+    while (c->lru_tail && c->used_bytes + bytes > c->max_bytes) outline_cache_evict(c, c->lru_tail);
+
+    outline_cache_entry* e = (outline_cache_entry*)malloc(bytes);
+    if (!e) return nullptr;
+    memset(e, 0, sizeof(outline_cache_entry));
+    e->glyph = glyph_index;
+    e->is_outline = is_outline;
+    e->scales_exactly = scales_exactly;
+    e->metrics = face->glyph->metrics;
+    e->bytes = bytes;
+    char* p = (char*)(e + 1);
+    e->outline.points = (FT_Vector*)p;
+    e->outline.contours = (decltype(e->outline.contours))(p + points_bytes);
+    e->outline.tags = (decltype(e->outline.tags))(p + points_bytes + contours_bytes);
+    e->outline.n_points = (decltype(e->outline.n_points))n_points;
+    e->outline.n_contours = (decltype(e->outline.n_contours))n_contours;
+    e->outline.flags = is_outline ? src->flags : 0;
+    if (n_points) {
+        memcpy(e->outline.points, src->points, points_bytes);
+        memcpy(e->outline.contours, src->contours, contours_bytes);
+        memcpy(e->outline.tags, src->tags, (size_t)n_points);
+    }
 
-    FT_Outline* outline = &face->glyph->outline;
-    if (outline->n_points <= 0) return 0;
+    outline_cache_entry** bucket = &c->buckets[glyph_index & c->bucket_mask];
+    e->hash_next = *bucket;
+    *bucket = e;
+    outline_cache_push_front(c, e);
+    c->used_bytes += bytes;
+    c->entries++;
+    return e;
+}
 
-    BLPath* path = static_cast<BLPath*>(blPath);
-    path->clear();
+// Unscaled outline of a glyph for the decompose paths: from the face's cache
+// when enabled, else a FT_LOAD_NO_SCALE load into the glyph slot. *outline
+// and *metrics point at cache or slot storage (valid until the next load).
+// *is_outline is false for bitmap/colour-only glyphs.
+static int outline_load_unscaled(FT_Face face, unsigned int glyph_index, const FT_Outline** outline,
+                                 const FT_Glyph_Metrics** metrics, bool* is_outline) {
+    int err;
+    const outline_cache_entry* e = outline_cache_get(face, glyph_index, &err);
+    if (err) return err;
+    if (e) {
+        *outline = &e->outline;
+        *metrics = &e->metrics;
+        *is_outline = e->is_outline;
+        return 0;
+    }
+    FT_Error ft_err = FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_BITMAP | FT_LOAD_NO_SCALE);
+    if (ft_err) return (int)ft_err;
+    *outline = &face->glyph->outline;
+    *metrics = &face->glyph->metrics;
+    *is_outline = face->glyph->format == FT_GLYPH_FORMAT_OUTLINE;
+    return 0;
+}
 
-    int contourStart = 0;
-    for (int c = 0; c < outline->n_contours; c++) {
-        int contourEnd = outline->contours[c];
+// Enables (or resizes) the face's outline cache with a byte cap; max_bytes
+// <= 0 disables and frees it. Returns -1 when the face's generic slot is
+// already taken by someone else, or on OOM.
+UNITEXT_EXPORT int ut_ft_outline_cache_enable(FT_Face face, long max_bytes) {
+    if (!face) return -1;
+    outline_cache* c = outline_cache_of(face);
+    if (max_bytes <= 0) {
+        if (c) {
+            outline_cache_finalize(face);
+            face->generic.finalizer = nullptr;
+        }
+        return 0;
+    }
+    if (!c) {
+        if (face->generic.data || face->generic.finalizer) return -1;
+        c = new outline_cache();
+        // ~4 glyphs per bucket at full occupancy; CJK faces stay under 128 KB.
+        unsigned buckets = 64;
+        while (buckets < 16384 && buckets * 4 < (unsigned)face->num_glyphs) buckets *= 2;
+        c->buckets = (outline_cache_entry**)calloc(buckets, sizeof(outline_cache_entry*));
+        if (!c->buckets) {
+            delete c;
+            return -1;
+        }
+        c->bucket_mask = buckets - 1;
+        FT_ULong glyf_length = 0;
+        c->truetype = FT_Load_Sfnt_Table(face, FT_MAKE_TAG('g', 'l', 'y', 'f'), 0, nullptr, &glyf_length) == 0;
+        face->generic.data = c;
+        face->generic.finalizer = outline_cache_finalize;
+    }
+    c->max_bytes = (size_t)max_bytes;
+    while (c->lru_tail && c->used_bytes > c->max_bytes) outline_cache_evict(c, c->lru_tail);
+    return 0;
+}
+
+UNITEXT_EXPORT void ut_ft_outline_cache_stats(FT_Face face, int* out_entries, long* out_bytes,
+                                              unsigned int* out_hits, unsigned int* out_misses) {
+    outline_cache* c = outline_cache_of(face);
+    if (out_entries) *out_entries = c ? c->entries : 0;
+    if (out_bytes)   *out_bytes   = c ? (long)c->used_bytes : 0;
+    if (out_hits)    *out_hits    = c ? c->hits : 0;
+    if (out_misses)  *out_misses  = c ? c->misses : 0;
+}
+
+// === SDF Workspace ============================================================
+//
+// Padded outside/inside grids + EDT scratch for one glyph. Grows to the largest
+// glyph seen and is reused, so steady-state rendering does not touch the heap.
+// Every thread has an implicit workspace; callers managing their own threads
+// can hold an explicit handle instead (one render at a time per handle).
+//
+// The implicit ones keep at most the retain limit between calls: a larger
+// buffer is freed when the outermost render on that thread returns, so one
+// huge glyph does not pin megabytes on every pool thread for the life of the
+// process. Explicit handles are never trimmed.
+
+#define SDF_WORKSPACE_RETAIN_DEFAULT (4 << 20)
+
+struct ut_sdf_workspace {
+    char* buf = nullptr;
+    size_t cap = 0;
+    ~ut_sdf_workspace() { free(buf); }
+};
+
+static thread_local ut_sdf_workspace t_sdf_workspace;
+static thread_local ut_sdf_workspace t_sdf_coverage_workspace;
+// Per-thread scratch for decomposed outlines (analytic SDF, curve atlas).
+static thread_local ut_sdf_workspace t_sdf_outline_workspace;
+static thread_local int t_sdf_workspace_depth = 0;
+static std::atomic<long> g_sdf_workspace_retain{SDF_WORKSPACE_RETAIN_DEFAULT};
+
+static char* sdf_workspace_reserve(ut_sdf_workspace* ws, size_t size) {
+    if (size > ws->cap) {
+        // Contents are scratch — no need to preserve them across growth.
+        size_t grown = ws->cap + ws->cap / 2;
+        if (grown > size) size = grown;
+        free(ws->buf);
+        ws->buf = (char*)malloc(size);
+        ws->cap = ws->buf ? size : 0;
+    }
+    return ws->buf;
+}
+
+static void sdf_workspace_trim(ut_sdf_workspace* ws, long retain) {
+    if (retain < 0 || ws->cap <= (size_t)retain) return;
+    free(ws->buf);
+    ws->buf = nullptr;
+    ws->cap = 0;
+}
+
+static void sdf_workspace_trim_thread(long retain) {
+    sdf_workspace_trim(&t_sdf_workspace, retain);
+    sdf_workspace_trim(&t_sdf_coverage_workspace, retain);
+    sdf_workspace_trim(&t_sdf_outline_workspace, retain);
+}
+
+// Opened by every export that uses the implicit workspaces; the outermost one
+// on a thread applies the retain limit on return.
+struct sdf_workspace_scope {
+    sdf_workspace_scope() { t_sdf_workspace_depth++; }
+    ~sdf_workspace_scope() {
+        if (--t_sdf_workspace_depth == 0)
+            sdf_workspace_trim_thread(g_sdf_workspace_retain.load(std::memory_order_relaxed));
+    }
+};
+
+// Bytes each thread's implicit workspaces may keep between renders (default
+// 4 MB). 0 frees them after every render; negative never trims.
+UNITEXT_EXPORT void ut_sdf_set_workspace_retain_limit(long max_bytes) {
+    g_sdf_workspace_retain.store(max_bytes, std::memory_order_relaxed);
+}
+
+// Frees the calling thread's implicit workspaces now. Pool threads are held to
+// the retain limit after each glyph they render.
+UNITEXT_EXPORT void ut_sdf_release_thread_workspace() {
+    if (t_sdf_workspace_depth == 0) sdf_workspace_trim_thread(0);
+}
+
+UNITEXT_EXPORT ut_sdf_workspace* ut_sdf_workspace_create() {
+    return new ut_sdf_workspace();
+}
+
+UNITEXT_EXPORT void ut_sdf_workspace_destroy(ut_sdf_workspace* ws) {
+    delete ws;
+}
+
+// === Combined SDF Glyph Render (FT_RENDER_MODE_NORMAL + EDT) =================
+//
+// Renders glyph as anti-aliased bitmap, then computes SDF via Felzenszwalb EDT.
+// Output is Alpha8 SDF with spread-pixel padding. ut_ft_render_sdf_glyph
+// returns a malloc'd bmp_buffer — caller MUST free via ut_ft_free_sdf_buffer().
+// ut_ft_render_sdf_glyph_into / _to_region write into caller-owned memory instead.
+
+typedef struct {
+    int success;          // 0 = ok, non-zero = FreeType error
+    // Outline metrics (26.6 fixed-point >> 6, read BEFORE render)
+    int metric_width;
+    int metric_height;
+    int metric_bearing_x;
+    int metric_bearing_y;
+    int metric_advance_x; // 26.6 raw (NOT shifted), caller divides by 64
+    // SDF bitmap (padded by spread on each side)
+    int bmp_width;
+    int bmp_height;
+    int bmp_pitch;
+    int bitmap_left;
+    int bitmap_top;
+    void* bmp_buffer;     // malloc'd Alpha8 SDF — caller must free
+} ut_sdf_glyph_result;
+
+// Steps 1–3 from the face's outline cache: the design-unit outline scaled to
+// the face size and rasterized like FT_RENDER_MODE_NORMAL over its cbox
+// floored/ceiled to whole pixels. Returns 1 when served, 0 when the load has
+// to go through FreeType (no cache, hinting, colour, embedded strikes, a
+// transform, non-outline, overlap-flagged or not exactly scalable glyph; see
+// Per-face Outline Cache), else an error.
+static int sdf_cached_coverage(FT_Face face, unsigned int glyph_index, int load_flags,
+                               FT_Glyph_Metrics* m, FT_Bitmap* bmp, int* left, int* top) {
+    if (!outline_cache_of(face) || !face->size || !(load_flags & FT_LOAD_NO_HINTING)) return 0;
+    if (load_flags & (FT_LOAD_NO_SCALE | FT_LOAD_COLOR | FT_LOAD_VERTICAL_LAYOUT | FT_LOAD_MONOCHROME)) return 0;
+    if (FT_HAS_FIXED_SIZES(face) && !(load_flags & FT_LOAD_NO_BITMAP)) return 0;
+    FT_Matrix matrix;
+    FT_Vector delta;
+    FT_Get_Transform(face, &matrix, &delta);
+    if (matrix.xx != 0x10000 || matrix.xy || matrix.yx || matrix.yy != 0x10000 || delta.x || delta.y) return 0;
+
+    int err;
+    const outline_cache_entry* e = outline_cache_get(face, glyph_index, &err);
+    if (err) return err;
+    if (!e || !e->is_outline || !e->scales_exactly) return 0;
+#ifdef FT_OUTLINE_OVERLAP
+    // The smooth renderer oversamples these; FT_Outline_Render does not.
+    if (e->outline.flags & FT_OUTLINE_OVERLAP) return 0;
+#endif
+
+    const FT_Outline* src = &e->outline;
+    FT_Fixed xs = face->size->metrics.x_scale;
+    FT_Fixed ys = face->size->metrics.y_scale;
+    int n = src->n_points;
+
+    FT_BBox cbox = {0, 0, 0, 0};
+    for (int i = 0; i < n; i++) {
+        FT_Pos x = FT_MulFix(src->points[i].x, xs);
+        FT_Pos y = FT_MulFix(src->points[i].y, ys);
+        if (i == 0 || x < cbox.xMin) cbox.xMin = x;
+        if (i == 0 || x > cbox.xMax) cbox.xMax = x;
+        if (i == 0 || y < cbox.yMin) cbox.yMin = y;
+        if (i == 0 || y > cbox.yMax) cbox.yMax = y;
+    }
+    memset(m, 0, sizeof(FT_Glyph_Metrics));
+    m->width        = cbox.xMax - cbox.xMin;
+    m->height       = cbox.yMax - cbox.yMin;
+    m->horiBearingX = cbox.xMin;
+    m->horiBearingY = cbox.yMax;
+    m->horiAdvance  = FT_MulFix(e->metrics.horiAdvance, xs);
+
+    int x_min = (int)(cbox.xMin >> 6), x_max = (int)((cbox.xMax + 63) >> 6);
+    int y_min = (int)(cbox.yMin >> 6), y_max = (int)((cbox.yMax + 63) >> 6);
+    int bw = x_max - x_min, bh = y_max - y_min;
+    memset(bmp, 0, sizeof(FT_Bitmap));
+    *left = x_min;
+    *top = y_max;
+    if (n == 0 || bw <= 0 || bh <= 0) {
+        *left = *top = 0;
+        return 1;
+    }
+
+    size_t points_bytes = (size_t)n * sizeof(FT_Vector);
+    char* buf = sdf_workspace_reserve(&t_sdf_coverage_workspace, points_bytes + (size_t)bw * bh);
+    if (!buf) return -1;
+    FT_Vector* points = (FT_Vector*)buf;
+    FT_Pos dx = (FT_Pos)x_min * 64, dy = (FT_Pos)y_min * 64;
+    for (int i = 0; i < n; i++) {
+        points[i].x = FT_MulFix(src->points[i].x, xs) - dx;
+        points[i].y = FT_MulFix(src->points[i].y, ys) - dy;
+    }
+    FT_Outline scaled = *src;
+    scaled.points = points;
+
+    bmp->rows       = (unsigned)bh;
+    bmp->width      = (unsigned)bw;
+    bmp->pitch      = bw;
+    bmp->buffer     = (unsigned char*)(buf + points_bytes);
+    bmp->num_grays  = 256;
+    bmp->pixel_mode = FT_PIXEL_MODE_GRAY;
+    memset(bmp->buffer, 0, (size_t)bw * bh);
+    FT_Error ft_err = FT_Outline_Get_Bitmap(face->glyph->library, &scaled, bmp);
+    return ft_err ? (int)ft_err : 1;
+}
+
+// Steps 1–5: load + rasterize the glyph, then seed and transform the padded
+// outside/inside fields inside ws. Fills the metrics and bmp_width/bmp_height/
+// bitmap_left/bitmap_top of out_result. *out_outside/*out_inside stay NULL for zero-size
+// glyphs (space, control chars). Squared distances are exact below cutoff
+// (sdf_band_cutoff for clamped encodings, EDT_INF for raw distances).
+// allow_fixed lets ut_ft_set_sdf_integer_edt take over: only for output no
+// finer than R8 (see Fixed-point EDT).
+static int sdf_render_fields(FT_Face face, unsigned int glyph_index, int load_flags, int spread,
+                             float cutoff, bool allow_fixed, ut_sdf_workspace* ws,
+                             ut_sdf_glyph_result* out_result,
+                             float** out_outside, float** out_inside) {
+    *out_outside = nullptr;
+    *out_inside  = nullptr;
+
+    // Steps 1+3 from the outline cache when the face has one and the load allows it
+    FT_Glyph_Metrics cached_metrics;
+    FT_Bitmap cached_bitmap;
+    int cached_left = 0, cached_top = 0;
+    int cached = sdf_cached_coverage(face, glyph_index, load_flags, &cached_metrics, &cached_bitmap,
+                                     &cached_left, &cached_top);
+    if (cached < 0 || cached > 1) return cached;
+
+    // Step 1: Load glyph outline
+    if (!cached) {
+        FT_Error err = FT_Load_Glyph(face, glyph_index, load_flags);
+        if (err) return (int)err;
+    }
+
+    // Step 2: Read outline metrics (before render, unaffected by spread)
+    const FT_Glyph_Metrics* m = cached ? &cached_metrics : &face->glyph->metrics;
+    out_result->metric_width     = (int)(m->width >> 6);
+    out_result->metric_height    = (int)(m->height >> 6);
+    out_result->metric_bearing_x = (int)(m->horiBearingX >> 6);
+    out_result->metric_bearing_y = (int)(m->horiBearingY >> 6);
+    out_result->metric_advance_x = (int)m->horiAdvance; // raw 26.6
+
+    // Step 3: Render as normal anti-aliased grayscale (fast — ~0.1ms)
+    if (!cached) {
+        FT_Error err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+        if (err) return (int)err;
+    }
+
+    const FT_Bitmap* b = cached ? &cached_bitmap : &face->glyph->bitmap;
+    int bitmap_left = cached ? cached_left : face->glyph->bitmap_left;
+    int bitmap_top  = cached ? cached_top : face->glyph->bitmap_top;
+    int bw = (int)b->width;
+    int bh = (int)b->rows;
+
+    // Zero-size glyph (space, control chars)
+    if (bw <= 0 || bh <= 0) {
+        out_result->bitmap_left = bitmap_left;
+        out_result->bitmap_top  = bitmap_top;
+        return 0;
+    }
+
+    // Step 4: Reserve workspace — grids + EDT scratch in one block
+    int pw = bw + 2 * spread;
+    int ph = bh + 2 * spread;
+    int pcount = pw * ph;
+    int maxdim = pw > ph ? pw : ph;
+
+    int slots = sdf_edt_slot_count(pw, ph);
+
+    size_t strip_floats = edt_strip_scratch(ph) * slots;
+    size_t ws_size = (size_t)pcount * sizeof(float) * 2          // outside + inside
+                   + strip_floats * sizeof(float)                // column strip per slot
+                   + sdf_edt_line_bytes(maxdim) * slots;         // edt_d/z/v per slot
+    char* buf = sdf_workspace_reserve(ws, ws_size);
+    if (!buf) return -1;
+
+    float* outside     = (float*)buf;
+    float* inside      = outside + pcount;
+    float* edt_scratch = inside + pcount;
+    char*  edt_lines   = (char*)(edt_scratch + strip_floats);
+
+    // Initialize padding (outside = far, inside = 0) and seed the glyph region
+    sdf_seed_fields(b, spread, pw, ph, outside, inside);
+
+    // Step 5: Compute 2D EDT for both fields in one pass (split across the pool for huge glyphs)
+    bool fixed = allow_fixed && g_sdf_integer_edt.load(std::memory_order_relaxed) && cutoff < EDT_INF
+              && maxdim <= EDT_FIX_MAX_DIM;
+    if (slots > 1) {
+        edt_2d_pair_parallel(outside, inside, pw, ph, edt_lines, edt_scratch, cutoff, fixed, slots);
+    } else if (fixed) {
+        edt_fix_2d_pair(outside, inside, pw, ph, edt_lines, edt_scratch, cutoff);
+    } else {
+        float* edt_d = (float*)edt_lines;
+        float* edt_z = edt_d + maxdim * 2;
+        int*   edt_v = (int*)(edt_z + (maxdim + 1) * 2);
+        edt_2d_pair(outside, inside, pw, ph, edt_d, edt_z, edt_v, edt_scratch, cutoff);
+    }
+
+    out_result->bmp_width   = pw;
+    out_result->bmp_height  = ph;
+    out_result->bitmap_left = bitmap_left - spread;
+    out_result->bitmap_top  = bitmap_top + spread;
+    *out_outside = outside;
+    *out_inside  = inside;
+    return 0;
+}
+
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
+                                           int load_flags, int spread,
+                                           ut_sdf_glyph_result* out_result) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face) { out_result->success = -1; return -1; }
+
+    float* outside;
+    float* inside;
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, sdf_band_cutoff(spread), true,
+                                &t_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    // Step 6: Combine into Alpha8 SDF with Y-flip (FreeType top-down → Unity bottom-up).
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    unsigned char* sdf = (unsigned char*)malloc((size_t)pw * ph);
+    if (!sdf) { out_result->success = -1; return -1; }
+
+    sdf_quantize_fields(outside, inside, pw, ph, spread, sdf, pw);
+
+    // Step 7: Fill result
+    out_result->bmp_pitch  = pw;
+    out_result->bmp_buffer = sdf;
+    out_result->success = 0;
+    return 0;
+}
+
+// ut_ft_render_sdf_glyph with a selectable texel format: GPU_UPLOAD_FMT_R8,
+// GPU_UPLOAD_FMT_R16 or GPU_UPLOAD_FMT_RHALF (see sdf_encode_fields). Returns -1
+// for any other format. bmp_pitch is in bytes (bmp_width × 1 or 2); the buffer is
+// freed with ut_ft_free_sdf_buffer like the Alpha8 one.
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph_format(FT_Face face, unsigned int glyph_index,
+                                                  int load_flags, int spread, int format,
+                                                  ut_sdf_glyph_result* out_result) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    int bpp = sdf_format_bpp(format);
+    if (!face || !bpp) { out_result->success = -1; return -1; }
+
+    float* outside;
+    float* inside;
+    float cutoff = format == GPU_UPLOAD_FMT_RHALF ? EDT_INF : sdf_band_cutoff(spread);
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, cutoff,
+                                format == GPU_UPLOAD_FMT_R8, &t_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    unsigned char* sdf = (unsigned char*)malloc((size_t)pw * ph * bpp);
+    if (!sdf) { out_result->success = -1; return -1; }
+
+    sdf_encode_fields(outside, inside, pw, ph, spread, format, sdf, pw * bpp);
+
+    out_result->bmp_pitch  = pw * bpp;
+    out_result->bmp_buffer = sdf;
+    out_result->success = 0;
+    return 0;
+}
+
+// Same as ut_ft_render_sdf_glyph, but allocation-free: fields live in ws (NULL =
+// calling thread's workspace) and the SDF is written tightly packed into the
+// caller-owned dst. bmp_buffer == dst on success — do NOT pass it to
+// ut_ft_free_sdf_buffer. If dst_capacity < bmp_width * bmp_height, returns -2
+// with bmp_width/bmp_height filled so the caller can grow dst and retry.
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph_into(FT_Face face, unsigned int glyph_index,
+                                                int load_flags, int spread, ut_sdf_workspace* ws,
+                                                unsigned char* dst, int dst_capacity,
+                                                ut_sdf_glyph_result* out_result) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face) { out_result->success = -1; return -1; }
+
+    float* outside;
+    float* inside;
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, sdf_band_cutoff(spread), true,
+                                ws ? ws : &t_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    if (!dst || dst_capacity < 0 || (size_t)dst_capacity < (size_t)pw * ph) {
+        out_result->success = -2;
+        return -2;
+    }
+
+    sdf_quantize_fields(outside, inside, pw, ph, spread, dst, pw);
+
+    out_result->bmp_pitch  = pw;
+    out_result->bmp_buffer = dst;
+    out_result->success = 0;
+    return 0;
+}
+
+// Renders straight into an atlas page region: the quantized, Y-flipped SDF is
+// written at (dst_x, dst_y) of an Alpha8 page dst_width × dst_height whose rows
+// are dst_row_pitch bytes apart (row 0 = bottom, Unity texture order). On
+// success bmp_buffer points at the region's first pixel and bmp_pitch ==
+// dst_row_pitch, so the result can go straight to a GPU upload as
+// pixelData/srcRowPitch without repacking. Returns -2 like _into when the
+// padded glyph does not fit inside the page at that offset: before rendering
+// if the offset lies outside the page, otherwise with bmp_width/bmp_height
+// filled. Negative offsets are bad args (-1).
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph_to_region(FT_Face face, unsigned int glyph_index,
+                                                     int load_flags, int spread, ut_sdf_workspace* ws,
+                                                     unsigned char* dst, int dst_width, int dst_height,
+                                                     int dst_row_pitch, int dst_x, int dst_y,
+                                                     ut_sdf_glyph_result* out_result) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face || !dst || dst_width <= 0 || dst_height <= 0 || dst_row_pitch < dst_width
+        || dst_x < 0 || dst_y < 0) {
+        out_result->success = -1;
+        return -1;
+    }
+    // Nothing fits at an origin outside the page; reject before rendering.
+    if (dst_x >= dst_width || dst_y >= dst_height) {
+        out_result->success = -2;
+        return -2;
+    }
+
+    float* outside;
+    float* inside;
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, sdf_band_cutoff(spread), true,
+                                ws ? ws : &t_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    if (pw > dst_width - dst_x || ph > dst_height - dst_y) {
+        out_result->success = -2;
+        return -2;
+    }
+
+    unsigned char* region = dst + (size_t)dst_y * dst_row_pitch + dst_x;
+    sdf_quantize_fields(outside, inside, pw, ph, spread, region, dst_row_pitch);
+
+    out_result->bmp_pitch  = dst_row_pitch;
+    out_result->bmp_buffer = region;
+    out_result->success = 0;
+    return 0;
+}
+
+UNITEXT_EXPORT void ut_ft_free_sdf_buffer(void* buffer) {
+    free(buffer);
+}
+
+// === Batch SDF Glyph Render ==================================================
+//
+// Renders many glyphs of one face across the worker pool. FT_Face is not
+// thread-safe, so every helper slot renders through its own clone of the face
+// (own FT_Library + FT_New_Memory_Face over the same font bytes); the calling
+// thread renders with `face` itself. Everything the clones need from `face` is
+// read up front on the calling thread, so helpers never touch it while slot 0
+// renders: the size (FT_Set_Char_Size from the 26.6 em size behind its
+// scales), variation coordinates, FT_Set_Transform, and the library-wide
+// driver properties in sdf_clone_props. A clone whose size metrics still come
+// out different (bitmap strikes) is not used; its glyphs are rendered on the
+// calling thread after the pool finishes. Per-face FT_Face_Properties cannot
+// be read back and are not carried over, so set those library-wide instead.
+//
+// Between batches clones wait in a process-wide idle list and are reused by
+// later batches of the same face; ut_ft_done_face bumps a generation counter
+// that invalidates them. Each batch frees clones left idle for more than
+// SDF_CLONE_IDLE_MS, and ut_ft_release_sdf_clones frees them all.
+//
+// Each out_results[i] follows ut_ft_render_sdf_glyph semantics (bmp_buffer is
+// malloc'd, caller frees via ut_ft_free_sdf_buffer).
+// Returns 0 if every glyph succeeded, otherwise the first non-zero error.
+
+#include <limits.h>
+
+#define SDF_CLONE_MAX_AXES  64
+#define SDF_CLONE_MAX_SLOTS 64
+#define SDF_CLONE_IDLE_MS   5000
+#define SDF_BATCH_RETRY     INT_MIN  // result marker: render on the calling thread
+
+// Library properties a clone's library copies from the source one. Values are
+// read and written through the same zeroed FT_Int[8], which holds every type
+// involved (FT_UInt, FT_Bool, FT_Int[8] darkening parameters).
+static const struct { const char* module; const char* name; } sdf_clone_props[] = {
+    { "truetype",   "interpreter-version" },
+    { "cff",        "hinting-engine" },
+    { "type1",      "hinting-engine" },
+    { "t1cid",      "hinting-engine" },
+    { "cff",        "no-stem-darkening" },
+    { "type1",      "no-stem-darkening" },
+    { "t1cid",      "no-stem-darkening" },
+    { "autofitter", "no-stem-darkening" },
+    { "cff",        "darkening-parameters" },
+    { "type1",      "darkening-parameters" },
+    { "t1cid",      "darkening-parameters" },
+    { "autofitter", "darkening-parameters" },
+    { "autofitter", "default-script" },
+    { "autofitter", "fallback-script" },
+    { "sdf",        "spread" },
+    { "bsdf",       "spread" },
+};
+
+#define SDF_CLONE_NUM_PROPS (int)(sizeof(sdf_clone_props) / sizeof(sdf_clone_props[0]))
+
+struct sdf_clone_settings {
+    FT_Long face_index;
+    FT_F26Dot6 char_width;
+    FT_F26Dot6 char_height;
+    FT_Size_Metrics metrics;         // what the clone's size must reproduce
+    FT_Matrix matrix;
+    FT_Vector delta;
+    FT_UInt num_coords;
+    FT_Fixed coords[SDF_CLONE_MAX_AXES];
+    unsigned props_present;          // bit i: sdf_clone_props[i] read from the source library
+    FT_Int props[SDF_CLONE_NUM_PROPS][8];
+};
+
+struct sdf_face_clone {
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    FT_Face source = nullptr;
+    unsigned generation = 0;
+    bool size_ok = false;
+    sdf_clone_settings applied;      // valid while face != nullptr
+    std::chrono::steady_clock::time_point last_used;
+    sdf_face_clone* next = nullptr;  // idle list
+
+    ~sdf_face_clone() { release(); }
+
+    void release() {
+        if (face) FT_Done_Face(face);
+        if (library) FT_Done_FreeType(library);
+        face = nullptr;
+        library = nullptr;
+        source = nullptr;
+    }
+};
+
+struct sdf_batch_ctx {
+    FT_Face face;
+    const unsigned int* glyph_indices;
+    int load_flags;
+    int spread;
+    ut_sdf_glyph_result* results;
+    // Snapshot of `face` for the clones, taken before the pool starts.
+    const FT_Byte* font_data;
+    FT_Long font_size;
+    unsigned generation;
+    sdf_clone_settings settings;
+    sdf_face_clone* clones[SDF_CLONE_MAX_SLOTS];     // per slot, taken on its first glyph
+};
+
+static std::mutex g_sdf_clone_mutex;
+static sdf_face_clone* g_sdf_clone_idle = nullptr;  // most recently used first
+
+// 26.6 em size whose FT_Set_Char_Size request gives `scale` again.
+static FT_F26Dot6 sdf_clone_em_size(FT_UShort units_per_em, FT_Fixed scale) {
+    FT_F26Dot6 size = FT_MulFix((FT_Long)units_per_em, scale);
+    for (FT_F26Dot6 d = 0; d <= 2; d++) {
+        if (FT_DivFix(size + d, units_per_em) == scale) return size + d;
+        if (size - d > 0 && FT_DivFix(size - d, units_per_em) == scale) return size - d;
+    }
+    return size;
+}
+
+static void sdf_clone_snapshot(FT_Face face, sdf_clone_settings* s) {
+    memset(s, 0, sizeof(sdf_clone_settings));
+    s->face_index = face->face_index;
+    s->metrics = face->size->metrics;
+    if (FT_IS_SCALABLE(face) && face->units_per_EM) {
+        s->char_width = sdf_clone_em_size(face->units_per_EM, face->size->metrics.x_scale);
+        s->char_height = sdf_clone_em_size(face->units_per_EM, face->size->metrics.y_scale);
+    } else {
+        s->char_width = (FT_F26Dot6)face->size->metrics.x_ppem << 6;
+        s->char_height = (FT_F26Dot6)face->size->metrics.y_ppem << 6;
+    }
+    FT_Get_Transform(face, &s->matrix, &s->delta);
+    if (FT_HAS_MULTIPLE_MASTERS(face)) {
+        // May lazily load blend state, so only ever on the calling thread.
+        FT_MM_Var* mm = nullptr;
+        if (FT_Get_MM_Var(face, &mm) == 0) {
+            FT_UInt n = mm->num_axis < SDF_CLONE_MAX_AXES ? mm->num_axis : SDF_CLONE_MAX_AXES;
+            if (FT_Get_Var_Blend_Coordinates(face, n, s->coords) == 0) s->num_coords = n;
+            FT_Done_MM_Var(face->glyph->library, mm);
+        }
+    }
+    for (int i = 0; i < SDF_CLONE_NUM_PROPS; i++) {
+        if (FT_Property_Get(face->glyph->library, sdf_clone_props[i].module, sdf_clone_props[i].name,
+                            s->props[i]) == 0)
+            s->props_present |= 1u << i;
+    }
+}
+
+// Takes an idle clone of the batch's face (or a new one) and brings it to the
+// batch's settings. Returns nullptr when the
+// clone cannot match; the slot's glyphs then go back to the calling thread.
+static sdf_face_clone* sdf_clone_acquire(const sdf_batch_ctx* b) {
+    sdf_face_clone* c = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_sdf_clone_mutex);
+        for (sdf_face_clone** l = &g_sdf_clone_idle; *l; l = &(*l)->next) {
+            if ((*l)->source != b->face || (*l)->generation != b->generation) continue;
+            c = *l;
+            *l = c->next;
+            c->next = nullptr;
+            break;
+        }
+    }
+    if (!c) c = new sdf_face_clone();
+
+    const sdf_clone_settings* s = &b->settings;
+    if (c->face && (c->applied.props_present != s->props_present ||
+                    memcmp(c->applied.props, s->props, sizeof(s->props)) != 0))
+        c->release();
+
+    if (!c->face) {
+        // Properties go on the library before the face exists: some drivers
+        // read them when the face is created.
+        if (FT_Init_FreeType(&c->library)) { c->library = nullptr; return c; }
+        for (int i = 0; i < SDF_CLONE_NUM_PROPS; i++) {
+            if (s->props_present & (1u << i))
+                FT_Property_Set(c->library, sdf_clone_props[i].module, sdf_clone_props[i].name, s->props[i]);
+        }
+        if (FT_New_Memory_Face(c->library, b->font_data, b->font_size, s->face_index, &c->face)) {
+            c->face = nullptr;
+            c->release();
+            return c;
+        }
+        c->source = b->face;
+        c->generation = b->generation;
+        memset(&c->applied, 0, sizeof(sdf_clone_settings));
+        c->applied.matrix.xx = c->applied.matrix.yy = 0x10000;
+        c->applied.props_present = s->props_present;
+        memcpy(c->applied.props, s->props, sizeof(s->props));
+    }
+
+    if (c->applied.num_coords != s->num_coords
+        || memcmp(c->applied.coords, s->coords, s->num_coords * sizeof(FT_Fixed)) != 0) {
+        if (FT_Set_Var_Blend_Coordinates(c->face, s->num_coords, (FT_Fixed*)s->coords)) {
+            c->release();
+            return c;
+        }
+        c->applied.num_coords = s->num_coords;
+        memcpy(c->applied.coords, s->coords, s->num_coords * sizeof(FT_Fixed));
+        c->applied.char_width = 0;   // variations can change the size metrics
+    }
+
+    if (c->applied.char_width != s->char_width || c->applied.char_height != s->char_height) {
+        c->size_ok = FT_Set_Char_Size(c->face, s->char_width, s->char_height, 72, 72) == 0
+                  && memcmp(&c->face->size->metrics, &s->metrics, sizeof(FT_Size_Metrics)) == 0;
+        c->applied.char_width = s->char_width;
+        c->applied.char_height = s->char_height;
+    }
+
+    FT_Set_Transform(c->face, (FT_Matrix*)&s->matrix, (FT_Vector*)&s->delta);
+    return c;
+}
+
+// Returns the batch's clones to the idle list, then frees clones idle for
+// longer than SDF_CLONE_IDLE_MS or belonging to a destroyed face.
+static void sdf_clone_return(sdf_batch_ctx* b) {
+    auto now = std::chrono::steady_clock::now();
+    sdf_face_clone* expired = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_sdf_clone_mutex);
+        for (int slot = 0; slot < SDF_CLONE_MAX_SLOTS; slot++) {
+            sdf_face_clone* c = b->clones[slot];
+            if (!c) continue;
+            c->last_used = now;
+            c->next = g_sdf_clone_idle;
+            g_sdf_clone_idle = c;
+        }
+        unsigned gen = g_face_generation.load(std::memory_order_acquire);
+        for (sdf_face_clone** l = &g_sdf_clone_idle; *l;) {
+            sdf_face_clone* c = *l;
+            if (c->generation == gen && c->face &&
+                now - c->last_used <= std::chrono::milliseconds(SDF_CLONE_IDLE_MS)) {
+                l = &c->next;
+                continue;
+            }
+            *l = c->next;
+            c->next = expired;
+            expired = c;
+        }
+    }
+    while (expired) {
+        sdf_face_clone* next = expired->next;
+        delete expired;
+        expired = next;
+    }
+}
+
+static void sdf_batch_glyph(void* ctx, int index, int slot) {
+    sdf_batch_ctx* b = (sdf_batch_ctx*)ctx;
+    ut_sdf_glyph_result* r = &b->results[index];
+    FT_Face face = b->face;
+    if (slot > 0) {
+        if (!b->clones[slot]) b->clones[slot] = sdf_clone_acquire(b);
+        sdf_face_clone* c = b->clones[slot];
+        if (!c || !c->face || !c->size_ok) {
+            memset(r, 0, sizeof(ut_sdf_glyph_result));
+            r->success = SDF_BATCH_RETRY;
+            return;
+        }
+        face = c->face;
+    }
+    ut_ft_render_sdf_glyph(face, b->glyph_indices[index], b->load_flags, b->spread, r);
+}
+
+UNITEXT_EXPORT int ut_ft_render_sdf_glyphs_batch(FT_Face face, const unsigned int* glyph_indices, int count,
+                                                  int pixel_size, int load_flags, int spread,
+                                                  int max_threads, ut_sdf_glyph_result* out_results) {
+    if (!face || !glyph_indices || !out_results || count < 0) return -1;
+    if (count == 0) return 0;
+
+    if (pixel_size > 0) {
+        FT_Error err = FT_Set_Pixel_Sizes(face, 0, (FT_UInt)pixel_size);
+        if (err) return (int)err;
+    } else if (!face->size) {
+        return -1;
+    }
+
+    // Below ~8 glyphs per thread, wake-up latency outweighs the work.
+    int slots = (count + 7) / 8;
+    if (max_threads > 0 && slots > max_threads) slots = max_threads;
+    if (slots > SDF_CLONE_MAX_SLOTS) slots = SDF_CLONE_MAX_SLOTS;
+    if (!face->stream || !face->stream->base) slots = 1;
+
+    sdf_batch_ctx ctx;
+    ctx.face = face;
+    ctx.glyph_indices = glyph_indices;
+    ctx.load_flags = load_flags;
+    ctx.spread = spread;
+    ctx.results = out_results;
+    ctx.font_data = slots > 1 ? face->stream->base : nullptr;
+    ctx.font_size = slots > 1 ? (FT_Long)face->stream->size : 0;
+    ctx.generation = g_face_generation.load(std::memory_order_acquire);
+    memset(ctx.clones, 0, sizeof(ctx.clones));
+    if (slots > 1) sdf_clone_snapshot(face, &ctx.settings);
+    pool_parallel_for(count, slots, sdf_batch_glyph, &ctx);
+    sdf_clone_return(&ctx);
+
+    for (int i = 0; i < count; i++) {
+        if (out_results[i].success == SDF_BATCH_RETRY)
+            ut_ft_render_sdf_glyph(face, glyph_indices[i], load_flags, spread, &out_results[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (out_results[i].success != 0) return out_results[i].success;
+    }
+    return 0;
+}
+
+// Frees every idle face clone kept by ut_ft_render_sdf_glyphs_batch. Clones in
+// use by a running batch are unaffected.
+UNITEXT_EXPORT void ut_ft_release_sdf_clones() {
+    sdf_face_clone* idle;
+    {
+        std::lock_guard<std::mutex> lock(g_sdf_clone_mutex);
+        idle = g_sdf_clone_idle;
+        g_sdf_clone_idle = nullptr;
+    }
+    while (idle) {
+        sdf_face_clone* next = idle->next;
+        delete idle;
+        idle = next;
+    }
+}
+
+// 64-bit hash, 8 bytes per step. Not cryptographic — content identity and
+// torn-write detection only (shape plans, SDF cache).
+static uint64_t ut_hash64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = seed ^ (size * 0x9E3779B97F4A7C15ull);
+    while (size >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        w *= 0xBF58476D1CE4E5B9ull;
+        w ^= w >> 31;
+        h = (h ^ w) * 0x94D049BB133111EBull;
+        p += 8;
+        size -= 8;
+    }
+    if (size) {
+        uint64_t w = 0;
+        memcpy(&w, p, size);
+        w *= 0xBF58476D1CE4E5B9ull;
+        w ^= w >> 31;
+        h = (h ^ w) * 0x94D049BB133111EBull;
+    }
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// =============================================================================
+// Unified HarfBuzz API (ut_hb_*)
+// =============================================================================
+
+UNITEXT_EXPORT hb_blob_t* ut_hb_blob_create(const char* data, unsigned int length, hb_memory_mode_t mode, void* user_data, hb_destroy_func_t destroy) {
+    return hb_blob_create(data, length, mode, user_data, destroy);
+}
+
+UNITEXT_EXPORT void ut_hb_blob_destroy(hb_blob_t* blob) {
+    hb_blob_destroy(blob);
+}
+
+UNITEXT_EXPORT hb_face_t* ut_hb_face_create(hb_blob_t* blob, unsigned int index) {
+    return hb_face_create(blob, index);
+}
+
+UNITEXT_EXPORT void ut_hb_face_destroy(hb_face_t* face) {
+    hb_face_destroy(face);
+}
+
+UNITEXT_EXPORT unsigned int ut_hb_face_get_upem(const hb_face_t* face) {
+    return hb_face_get_upem(face);
+}
+
+UNITEXT_EXPORT hb_font_t* ut_hb_font_create(hb_face_t* face) {
+    return hb_font_create(face);
+}
+
+UNITEXT_EXPORT void ut_hb_font_destroy(hb_font_t* font) {
+    hb_font_destroy(font);
+}
+
+UNITEXT_EXPORT void ut_hb_ot_font_set_funcs(hb_font_t* font) {
+    hb_ot_font_set_funcs(font);
+}
+
+UNITEXT_EXPORT int ut_hb_font_get_glyph_h_advance(hb_font_t* font, unsigned int glyph) {
+    return hb_font_get_glyph_h_advance(font, glyph);
+}
+
+UNITEXT_EXPORT int ut_hb_font_get_glyph(hb_font_t* font, unsigned int unicode, unsigned int variation_selector, unsigned int* glyph) {
+    return hb_font_get_glyph(font, unicode, variation_selector, glyph);
+}
+
+UNITEXT_EXPORT hb_face_t* ut_hb_font_get_face(hb_font_t* font) {
+    return hb_font_get_face(font);
+}
+
+UNITEXT_EXPORT hb_buffer_t* ut_hb_buffer_create() {
+    return hb_buffer_create();
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_destroy(hb_buffer_t* buffer) {
+    hb_buffer_destroy(buffer);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_clear_contents(hb_buffer_t* buffer) {
+    hb_buffer_clear_contents(buffer);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_set_direction(hb_buffer_t* buffer, hb_direction_t direction) {
+    hb_buffer_set_direction(buffer, direction);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_set_script(hb_buffer_t* buffer, hb_script_t script) {
+    hb_buffer_set_script(buffer, script);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_set_content_type(hb_buffer_t* buffer, hb_buffer_content_type_t content_type) {
+    hb_buffer_set_content_type(buffer, content_type);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_set_flags(hb_buffer_t* buffer, hb_buffer_flags_t flags) {
+    hb_buffer_set_flags(buffer, flags);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_add_codepoints(hb_buffer_t* buffer, const unsigned int* text, int text_length, unsigned int item_offset, int item_length) {
+    hb_buffer_add_codepoints(buffer, text, text_length, item_offset, item_length);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_add_utf16(hb_buffer_t* buffer, const uint16_t* text, int text_length, unsigned int item_offset, int item_length) {
+    hb_buffer_add_utf16(buffer, text, text_length, item_offset, item_length);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_add_utf8(hb_buffer_t* buffer, const char* text, int text_length, unsigned int item_offset, int item_length) {
+    hb_buffer_add_utf8(buffer, text, text_length, item_offset, item_length);
+}
+
+UNITEXT_EXPORT unsigned int ut_hb_buffer_get_length(const hb_buffer_t* buffer) {
+    return hb_buffer_get_length(buffer);
+}
+
+UNITEXT_EXPORT hb_glyph_info_t* ut_hb_buffer_get_glyph_infos(hb_buffer_t* buffer, unsigned int* length) {
+    return hb_buffer_get_glyph_infos(buffer, length);
+}
+
+UNITEXT_EXPORT hb_glyph_position_t* ut_hb_buffer_get_glyph_positions(hb_buffer_t* buffer, unsigned int* length) {
+    return hb_buffer_get_glyph_positions(buffer, length);
+}
+
+// --- Shape plan cache ---
+//
+// hb_shape looks its plan up in the face's plan list (a linear scan comparing
+// feature arrays) on every call. ut_hb_shape_run / _lang keep their own
+// compiled plans per hb_face_t instead — attached as face user data, so they
+// go away with the face — keyed by segment properties (direction, script,
+// language), the feature array and the font's normalized variation coords,
+// and run them through hb_shape_plan_execute. Plans are immutable: the
+// lookup holds the face's lock only to take a reference, execution runs
+// outside it. Least recently used plans are dropped past
+// SHAPE_PLAN_CACHE_SLOTS per face.
+//
+// Off by default: hb_shape already caches plans per face
+// (hb_shape_plan_create_cached2), so this layer only saves that lookup.
+// ShapePlanCacheBenchmark times short runs with it off (plain hb_shape) and
+// on; turn it on where that shows a gain.
+
+#define SHAPE_PLAN_CACHE_SLOTS 32
+
+struct shape_plan_entry {
+    uint64_t hash;
+    uint64_t last_use;
+    hb_segment_properties_t props;
+    hb_feature_t* features;
+    unsigned int num_features;
+    int* coords;
+    unsigned int num_coords;
+    hb_shape_plan_t* plan;
+};
+
+struct shape_plan_cache {
+    std::mutex mutex;
+    shape_plan_entry entries[SHAPE_PLAN_CACHE_SLOTS] = {};
+    int count = 0;
+    uint64_t clock = 0;
+};
+
+static hb_user_data_key_t g_shape_plan_cache_key;
+static std::atomic<int> g_shape_plan_cache_enabled{0};
+static std::atomic<unsigned> g_shape_plan_hits{0};
+static std::atomic<unsigned> g_shape_plan_misses{0};
+
+static void shape_plan_entry_free(shape_plan_entry* e) {
+    hb_shape_plan_destroy(e->plan);
+    free(e->features);
+    free(e->coords);
+    memset(e, 0, sizeof(*e));
+}
+
+static void shape_plan_cache_destroy(void* data) {
+    shape_plan_cache* c = (shape_plan_cache*)data;
+    for (int i = 0; i < c->count; i++) shape_plan_entry_free(&c->entries[i]);
+    delete c;
+}
+
+// The face's plan cache, created on first use; NULL for inert faces.
+static shape_plan_cache* shape_plan_cache_of(hb_face_t* face) {
+    shape_plan_cache* c = (shape_plan_cache*)hb_face_get_user_data(face, &g_shape_plan_cache_key);
+    if (c) return c;
+    c = new shape_plan_cache();
+    if (!hb_face_set_user_data(face, &g_shape_plan_cache_key, c, shape_plan_cache_destroy, false)) {
+        delete c;   // another thread attached one first (or the face is inert)
+        return (shape_plan_cache*)hb_face_get_user_data(face, &g_shape_plan_cache_key);
+    }
+    return c;
+}
+
+static bool shape_plan_entry_matches(const shape_plan_entry* e, uint64_t hash, const hb_segment_properties_t* props,
+                                     const hb_feature_t* features, unsigned int num_features,
+                                     const int* coords, unsigned int num_coords) {
+    return e->hash == hash
+        && e->props.direction == props->direction && e->props.script == props->script
+        && e->props.language == props->language
+        && e->num_features == num_features && e->num_coords == num_coords
+        && (!num_features || memcmp(e->features, features, num_features * sizeof(hb_feature_t)) == 0)
+        && (!num_coords || memcmp(e->coords, coords, num_coords * sizeof(int)) == 0);
+}
+
+// hb_shape through the face's plan cache (plain hb_shape when disabled).
+static void shape_with_plan_cache(hb_font_t* font, hb_buffer_t* buffer,
+                                  const hb_feature_t* features, unsigned int num_features) {
+    shape_plan_cache* c = nullptr;
+    hb_face_t* face = hb_font_get_face(font);
+    if (g_shape_plan_cache_enabled.load(std::memory_order_relaxed) && hb_buffer_get_length(buffer) > 0)
+        c = shape_plan_cache_of(face);
+    if (!c) {
+        hb_shape(font, buffer, features, num_features);
+        return;
+    }
+    if (!features) num_features = 0;
+
+    hb_segment_properties_t props;
+    hb_buffer_get_segment_properties(buffer, &props);
+    unsigned int num_coords = 0;
+    const int* coords = hb_font_get_var_coords_normalized(font, &num_coords);
+    if (!coords) num_coords = 0;
+
+    uint64_t key[3] = { (uint64_t)props.direction, (uint64_t)props.script, (uint64_t)(uintptr_t)props.language };
+    uint64_t hash = ut_hash64(key, sizeof(key), 0);
+    hash = ut_hash64(features, num_features * sizeof(hb_feature_t), hash);
+    hash = ut_hash64(coords, num_coords * sizeof(int), hash);
+
+    hb_shape_plan_t* plan = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(c->mutex);
+        for (int i = 0; i < c->count; i++) {
+            shape_plan_entry* e = &c->entries[i];
+            if (!shape_plan_entry_matches(e, hash, &props, features, num_features, coords, num_coords)) continue;
+            e->last_use = ++c->clock;
+            plan = hb_shape_plan_reference(e->plan);
+            break;
+        }
+    }
+
+    if (plan) {
+        g_shape_plan_hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        g_shape_plan_misses.fetch_add(1, std::memory_order_relaxed);
+        plan = hb_shape_plan_create2(face, &props, features, num_features, coords, num_coords, nullptr);
+
+        shape_plan_entry e = {};
+        e.hash = hash;
+        e.props = props;
+        e.num_features = num_features;
+        e.num_coords = num_coords;
+        e.features = num_features ? (hb_feature_t*)malloc(num_features * sizeof(hb_feature_t)) : nullptr;
+        e.coords = num_coords ? (int*)malloc(num_coords * sizeof(int)) : nullptr;
+        if ((!num_features || e.features) && (!num_coords || e.coords)) {
+            if (num_features) memcpy(e.features, features, num_features * sizeof(hb_feature_t));
+            if (num_coords) memcpy(e.coords, coords, num_coords * sizeof(int));
+            e.plan = hb_shape_plan_reference(plan);
+
+            std::lock_guard<std::mutex> lock(c->mutex);
+            bool present = false;
+            for (int i = 0; i < c->count && !present; i++)
+                present = shape_plan_entry_matches(&c->entries[i], hash, &props, features, num_features,
+                                                   coords, num_coords);
+            if (!present) {
+                int slot = c->count;
+                if (slot == SHAPE_PLAN_CACHE_SLOTS) {
+                    slot = 0;
+                    for (int i = 1; i < c->count; i++)
+                        if (c->entries[i].last_use < c->entries[slot].last_use) slot = i;
+                    shape_plan_entry_free(&c->entries[slot]);
+                } else {
+                    c->count++;
+                }
+                e.last_use = ++c->clock;
+                c->entries[slot] = e;
+                e.plan = nullptr;
+                e.features = nullptr;
+                e.coords = nullptr;
+            }
+        }
+        shape_plan_entry_free(&e);
+    }
+
+    hb_shape_plan_execute(plan, font, buffer, features, num_features);
+    hb_shape_plan_destroy(plan);
+}
+
+// Turns the plan cache on or off for every face (off by default = plain hb_shape).
+UNITEXT_EXPORT void ut_hb_shape_plan_cache_set_enabled(int enabled) {
+    g_shape_plan_cache_enabled.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+// Process-wide plan lookups served from / compiled into the cache since start.
+UNITEXT_EXPORT void ut_hb_shape_plan_cache_stats(unsigned int* out_hits, unsigned int* out_misses) {
+    if (out_hits)   *out_hits   = g_shape_plan_hits.load(std::memory_order_relaxed);
+    if (out_misses) *out_misses = g_shape_plan_misses.load(std::memory_order_relaxed);
+}
+
+UNITEXT_EXPORT void ut_hb_shape(hb_font_t* font, hb_buffer_t* buffer, const hb_feature_t* features, unsigned int num_features) {
+    hb_shape(font, buffer, features, num_features);
+}
+
+UNITEXT_EXPORT int ut_hb_shape_run(
+    hb_font_t* font, hb_buffer_t* buffer,
+    const unsigned int* codepoints, int text_length,
+    unsigned int item_offset, int item_length,
+    hb_direction_t direction, unsigned int script_tag, unsigned int flags,
+    const hb_feature_t* features, unsigned int num_features,
+    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, direction);
+    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
+    hb_buffer_add_codepoints(buffer, codepoints, text_length, item_offset, item_length);
+    shape_with_plan_cache(font, buffer, features, num_features);
+    unsigned int count = 0;
+    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
+    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
+    return (int)count;
+}
+
+UNITEXT_EXPORT hb_language_t ut_hb_language_from_string(const char* str, int len) {
+    if (!str) return HB_LANGUAGE_INVALID;
+    return hb_language_from_string(str, len);
+}
+
+UNITEXT_EXPORT void ut_hb_buffer_set_language(hb_buffer_t* buffer, hb_language_t language) {
+    hb_buffer_set_language(buffer, language);
+}
+
+UNITEXT_EXPORT int ut_hb_shape_run_lang(
+    hb_font_t* font, hb_buffer_t* buffer,
+    const unsigned int* codepoints, int text_length,
+    unsigned int item_offset, int item_length,
+    hb_direction_t direction, unsigned int script_tag, hb_language_t language, unsigned int flags,
+    const hb_feature_t* features, unsigned int num_features,
+    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, direction);
+    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
+    if (language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
+    hb_buffer_add_codepoints(buffer, codepoints, text_length, item_offset, item_length);
+    shape_with_plan_cache(font, buffer, features, num_features);
+    unsigned int count = 0;
+    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
+    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
+    return (int)count;
+}
+
+// ut_hb_shape_run_lang over UTF-16 text (e.g. a pinned C# string), without a
+// managed UTF-32 copy. item_offset/item_length and the returned clusters are
+// UTF-16 code units; unpaired surrogates shape as U+FFFD.
+UNITEXT_EXPORT int ut_hb_shape_run_utf16(
+    hb_font_t* font, hb_buffer_t* buffer,
+    const uint16_t* text, int text_length,
+    unsigned int item_offset, int item_length,
+    hb_direction_t direction, unsigned int script_tag, hb_language_t language, unsigned int flags,
+    const hb_feature_t* features, unsigned int num_features,
+    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, direction);
+    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
+    if (language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
+    hb_buffer_add_utf16(buffer, text, text_length, item_offset, item_length);
+    shape_with_plan_cache(font, buffer, features, num_features);
+    unsigned int count = 0;
+    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
+    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
+    return (int)count;
+}
+
+// ut_hb_shape_run_lang over UTF-8 text. item_offset/item_length and the
+// returned clusters are bytes; invalid sequences shape as U+FFFD.
+UNITEXT_EXPORT int ut_hb_shape_run_utf8(
+    hb_font_t* font, hb_buffer_t* buffer,
+    const char* text, int text_length,
+    unsigned int item_offset, int item_length,
+    hb_direction_t direction, unsigned int script_tag, hb_language_t language, unsigned int flags,
+    const hb_feature_t* features, unsigned int num_features,
+    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, direction);
+    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
+    if (language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
+    hb_buffer_add_utf8(buffer, text, text_length, item_offset, item_length);
+    shape_with_plan_cache(font, buffer, features, num_features);
+    unsigned int count = 0;
+    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
+    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
+    return (int)count;
+}
+
+// --- Batched runs ---
+//
+// A paragraph's script/font runs shaped in one call, glyphs packed into a
+// caller-owned array instead of handed out as pointers into hb_buffer_t
+// internals (which the next run would invalidate). Records follow run order,
+// and within a run HarfBuzz's output order (visual, so RTL runs come out
+// reversed).
+
+#include <limits.h>
+
+typedef struct {
+    hb_font_t* font;
+    unsigned int offset;            // item_offset into the batch's text, in code units
+    int length;                     // item_length; -1 = to the end of the text
+    hb_direction_t direction;
+    unsigned int script_tag;
+    hb_language_t language;         // HB_LANGUAGE_INVALID = buffer default
+    unsigned int flags;             // hb_buffer_flags_t
+    const hb_feature_t* features;
+    unsigned int num_features;
+} ut_hb_run;
+
+typedef struct {
+    unsigned int glyph_id;
+    unsigned int cluster;
+    int x_advance;
+    int y_advance;
+    int x_offset;
+    int y_offset;
+    int run_index;
+} ut_hb_glyph;
+
+// Batch text in one of HarfBuzz's input encodings. Offsets, lengths and
+// clusters are all in its code units.
+struct hb_text {
+    const void* data;
+    int length;
+    int unit;       // bytes per code unit: 4 = codepoints, 2 = UTF-16, 1 = UTF-8
+};
+
+static inline unsigned int hb_text_at(const hb_text* t, unsigned int i) {
+    if (t->unit == 4) return ((const unsigned int*)t->data)[i];
+    if (t->unit == 2) return ((const uint16_t*)t->data)[i];
+    return ((const unsigned char*)t->data)[i];
+}
+
+// Code units [offset, offset + length) as a text of their own.
+static inline hb_text hb_text_slice(const hb_text* t, unsigned int offset, unsigned int length) {
+    hb_text s = { (const char*)t->data + (size_t)offset * t->unit, (int)length, t->unit };
+    return s;
+}
+
+static bool hb_run_valid(const ut_hb_run* run, int text_length) {
+    if (!run->font || run->offset > (unsigned int)text_length) return false;
+    return run->length < 0 || (unsigned int)run->length <= (unsigned int)text_length - run->offset;
+}
+
+// Shapes one run into buffer; returns its glyph count.
+static unsigned int hb_shape_run_into(hb_buffer_t* buffer, const hb_text* text, const ut_hb_run* run) {
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, run->direction);
+    hb_buffer_set_script(buffer, (hb_script_t)run->script_tag);
+    if (run->language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, run->language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)run->flags);
+    if (text->unit == 2)
+        hb_buffer_add_utf16(buffer, (const uint16_t*)text->data, text->length, run->offset, run->length);
+    else if (text->unit == 1)
+        hb_buffer_add_utf8(buffer, (const char*)text->data, text->length, run->offset, run->length);
+    else
+        hb_buffer_add_codepoints(buffer, (const hb_codepoint_t*)text->data, text->length, run->offset, run->length);
+    shape_with_plan_cache(run->font, buffer, run->features, run->num_features);
+    return hb_buffer_get_length(buffer);
+}
+
+// --- Word cache ---
+//
+// Opt-in, process-wide LRU of shaped words for the ut_hb_shape_runs_batch
+// family (any input encoding; U+0020 is one code unit in each). A run
+// is cut after every space into segments (a word plus its trailing spaces);
+// each segment is shaped on its own once and kept as compact glyph records,
+// keyed by its codepoints, the font (identity + serial, so scale and variation
+// changes miss), normalized variation coords, segment properties, buffer flags,
+// the buffer's cluster level and replacement / invisible / not-found glyphs,
+// and features. Splicing standalone results is exact only where HarfBuzz says
+// so: every boundary between two segments needs the glyphs on both sides
+// clear of UNSAFE_TO_CONCAT (UNSAFE_TO_BREAK implies it), and the run itself
+// must start and end at a space or the text ends, since standalone shaping
+// sees no outer context. Everything else is shaped whole as before.
+// ut_hb_shape_run / _lang hand out hb_buffer_t internals, which a cache cannot
+// fill, so only the batch path reads it.
+//
+// ut_hb_shape_paragraphs hits the cache from every pool thread, and a hit
+// relinks the entry in LRU order, so one lock would serialise them. The cache
+// is split into WORD_CACHE_SHARDS independent shards by key hash, each with
+// its own lock, buckets, LRU list and an equal share of the byte cap; LRU
+// order is per shard.
+
+#include <vector>
+
+#define WORD_CACHE_SHARDS 16
+#define WORD_CACHE_BUCKETS 256      // per shard
+#define WORD_CACHE_MAX_LENGTH 64    // code units; longer segments (unspaced scripts) shape the run whole
+
+// Buffer settings besides flags that change hb_shape output.
+struct word_cache_settings {
+    uint32_t cluster_level;
+    uint32_t replacement;       // code point for invalid UTF-8/16
+    uint32_t invisible;         // glyph for default ignorables (0 = the space glyph)
+    uint32_t not_found;         // glyph for unmapped code points
+};
+
+struct word_cache_entry {
+    uint64_t hash;
+    uint64_t font_id;
+    unsigned int font_serial;
+    hb_segment_properties_t props;
+    unsigned int flags;
+    word_cache_settings settings;
+    unsigned int length;        // code units
+    int unit;                   // bytes per code unit
+    unsigned int num_features;
+    unsigned int num_coords;
+    unsigned int glyph_count;
+    bool start_safe;            // logical first glyph clear of UNSAFE_TO_CONCAT
+    bool end_safe;              // logical last glyph clear of UNSAFE_TO_CONCAT
+    size_t bytes;
+    word_cache_entry* hash_next;
+    word_cache_entry* lru_prev;    // toward most recent
+    word_cache_entry* lru_next;    // toward least recent
+    // Followed by features[num_features], coords[num_coords], glyphs[glyph_count]
+    // (clusters relative to the segment, visual order) and the segment's
+    // length * unit text bytes.
+};
+
+struct word_cache_key {
+    uint64_t hash;
+    uint64_t font_id;
+    unsigned int font_serial;
+    hb_segment_properties_t props;
+    unsigned int flags;
+    word_cache_settings settings;
+    const void* text;
+    unsigned int length;
+    int unit;
+    const hb_feature_t* features;
+    unsigned int num_features;
+    const int* coords;
+    unsigned int num_coords;
+};
+
+struct alignas(64) word_cache {
+    std::mutex mutex;
+    word_cache_entry* buckets[WORD_CACHE_BUCKETS] = {};
+    word_cache_entry* lru_head = nullptr;   // most recent
+    word_cache_entry* lru_tail = nullptr;
+    size_t max_bytes = 0;
+    size_t used_bytes = 0;
+    int entries = 0;
+};
+
+static word_cache g_word_cache[WORD_CACHE_SHARDS];
+static std::atomic<int> g_word_cache_enabled{0};
+static std::atomic<unsigned> g_word_cache_hits{0};
+static std::atomic<unsigned> g_word_cache_misses{0};
+static std::atomic<unsigned> g_word_cache_fallbacks{0};
+static std::atomic<uint64_t> g_word_cache_next_font_id{1};
+static hb_user_data_key_t g_word_cache_font_key;
+
+static inline hb_feature_t* word_entry_features(word_cache_entry* e) { return (hb_feature_t*)(e + 1); }
+static inline int* word_entry_coords(word_cache_entry* e) { return (int*)(word_entry_features(e) + e->num_features); }
+static inline ut_hb_glyph* word_entry_glyphs(word_cache_entry* e) {
+    return (ut_hb_glyph*)(word_entry_coords(e) + e->num_coords);
+}
+static inline char* word_entry_text(word_cache_entry* e) { return (char*)(word_entry_glyphs(e) + e->glyph_count); }
+
+// Shard from the high hash bits, bucket from the low ones.
+static inline word_cache* word_cache_shard(uint64_t hash) {
+    return &g_word_cache[(hash >> 56) & (WORD_CACHE_SHARDS - 1)];
+}
+
+// Per-font id that is never reused (hb_font_t addresses are), attached as
+// font user data. 0 for inert fonts.
+static uint64_t word_cache_font_id(hb_font_t* font) {
+    uint64_t* id = (uint64_t*)hb_font_get_user_data(font, &g_word_cache_font_key);
+    if (id) return *id;
+    id = (uint64_t*)malloc(sizeof(uint64_t));
+    if (!id) return 0;
+    *id = g_word_cache_next_font_id.fetch_add(1, std::memory_order_relaxed);
+    if (!hb_font_set_user_data(font, &g_word_cache_font_key, id, free, false)) {
+        free(id);   // another thread attached one first (or the font is inert)
+        id = (uint64_t*)hb_font_get_user_data(font, &g_word_cache_font_key);
+        return id ? *id : 0;
+    }
+    return *id;
+}
+
+static bool word_cache_entry_matches(word_cache_entry* e, const word_cache_key* k) {
+    return e->hash == k->hash && e->font_id == k->font_id && e->font_serial == k->font_serial
+        && e->props.direction == k->props.direction && e->props.script == k->props.script
+        && e->props.language == k->props.language && e->flags == k->flags
+        && memcmp(&e->settings, &k->settings, sizeof(word_cache_settings)) == 0
+        && e->length == k->length && e->unit == k->unit
+        && e->num_features == k->num_features && e->num_coords == k->num_coords
+        && memcmp(word_entry_text(e), k->text, (size_t)k->length * k->unit) == 0
+        && (!k->num_features || memcmp(word_entry_features(e), k->features, k->num_features * sizeof(hb_feature_t)) == 0)
+        && (!k->num_coords || memcmp(word_entry_coords(e), k->coords, k->num_coords * sizeof(int)) == 0);
+}
+
+static void word_cache_unlink(word_cache* c, word_cache_entry* e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next; else c->lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev; else c->lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = nullptr;
+}
+
+static void word_cache_push_front(word_cache* c, word_cache_entry* e) {
+    e->lru_prev = nullptr;
+    e->lru_next = c->lru_head;
+    if (c->lru_head) c->lru_head->lru_prev = e; else c->lru_tail = e;
+    c->lru_head = e;
+}
+
+static void word_cache_evict(word_cache* c, word_cache_entry* e) {
+    word_cache_entry** link = &c->buckets[e->hash & (WORD_CACHE_BUCKETS - 1)];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+    word_cache_unlink(c, e);
+    c->used_bytes -= e->bytes;
+    c->entries--;
+    free(e);
+}
+
+// Looks the segment up under its shard's lock. When found and safe to splice on
+// the edges that touch another segment, its glyphs are appended to *staged
+// (clusters shifted by cluster_base). Returns -1 on a miss, 0 when the entry
+// cannot be spliced here, 1 when appended.
+static int word_cache_lookup(const word_cache_key* k, bool need_start, bool need_end,
+                             unsigned int cluster_base, int run_index, std::vector<ut_hb_glyph>* staged) {
+    word_cache* c = word_cache_shard(k->hash);
+    std::lock_guard<std::mutex> lock(c->mutex);
+    for (word_cache_entry* e = c->buckets[k->hash & (WORD_CACHE_BUCKETS - 1)]; e; e = e->hash_next) {
+        if (!word_cache_entry_matches(e, k)) continue;
+        if (c->lru_head != e) {
+            word_cache_unlink(c, e);
+            word_cache_push_front(c, e);
+        }
+        if ((need_start && !e->start_safe) || (need_end && !e->end_safe)) return 0;
+        const ut_hb_glyph* g = word_entry_glyphs(e);
+        for (unsigned int i = 0; i < e->glyph_count; i++) {
+            ut_hb_glyph out = g[i];
+            out.cluster += cluster_base;
+            out.run_index = run_index;
+            staged->push_back(out);
+        }
+        return 1;
+    }
+    return -1;
+}
+
+// Stores a freshly shaped segment. A lost race with another thread inserting
+// the same key keeps the first copy.
+static void word_cache_insert(const word_cache_key* k, bool start_safe, bool end_safe,
+                              const ut_hb_glyph* glyphs, unsigned int glyph_count) {
+    size_t bytes = sizeof(word_cache_entry) + k->num_features * sizeof(hb_feature_t)
+                 + k->num_coords * sizeof(int) + glyph_count * sizeof(ut_hb_glyph)
+                 + (size_t)k->length * k->unit;
+    word_cache_entry* e = (word_cache_entry*)malloc(bytes);
+    if (!e) return;
+    memset(e, 0, sizeof(word_cache_entry));
+    e->hash = k->hash;
+    e->font_id = k->font_id;
+    e->font_serial = k->font_serial;
+    e->props = k->props;
+    e->flags = k->flags;
+    e->settings = k->settings;
+    e->length = k->length;
+    e->unit = k->unit;
+    e->num_features = k->num_features;
+    e->num_coords = k->num_coords;
+    e->glyph_count = glyph_count;
+    e->start_safe = start_safe;
+    e->end_safe = end_safe;
+    e->bytes = bytes;
+    if (k->num_features) memcpy(word_entry_features(e), k->features, k->num_features * sizeof(hb_feature_t));
+    if (k->num_coords) memcpy(word_entry_coords(e), k->coords, k->num_coords * sizeof(int));
+    if (glyph_count) memcpy(word_entry_glyphs(e), glyphs, glyph_count * sizeof(ut_hb_glyph));
+    memcpy(word_entry_text(e), k->text, (size_t)k->length * k->unit);
+
+    word_cache* c = word_cache_shard(k->hash);
+    std::lock_guard<std::mutex> lock(c->mutex);
+    word_cache_entry** bucket = &c->buckets[k->hash & (WORD_CACHE_BUCKETS - 1)];
+    for (word_cache_entry* o = *bucket; o; o = o->hash_next) {
+        if (word_cache_entry_matches(o, k)) {
+            free(e);
+            return;
+        }
+    }
+    if (!c->max_bytes) {    // disabled while this segment was being shaped
+        free(e);
+        return;
+    }
+    // Evict from the cold end; a single segment over the cap still gets cached.
+    while (c->lru_tail && c->used_bytes + bytes > c->max_bytes) word_cache_evict(c, c->lru_tail);
+    e->hash_next = *bucket;
+    *bucket = e;
+    word_cache_push_front(c, e);
+    c->used_bytes += bytes;
+    c->entries++;
+}
+
+static inline bool word_glyph_unsafe(const hb_glyph_info_t* info) {
+    return (hb_glyph_info_get_glyph_flags(info) & (HB_GLYPH_FLAG_UNSAFE_TO_BREAK | HB_GLYPH_FLAG_UNSAFE_TO_CONCAT)) != 0;
+}
+
+static thread_local std::vector<unsigned int> t_word_bounds;
+static thread_local std::vector<ut_hb_glyph> t_word_glyphs;
+static thread_local std::vector<ut_hb_glyph> t_word_segment;
+
+// Shapes `run` segment by segment through the word cache into *staged (run
+// order, like hb_shape output). Returns false — *staged undefined — when the
+// run has to be shaped whole instead.
+static bool word_cache_shape_run(hb_buffer_t* buffer, const hb_text* text, const ut_hb_run* run, int run_index,
+                                 std::vector<ut_hb_glyph>* staged) {
+    unsigned int start = run->offset;
+    unsigned int end = run->length < 0 ? (unsigned int)text->length : start + (unsigned int)run->length;
+    if (start == end) return false;
+    if (start > 0 && hb_text_at(text, start - 1) != ' ') return false;
+    if (end < (unsigned int)text->length && hb_text_at(text, end) != ' ' && hb_text_at(text, end - 1) != ' ')
+        return false;
+
+    uint64_t font_id = word_cache_font_id(run->font);
+    if (!font_id) return false;
+
+    // Segment boundaries: after each run of spaces.
+    std::vector<unsigned int>& bounds = t_word_bounds;
+    bounds.clear();
+    bounds.push_back(start);
+    for (unsigned int i = start; i < end;) {
+        while (i < end && hb_text_at(text, i) != ' ') i++;
+        while (i < end && hb_text_at(text, i) == ' ') i++;
+        if (i - bounds.back() > WORD_CACHE_MAX_LENGTH) return false;
+        bounds.push_back(i);
+    }
+
+    word_cache_key k;
+    k.font_id = font_id;
+    k.font_serial = hb_font_get_serial(run->font);
+    k.props.direction = run->direction;
+    k.props.script = (hb_script_t)run->script_tag;
+    k.props.language = run->language;
+    k.features = run->num_features ? run->features : nullptr;
+    k.num_features = k.features ? run->num_features : 0;
+    k.coords = hb_font_get_var_coords_normalized(run->font, &k.num_coords);
+    if (!k.coords) k.num_coords = 0;
+    k.unit = text->unit;
+    k.settings.cluster_level = (uint32_t)hb_buffer_get_cluster_level(buffer);
+    k.settings.replacement = hb_buffer_get_replacement_codepoint(buffer);
+    k.settings.invisible = hb_buffer_get_invisible_glyph(buffer);
+    k.settings.not_found = hb_buffer_get_not_found_glyph(buffer);
+    uint64_t seed[6] = { font_id, k.font_serial, (uint64_t)run->direction, (uint64_t)run->script_tag,
+                         (uint64_t)(uintptr_t)run->language, (uint64_t)text->unit };
+    uint64_t base_hash = ut_hash64(seed, sizeof(seed), 0);
+    base_hash = ut_hash64(&k.settings, sizeof(k.settings), base_hash);
+    base_hash = ut_hash64(k.features, k.num_features * sizeof(hb_feature_t), base_hash);
+    base_hash = ut_hash64(k.coords, k.num_coords * sizeof(int), base_hash);
+
+    bool backward = HB_DIRECTION_IS_BACKWARD(run->direction);
+    int segments = (int)bounds.size() - 1;
+    staged->clear();
+    for (int s = 0; s < segments; s++) {
+        // HarfBuzz emits backward runs in visual order, last segment first.
+        int seg = backward ? segments - 1 - s : s;
+        unsigned int seg_start = bounds[seg], seg_end = bounds[seg + 1];
+        unsigned int flags = (run->flags & ~(unsigned int)(HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT))
+                           | HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT;
+        if (seg_start == start) flags |= run->flags & HB_BUFFER_FLAG_BOT;
+        if (seg_end == end)     flags |= run->flags & HB_BUFFER_FLAG_EOT;
+        k.flags = flags;
+        hb_text seg_text = hb_text_slice(text, seg_start, seg_end - seg_start);
+        k.text = seg_text.data;
+        k.length = seg_end - seg_start;
+        uint32_t flags32 = flags;
+        k.hash = ut_hash64(&flags32, sizeof(flags32), ut_hash64(k.text, (size_t)k.length * k.unit, base_hash));
+
+        // The run's own ends are buffer ends either way; only splices need checking.
+        bool need_start = seg_start != start, need_end = seg_end != end;
+        int state = word_cache_lookup(&k, need_start, need_end, seg_start, run_index, staged);
+        if (state == 1) {
+            g_word_cache_hits.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (state == 0) return false;
+
+        g_word_cache_misses.fetch_add(1, std::memory_order_relaxed);
+        ut_hb_run seg_run = *run;
+        seg_run.offset = 0;
+        seg_run.length = (int)k.length;
+        seg_run.flags = flags;
+        unsigned int n = hb_shape_run_into(buffer, &seg_text, &seg_run);
+        const hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, nullptr);
+        const hb_glyph_position_t* pos = hb_buffer_get_glyph_positions(buffer, nullptr);
+        bool start_safe = n > 0 && !word_glyph_unsafe(&infos[backward ? n - 1 : 0]);
+        bool end_safe   = n > 0 && !word_glyph_unsafe(&infos[backward ? 0 : n - 1]);
+
+        std::vector<ut_hb_glyph>& glyphs = t_word_segment;
+        glyphs.resize(n);
+        for (unsigned int i = 0; i < n; i++) {
+            glyphs[i].glyph_id  = infos[i].codepoint;
+            glyphs[i].cluster   = infos[i].cluster;
+            glyphs[i].x_advance = pos[i].x_advance;
+            glyphs[i].y_advance = pos[i].y_advance;
+            glyphs[i].x_offset  = pos[i].x_offset;
+            glyphs[i].y_offset  = pos[i].y_offset;
+            glyphs[i].run_index = run_index;
+        }
+        word_cache_insert(&k, start_safe, end_safe, glyphs.data(), n);
+        if ((need_start && !start_safe) || (need_end && !end_safe)) return false;
+        for (unsigned int i = 0; i < n; i++) {
+            glyphs[i].cluster += seg_start;
+            staged->push_back(glyphs[i]);
+        }
+    }
+    return true;
+}
+
+// Enables (or resizes) the word cache with a byte cap shared by all fonts
+// (split evenly across shards); max_bytes <= 0 disables and frees it. Off by
+// default.
+UNITEXT_EXPORT void ut_hb_word_cache_enable(long max_bytes) {
+    size_t shard_bytes = max_bytes > 0 ? ((size_t)max_bytes + WORD_CACHE_SHARDS - 1) / WORD_CACHE_SHARDS : 0;
+    for (int i = 0; i < WORD_CACHE_SHARDS; i++) {
+        word_cache* c = &g_word_cache[i];
+        std::lock_guard<std::mutex> lock(c->mutex);
+        c->max_bytes = shard_bytes;
+        while (c->lru_tail && c->used_bytes > c->max_bytes) word_cache_evict(c, c->lru_tail);
+    }
+    g_word_cache_enabled.store(max_bytes > 0 ? 1 : 0, std::memory_order_relaxed);
+}
+
+// Segment lookups served from / shaped into the cache, and runs that had to
+// be shaped whole (unsafe edges, unspaced text, context at the run edges)
+// since start.
+UNITEXT_EXPORT void ut_hb_word_cache_stats(int* out_entries, long* out_bytes, unsigned int* out_hits,
+                                           unsigned int* out_misses, unsigned int* out_fallbacks) {
+    int entries = 0;
+    size_t bytes = 0;
+    for (int i = 0; i < WORD_CACHE_SHARDS; i++) {
+        word_cache* c = &g_word_cache[i];
+        std::lock_guard<std::mutex> lock(c->mutex);
+        entries += c->entries;
+        bytes += c->used_bytes;
+    }
+    if (out_entries) *out_entries = entries;
+    if (out_bytes)   *out_bytes   = (long)bytes;
+    if (out_hits)      *out_hits      = g_word_cache_hits.load(std::memory_order_relaxed);
+    if (out_misses)    *out_misses    = g_word_cache_misses.load(std::memory_order_relaxed);
+    if (out_fallbacks) *out_fallbacks = g_word_cache_fallbacks.load(std::memory_order_relaxed);
+}
+
+static int hb_shape_runs(hb_buffer_t* buffer, const hb_text* text, const ut_hb_run* runs, int run_count,
+                         ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    if (out_glyph_count) *out_glyph_count = 0;
+    if (!buffer || !out_glyph_count || text->length < 0 || (text->length && !text->data)
+        || run_count < 0 || (run_count && !runs) || capacity < 0 || (capacity && !out_glyphs))
+        return -1;
+    for (int r = 0; r < run_count; r++)
+        if (!hb_run_valid(&runs[r], text->length)) return -1;
+
+    size_t total = 0;
+    bool word_cache_on = g_word_cache_enabled.load(std::memory_order_relaxed) != 0;
+    for (int r = 0; r < run_count; r++) {
+        if (word_cache_on) {
+            std::vector<ut_hb_glyph>& staged = t_word_glyphs;
+            if (word_cache_shape_run(buffer, text, &runs[r], r, &staged)) {
+                if (total < (size_t)capacity) {
+                    size_t fit = (size_t)capacity - total < staged.size() ? (size_t)capacity - total : staged.size();
+                    memcpy(out_glyphs + total, staged.data(), fit * sizeof(ut_hb_glyph));
+                }
+                total += staged.size();
+                continue;
+            }
+            g_word_cache_fallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+        unsigned int n = hb_shape_run_into(buffer, text, &runs[r]);
+        if (total < (size_t)capacity) {
+            const hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, nullptr);
+            const hb_glyph_position_t* pos = hb_buffer_get_glyph_positions(buffer, nullptr);
+            size_t fit = (size_t)capacity - total < n ? (size_t)capacity - total : n;
+            ut_hb_glyph* dst = out_glyphs + total;
+            for (size_t i = 0; i < fit; i++) {
+                dst[i].glyph_id  = infos[i].codepoint;
+                dst[i].cluster   = infos[i].cluster;
+                dst[i].x_advance = pos[i].x_advance;
+                dst[i].y_advance = pos[i].y_advance;
+                dst[i].x_offset  = pos[i].x_offset;
+                dst[i].y_offset  = pos[i].y_offset;
+                dst[i].run_index = r;
+            }
+        }
+        total += n;
+    }
+    if (total > INT_MAX) return -1;
+    *out_glyph_count = (int)total;
+    return total > (size_t)capacity ? -2 : 0;
+}
+
+// Shapes runs[run_count] over codepoints[text_length] (every run sees the
+// whole text as context) through `buffer`, writing up to `capacity` records
+// to out_glyphs. *out_glyph_count is always the total the batch produced.
+// Returns 0, -1 on bad args, or -2 when the total exceeds capacity — the
+// records that fit are written, so a sizing pass is a call with
+// capacity 0 / out_glyphs NULL, then grow and retry. Served from the word
+// cache when it is enabled.
+UNITEXT_EXPORT int ut_hb_shape_runs_batch(hb_buffer_t* buffer, const unsigned int* codepoints, int text_length,
+                                          const ut_hb_run* runs, int run_count,
+                                          ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    hb_text text = { codepoints, text_length, 4 };
+    return hb_shape_runs(buffer, &text, runs, run_count, out_glyphs, capacity, out_glyph_count);
+}
+
+// Same over UTF-16 text (e.g. a pinned C# string): run offsets/lengths and
+// glyph clusters are UTF-16 code units.
+UNITEXT_EXPORT int ut_hb_shape_runs_batch_utf16(hb_buffer_t* buffer, const uint16_t* text, int text_length,
+                                                const ut_hb_run* runs, int run_count,
+                                                ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    hb_text t = { text, text_length, 2 };
+    return hb_shape_runs(buffer, &t, runs, run_count, out_glyphs, capacity, out_glyph_count);
+}
+
+// Same over UTF-8 text: run offsets/lengths and glyph clusters are bytes.
+UNITEXT_EXPORT int ut_hb_shape_runs_batch_utf8(hb_buffer_t* buffer, const char* text, int text_length,
+                                               const ut_hb_run* runs, int run_count,
+                                               ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    hb_text t = { text, text_length, 1 };
+    return hb_shape_runs(buffer, &t, runs, run_count, out_glyphs, capacity, out_glyph_count);
+}
+
+// --- Parallel paragraphs ---
+//
+// Independent paragraphs shaped across the worker pool, each through
+// ut_hb_shape_runs_batch (or its UTF-16/UTF-8 forms, per text_unit) into its
+// own output slice, with the paragraph's buffer settings. Paragraphs are handed
+// out one at a time through the pool's shared counter, so a long paragraph
+// does not hold up the rest. Every thread shapes through its own hb_buffer_t,
+// created on first use and kept for later calls. Fonts are shared: HarfBuzz
+// shapes one hb_font_t from several threads as long as nothing modifies it
+// meanwhile, so the caller must not change scale, variations or funcs while
+// the call runs. The plan and word caches are already thread-safe.
+
+typedef struct {
+    const void* text;
+    int text_length;            // code units
+    int text_unit;              // bytes per code unit: 4 (or 0) = code points, 2 = UTF-16, 1 = UTF-8
+    const ut_hb_run* runs;      // buffer flags (BOT/EOT, ...) come from each run's flags
+    int run_count;
+    // Buffer settings; all zero = HarfBuzz's defaults
+    int cluster_level;          // hb_buffer_cluster_level_t
+    unsigned int replacement;   // code point for invalid UTF-8/16; 0 = U+FFFD
+    unsigned int invisible;     // glyph for default ignorables; 0 = the space glyph
+    unsigned int not_found;     // glyph for unmapped code points
+    ut_hb_glyph* out_glyphs;    // this paragraph's slice
+    int capacity;
+    int glyph_count;            // out: total the paragraph produced
+    int result;                 // out: ut_hb_shape_runs_batch return value
+} ut_hb_paragraph;
+
+struct hb_thread_buffer {
+    hb_buffer_t* buffer = nullptr;
+    ~hb_thread_buffer() { hb_buffer_destroy(buffer); }
+};
+
+static thread_local hb_thread_buffer t_hb_buffer;
+
+// The calling thread's shaping buffer, or NULL on OOM.
+static hb_buffer_t* hb_thread_buffer_get() {
+    hb_thread_buffer& b = t_hb_buffer;
+    if (!b.buffer) {
+        b.buffer = hb_buffer_create();
+        if (!hb_buffer_allocation_successful(b.buffer)) {
+            hb_buffer_destroy(b.buffer);
+            b.buffer = nullptr;
+        }
+    }
+    return b.buffer;
+}
+
+// Shapes one paragraph through buffer, applying its buffer settings first
+// (the buffer is reused, so every paragraph sets all of them).
+static void hb_paragraph_shape(hb_buffer_t* buffer, ut_hb_paragraph* p) {
+    int unit = p->text_unit ? p->text_unit : 4;
+    if (unit != 1 && unit != 2 && unit != 4) {
+        p->glyph_count = 0;
+        p->result = -1;
+        return;
+    }
+    hb_buffer_set_cluster_level(buffer, (hb_buffer_cluster_level_t)p->cluster_level);
+    hb_buffer_set_replacement_codepoint(buffer, p->replacement ? p->replacement : HB_BUFFER_REPLACEMENT_CODEPOINT_DEFAULT);
+    hb_buffer_set_invisible_glyph(buffer, p->invisible);
+    hb_buffer_set_not_found_glyph(buffer, p->not_found);
+    hb_text t = { p->text, p->text_length, unit };
+    p->result = hb_shape_runs(buffer, &t, p->runs, p->run_count, p->out_glyphs, p->capacity, &p->glyph_count);
+}
+
+static void hb_paragraph_job(void* ctx, int index, int slot) {
+    ut_hb_paragraph* p = &((ut_hb_paragraph*)ctx)[index];
+    hb_buffer_t* buffer = hb_thread_buffer_get();
+    if (!buffer) {
+        p->glyph_count = 0;
+        p->result = -1;
+        return;
+    }
+    hb_paragraph_shape(buffer, p);
+}
+
+// Shapes paragraphs[count] on up to max_threads threads (<= 0 = all). Each
+// paragraph gets ut_hb_shape_runs_batch semantics in its glyph_count/result;
+// on -2 only that paragraph needs a bigger slice and another call. Returns
+// 0 if every paragraph succeeded, otherwise the first non-zero result.
+UNITEXT_EXPORT int ut_hb_shape_paragraphs(ut_hb_paragraph* paragraphs, int count, int max_threads) {
+    if (!paragraphs || count < 0) return -1;
+    if (count == 0) return 0;
+
+    // Below ~4 paragraphs per thread, wake-up latency outweighs the work.
+    int slots = (count + 3) / 4;
+    if (max_threads > 0 && slots > max_threads) slots = max_threads;
+    pool_parallel_for(count, slots, hb_paragraph_job, paragraphs);
+
+    for (int i = 0; i < count; i++) {
+        if (paragraphs[i].result != 0) return paragraphs[i].result;
+    }
+    return 0;
+}
+
+// =============================================================================
+// Variable Font API
+// =============================================================================
+
+// --- HarfBuzz variable font ---
+
+UNITEXT_EXPORT unsigned int ut_hb_ot_var_get_axis_count(hb_face_t* face) {
+    return hb_ot_var_get_axis_count(face);
+}
+
+UNITEXT_EXPORT unsigned int ut_hb_ot_var_get_axis_infos(hb_face_t* face, unsigned int start_offset,
+    unsigned int* axes_count, hb_ot_var_axis_info_t* axes_info) {
+    return hb_ot_var_get_axis_infos(face, start_offset, axes_count, axes_info);
+}
+
+UNITEXT_EXPORT void ut_hb_font_set_variations(hb_font_t* font, const hb_variation_t* variations, unsigned int variations_length) {
+    hb_font_set_variations(font, variations, variations_length);
+}
+
+// --- FreeType variable font ---
+
+UNITEXT_EXPORT int ut_ft_get_mm_var(FT_Face face, FT_MM_Var** amaster) {
+    return FT_Get_MM_Var(face, amaster);
+}
+
+UNITEXT_EXPORT int ut_ft_done_mm_var(FT_Library library, FT_MM_Var* amaster) {
+    return FT_Done_MM_Var(library, amaster);
+}
+
+UNITEXT_EXPORT int ut_ft_set_var_design_coordinates(FT_Face face, unsigned int num_coords, int* coords) {
+    if (sizeof(FT_Fixed) == sizeof(int)) {
+        return FT_Set_Var_Design_Coordinates(face, num_coords, (FT_Fixed*)coords);
+    }
+    FT_Fixed buf[64];
+    unsigned int n = num_coords < 64 ? num_coords : 64;
+    for (unsigned int i = 0; i < n; i++)
+        buf[i] = (FT_Fixed)coords[i];
+    return FT_Set_Var_Design_Coordinates(face, n, buf);
+}
+
+// === sbix Diagnostic ===
+// Reads the graphicType from the first glyph in the sbix table
+// Returns 1 on success, 0 on failure
+// outGraphicType must be at least 5 bytes (4 chars + null terminator)
+UNITEXT_EXPORT int ut_debug_sbix_graphic_type(FT_Face face, char* outGraphicType, int* outNumStrikes) {
+    if (!face || !outGraphicType) return 0;
+
+    outGraphicType[0] = 0;
+    if (outNumStrikes) *outNumStrikes = 0;
+
+    // Get sbix table size
+    FT_ULong length = 0;
+    FT_Error err = FT_Load_Sfnt_Table(face, FT_MAKE_TAG('s','b','i','x'), 0, NULL, &length);
+    if (err != 0 || length < 16) return 0;
+
+    // Load sbix table
+    FT_Byte* buffer = (FT_Byte*)malloc(length);
+    if (!buffer) return 0;
+
+    err = FT_Load_Sfnt_Table(face, FT_MAKE_TAG('s','b','i','x'), 0, buffer, &length);
+    if (err != 0) {
+        free(buffer);
+        return 0;
+    }
+
+    // sbix table structure:
+    // [0-1]  version (uint16)
+    // [2-3]  flags (uint16)
+    // [4-7]  numStrikes (uint32)
+    // [8...] strikeOffsets[] (uint32 each)
+
+    uint32_t numStrikes = ((uint32_t)buffer[4] << 24) | ((uint32_t)buffer[5] << 16) |
+                          ((uint32_t)buffer[6] << 8) | buffer[7];
+    if (outNumStrikes) *outNumStrikes = (int)numStrikes;
+
+    if (numStrikes == 0) {
+        free(buffer);
+        return 0;
+    }
+
+    // Get first strike offset
+    uint32_t strikeOffset = ((uint32_t)buffer[8] << 24) | ((uint32_t)buffer[9] << 16) |
+                            ((uint32_t)buffer[10] << 8) | buffer[11];
+
+    // Strike structure:
+    // [0-1]  ppem (uint16)
+    // [2-3]  ppi (uint16)
+    // [4...] glyphDataOffsets[] (uint32 each, numGlyphs+1 entries)
+
+    if (strikeOffset + 8 >= length) {
+        free(buffer);
+        return 0;
+    }
+
+    // Get number of glyphs to find first non-empty glyph data
+    FT_ULong numGlyphs = face->num_glyphs;
+
+    // Find first glyph with actual data
+    for (FT_ULong g = 0; g < numGlyphs && g < 10000; g++) {
+        uint32_t offsetIdx = strikeOffset + 4 + g * 4;
+        if (offsetIdx + 8 > length) break;
+
+        uint32_t glyphDataOffset = ((uint32_t)buffer[offsetIdx] << 24) |
+                                   ((uint32_t)buffer[offsetIdx + 1] << 16) |
+                                   ((uint32_t)buffer[offsetIdx + 2] << 8) |
+                                   buffer[offsetIdx + 3];
+        uint32_t nextGlyphDataOffset = ((uint32_t)buffer[offsetIdx + 4] << 24) |
+                                       ((uint32_t)buffer[offsetIdx + 5] << 16) |
+                                       ((uint32_t)buffer[offsetIdx + 6] << 8) |
+                                       buffer[offsetIdx + 7];
+
+        // Check if this glyph has data
+        if (nextGlyphDataOffset > glyphDataOffset) {
+            // Glyph data structure:
+            // [0-1]  originOffsetX (int16)
+            // [2-3]  originOffsetY (int16)
+            // [4-7]  graphicType (4 chars)
+            // [8...] data
+
+            uint32_t dataPos = strikeOffset + glyphDataOffset;
+            if (dataPos + 8 <= length) {
+                outGraphicType[0] = (char)buffer[dataPos + 4];
+                outGraphicType[1] = (char)buffer[dataPos + 5];
+                outGraphicType[2] = (char)buffer[dataPos + 6];
+                outGraphicType[3] = (char)buffer[dataPos + 7];
+                outGraphicType[4] = 0;
+                free(buffer);
+                return 1;
+            }
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
+
+// =============================================================================
+// FreeType Wrapper Functions
+// =============================================================================
+
+UNITEXT_EXPORT void ut_ft_get_face_info(FT_Face face, long long* out_face_flags, int* out_num_glyphs,
+                                              int* out_units_per_em, int* out_num_fixed_sizes,
+                                              int* out_num_faces, int* out_face_index,
+                                              short* out_ascender, short* out_descender, short* out_height) {
+    if (!face) return;
+    if (out_face_flags) *out_face_flags = (long long)face->face_flags;
+    if (out_num_glyphs) *out_num_glyphs = (int)face->num_glyphs;
+    if (out_units_per_em) *out_units_per_em = face->units_per_EM;
+    if (out_num_fixed_sizes) *out_num_fixed_sizes = face->num_fixed_sizes;
+    if (out_num_faces) *out_num_faces = (int)face->num_faces;
+    if (out_face_index) *out_face_index = (int)face->face_index;
+    if (out_ascender) *out_ascender = face->ascender;
+    if (out_descender) *out_descender = face->descender;
+    if (out_height) *out_height = face->height;
+}
+
+// Reads OS/2 table metrics + post table underline + face names + weight/style.
+// Returns 1 if OS/2 table was found, 0 otherwise. Post/name/style data is always filled if available.
+UNITEXT_EXPORT int ut_ft_get_extended_face_info(FT_Face face,
+    // OS/2 table
+    short* out_cap_height, short* out_x_height,
+    short* out_y_superscript_y_offset, short* out_y_superscript_y_size,
+    short* out_y_subscript_y_offset, short* out_y_subscript_y_size,
+    short* out_y_strikeout_position, short* out_y_strikeout_size,
+    // post table (via FT_FaceRec)
+    short* out_underline_position, short* out_underline_thickness,
+    // name table (via FT_FaceRec)
+    const char** out_family_name, const char** out_style_name,
+    // weight & style (OS/2 usWeightClass + FT_FaceRec style_flags)
+    short* out_weight_class, int* out_style_flags)
+{
+    if (!face) return 0;
+
+    // Post table fields from FT_FaceRec
+    if (out_underline_position) *out_underline_position = face->underline_position;
+    if (out_underline_thickness) *out_underline_thickness = face->underline_thickness;
+
+    // Name table fields from FT_FaceRec
+    if (out_family_name) *out_family_name = face->family_name;
+    if (out_style_name) *out_style_name = face->style_name;
+
+    // Style flags from FT_FaceRec (always available)
+    if (out_style_flags) *out_style_flags = (int)face->style_flags;
+
+    // Default weight class (overwritten below if OS/2 exists)
+    if (out_weight_class) *out_weight_class = 0;
+
+    // OS/2 table
+    TT_OS2* os2 = (TT_OS2*)FT_Get_Sfnt_Table(face, FT_SFNT_OS2);
+    if (!os2) return 0;
+
+    if (out_cap_height) *out_cap_height = os2->sCapHeight;
+    if (out_x_height) *out_x_height = os2->sxHeight;
+    if (out_y_superscript_y_offset) *out_y_superscript_y_offset = os2->ySuperscriptYOffset;
+    if (out_y_superscript_y_size) *out_y_superscript_y_size = os2->ySuperscriptYSize;
+    if (out_y_subscript_y_offset) *out_y_subscript_y_offset = os2->ySubscriptYOffset;
+    if (out_y_subscript_y_size) *out_y_subscript_y_size = os2->ySubscriptYSize;
+    if (out_y_strikeout_position) *out_y_strikeout_position = os2->yStrikeoutPosition;
+    if (out_y_strikeout_size) *out_y_strikeout_size = os2->yStrikeoutSize;
+    if (out_weight_class) *out_weight_class = (short)os2->usWeightClass;
+
+    return 1;
+}
+
+UNITEXT_EXPORT int ut_ft_get_fixed_size(FT_Face face, int index) {
+    if (!face || index < 0 || index >= face->num_fixed_sizes) return 0;
+    return face->available_sizes[index].height;
+}
+
+UNITEXT_EXPORT void ut_ft_get_glyph_metrics(FT_Face face, int* out_width, int* out_height,
+                                                  int* out_bearing_x, int* out_bearing_y,
+                                                  int* out_advance_x, int* out_advance_y) {
+    if (!face || !face->glyph) return;
+    FT_Glyph_Metrics* m = &face->glyph->metrics;
+    if (out_width) *out_width = (int)(m->width >> 6);
+    if (out_height) *out_height = (int)(m->height >> 6);
+    if (out_bearing_x) *out_bearing_x = (int)(m->horiBearingX >> 6);
+    if (out_bearing_y) *out_bearing_y = (int)(m->horiBearingY >> 6);
+    if (out_advance_x) *out_advance_x = (int)m->horiAdvance;
+    if (out_advance_y) *out_advance_y = (int)m->vertAdvance;
+}
+
+UNITEXT_EXPORT void ut_ft_get_bitmap_info(FT_Face face, int* out_width, int* out_height,
+                                                int* out_pitch, int* out_pixel_mode, void** out_buffer) {
+    if (!face || !face->glyph) return;
+    FT_Bitmap* b = &face->glyph->bitmap;
+    if (out_width) *out_width = (int)b->width;
+    if (out_height) *out_height = (int)b->rows;
+    if (out_pitch) *out_pitch = b->pitch;
+    if (out_pixel_mode) *out_pixel_mode = b->pixel_mode;
+    if (out_buffer) *out_buffer = b->buffer;
+}
+
+UNITEXT_EXPORT FT_GlyphSlot ut_ft_get_glyph_slot(FT_Face face) {
+    return face ? face->glyph : nullptr;
+}
+
+UNITEXT_EXPORT int ut_ft_get_bitmap_top(FT_Face face) {
+    if (!face || !face->glyph) return 0;
+    return face->glyph->bitmap_top;
+}
+
+UNITEXT_EXPORT int ut_ft_get_bitmap_left(FT_Face face) {
+    if (!face || !face->glyph) return 0;
+    return face->glyph->bitmap_left;
+}
+
+// =============================================================================
+// FreeType Outline to Blend2D Path
+// =============================================================================
+
+// Appends outline to a cleared path with every coordinate multiplied by (sx, sy).
+static int outline_to_blpath(const FT_Outline* outline, BLPath* path, double sx, double sy) {
+    if (outline->n_points <= 0) return 0;
+    path->clear();
+
+    int contourStart = 0;
+    for (int c = 0; c < outline->n_contours; c++) {
+        int contourEnd = outline->contours[c];
 
         // Find first on-curve point
         int firstOnCurve = -1;
         for (int i = contourStart; i <= contourEnd; i++) {
-            if (outline->tags[i] & 1) { // FT_CURVE_TAG_ON
-                firstOnCurve = i;
-                break;
+            if (outline->tags[i] & 1) { // FT_CURVE_TAG_ON
+                firstOnCurve = i;
+                break;
+            }
+        }
+
+        if (firstOnCurve < 0) {
+            // All off-curve - create midpoint
+            const FT_Vector* p0 = &outline->points[contourStart];
+            const FT_Vector* p1 = &outline->points[contourStart + 1];
+            double mx = (p0->x + p1->x) / 2.0;
+            double my = (p0->y + p1->y) / 2.0;
+            path->move_to(mx * sx, my * sy);
+            firstOnCurve = contourStart;
+        } else {
+            const FT_Vector* p = &outline->points[firstOnCurve];
+            path->move_to(p->x * sx, p->y * sy);
+        }
+
+        int i = firstOnCurve;
+        int numPoints = contourEnd - contourStart + 1;
+
+        for (int j = 0; j < numPoints; j++) {
+            int idx = contourStart + ((i - contourStart + 1) % numPoints);
+            const FT_Vector* p = &outline->points[idx];
+            char tag = outline->tags[idx];
+
+            if (tag & 1) { // On curve
+                path->line_to(p->x * sx, p->y * sy);
+            } else if (tag & 2) { // Cubic
+                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
+                int idx3 = contourStart + ((idx - contourStart + 2) % numPoints);
+                const FT_Vector* p2 = &outline->points[idx2];
+                const FT_Vector* p3 = &outline->points[idx3];
+                path->cubic_to(p->x * sx, p->y * sy, p2->x * sx, p2->y * sy, p3->x * sx, p3->y * sy);
+                j += 2;
+                i = idx3;
+                continue;
+            } else { // Quadratic (conic)
+                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
+                const FT_Vector* p2 = &outline->points[idx2];
+                char tag2 = outline->tags[idx2];
+
+                double cx = p->x;
+                double cy = p->y;
+                double ex, ey;
+
+                if (tag2 & 1) { // Next is on-curve
+                    ex = p2->x;
+                    ey = p2->y;
+                    path->quad_to(cx * sx, cy * sy, ex * sx, ey * sy);
+                    j++;
+                    i = idx2;
+                    continue;
+                } else { // Next is also off-curve
+                    ex = (p->x + p2->x) / 2.0;
+                    ey = (p->y + p2->y) / 2.0;
+                    path->quad_to(cx * sx, cy * sy, ex * sx, ey * sy);
+                }
+            }
+            i = idx;
+        }
+
+        path->close();
+        contourStart = contourEnd + 1;
+    }
+
+    return 1;
+}
+
+UNITEXT_EXPORT int ut_ft_outline_to_blpath(FT_Face face, void* blPath) {
+    if (!face || !face->glyph || !blPath) return 0;
+    return outline_to_blpath(&face->glyph->outline, static_cast<BLPath*>(blPath), 1.0, 1.0);
+}
+
+// Loads glyph_index itself — through the face's outline cache when enabled —
+// and builds the path from the unscaled outline, design units × (scale_x,
+// scale_y); pass x_scale / 65536.0 (face->size->metrics) to get the 26.6
+// coordinates of ut_ft_outline_to_blpath. Returns 1 on success, 0 for empty
+// or non-outline glyphs and bad args.
+UNITEXT_EXPORT int ut_ft_glyph_to_blpath(FT_Face face, unsigned int glyph_index, double scale_x, double scale_y,
+                                         void* blPath) {
+    if (!face || !blPath) return 0;
+    const FT_Outline* outline;
+    const FT_Glyph_Metrics* m;
+    bool is_outline;
+    if (outline_load_unscaled(face, glyph_index, &outline, &m, &is_outline) || !is_outline) return 0;
+    return outline_to_blpath(outline, static_cast<BLPath*>(blPath), scale_x, scale_y);
+}
+
+UNITEXT_EXPORT int ut_ft_get_outline_info(FT_Face face, int* outNumContours, int* outNumPoints) {
+    if (!face || !face->glyph) return 0;
+    FT_Outline* outline = &face->glyph->outline;
+    if (outNumContours) *outNumContours = outline->n_contours;
+    if (outNumPoints) *outNumPoints = outline->n_points;
+    return 1;
+}
+
+// =============================================================================
+// Outline Decompose — manual FT_Outline walking (all-quadratic output)
+// =============================================================================
+//
+// Walks FT_Outline points/tags/contours directly, emitting ALL curves as
+// quadratic Béziers with float-precision implicit midpoints:
+// - On-curve lines → degenerate quadratic (control = midpoint)
+// - Conic (quadratic) → direct output
+// - Cubic (CFF/OTF) → uniform split into the fewest pieces whose
+//   single-quad approximation error < tolerance (count from the error bound,
+//   no recursion); matches fontTools.cu2qu / Skia behaviour. Replaces former
+//   fixed split-at-midpoint that visibly distorted curves on CFF fonts with
+//   high curvature.
+//
+// This produces better SDF quality than FT_Outline_Decompose because:
+// - Float midpoints (a+b)*0.5f vs FreeType's integer (a+b)/2 truncation
+// - Consistent contour starting point (first on-curve by linear search)
+// - No degenerate segment skipping
+//
+// Output format per curve: 8 floats (p0.x, p0.y, ctrl.x, ctrl.y, p2.x, p2.y, 0, 0)
+// outTypes[i]: always 2 (quadratic)
+
+// Cubic→quadratic in uniform pieces, count chosen up front.
+// For cubic [P0,P1,P2,P3] the single-quad approximation has control point
+//   Q1 = (3*P1 + 3*P2 - P0 - P3) / 4
+// and max deviation from the cubic of |P3 - 3*P2 + 3*P1 - P0| * sqrt(3) / 36
+// (standard bound; squared form avoids sqrt). Cutting the cubic into n equal
+// parameter spans divides that third difference by n³ in every span, so
+// n = ceil(cbrt(err / tolerance)) meets the tolerance everywhere — the former
+// recursive midpoint split reached the same bound only at powers of two.
+// Span [a, b] (h = b - a) then has the closed-form control point
+//   Q = (B(a) + B(b)) / 2 + h * (B'(a) - B'(b)) / 4
+// evaluated from the power basis; span ends are shared, so pieces join
+// exactly, and the first/last reuse P0/P3. n is capped at 256 (the old depth
+// cap of 8) for pathological inputs.
+static bool emit_cubic_as_quads(
+    float p0x, float p0y, float p1x, float p1y,
+    float p2x, float p2y, float p3x, float p3y,
+    float tolerance_sq,
+    int* curveIdx, int maxCurves,
+    float* outCurves, int* outTypes)
+{
+    float ex = p3x - 3.0f * p2x + 3.0f * p1x - p0x;
+    float ey = p3y - 3.0f * p2y + 3.0f * p1y - p0y;
+    float err_sq = (ex * ex + ey * ey) * (1.0f / 432.0f);
+
+    if (err_sq <= tolerance_sq) {
+        if (*curveIdx >= maxCurves) return false;
+        float* dst = outCurves + (*curveIdx) * 8;
+        dst[0] = p0x; dst[1] = p0y;
+        dst[2] = (3.0f * p1x + 3.0f * p2x - p0x - p3x) * 0.25f;
+        dst[3] = (3.0f * p1y + 3.0f * p2y - p0y - p3y) * 0.25f;
+        dst[4] = p3x; dst[5] = p3y;
+        dst[6] = 0;   dst[7] = 0;
+        outTypes[*curveIdx] = 2;
+        (*curveIdx)++;
+        return true;
+    }
+
+    // Smallest n with n⁶ · tolerance² ≥ err² (n is rarely above 4).
+    int n = 2;
+    while (n < 256) {
+        float n3 = (float)(n * n * n);
+        if (n3 * n3 * tolerance_sq >= err_sq) break;
+        n++;
+    }
+    if (*curveIdx + n > maxCurves) return false;
+
+    // B(t) = P0 + t*c1 + t²*c2 + t³*c3,  B'(t) = c1 + 2t*c2 + 3t²*c3
+    float c1x = 3.0f * (p1x - p0x),               c1y = 3.0f * (p1y - p0y);
+    float c2x = 3.0f * (p2x - 2.0f * p1x + p0x),  c2y = 3.0f * (p2y - 2.0f * p1y + p0y);
+    float c3x = ex,                               c3y = ey;
+
+    float h = 1.0f / (float)n;
+    float ax = p0x, ay = p0y;
+    float dax = c1x, day = c1y;
+    float* dst = outCurves + (*curveIdx) * 8;
+    for (int i = 1; i <= n; i++, dst += 8) {
+        float t = (float)i * h;
+        float bx, by;
+        if (i == n) {
+            bx = p3x; by = p3y;
+        } else {
+            bx = p0x + t * (c1x + t * (c2x + t * c3x));
+            by = p0y + t * (c1y + t * (c2y + t * c3y));
+        }
+        float dbx = c1x + t * (2.0f * c2x + 3.0f * t * c3x);
+        float dby = c1y + t * (2.0f * c2y + 3.0f * t * c3y);
+        dst[0] = ax; dst[1] = ay;
+        dst[2] = (ax + bx) * 0.5f + (dax - dbx) * (h * 0.25f);
+        dst[3] = (ay + by) * 0.5f + (day - dby) * (h * 0.25f);
+        dst[4] = bx; dst[5] = by;
+        dst[6] = 0;  dst[7] = 0;
+        outTypes[*curveIdx + i - 1] = 2;
+        ax = bx; ay = by;
+        dax = dbx; day = dby;
+    }
+    *curveIdx += n;
+    return true;
+}
+
+// Walks an FT_Outline (design units or 26.6 — the walker is unit-agnostic)
+// into all-quadratic curves. Returns 0, -2 (maxCurves exceeded) or -3
+// (maxContours exceeded).
+static int outline_to_quads(const FT_Outline* outline, float tolerance_sq,
+                            float* outCurves, int* outTypes, int* outCurveCount, int maxCurves,
+                            int* outContours, int* outContourCount, int maxContours)
+{
+    int curveIdx = 0;
+    int contourIdx = 0;
+
+    #define EMIT_SEG(ax, ay, bx, by, cx, cy) do { \
+        if (curveIdx >= maxCurves) return -2; \
+        float* dst = outCurves + curveIdx * 8; \
+        dst[0] = (float)(ax); dst[1] = (float)(ay); \
+        dst[2] = (float)(bx); dst[3] = (float)(by); \
+        dst[4] = (float)(cx); dst[5] = (float)(cy); \
+        dst[6] = 0; dst[7] = 0; \
+        outTypes[curveIdx] = 2; \
+        curveIdx++; \
+    } while(0)
+
+    int contourStart = 0;
+    for (int c = 0; c < outline->n_contours; c++) {
+        int contourEnd = outline->contours[c];
+        int numPoints = contourEnd - contourStart + 1;
+        if (numPoints < 2) { contourStart = contourEnd + 1; continue; }
+
+        int contourCurveStart = curveIdx;
+        float startX, startY;
+        int firstOnCurve = -1;
+        for (int i = contourStart; i <= contourEnd; i++) {
+            if (outline->tags[i] & 1) { firstOnCurve = i; break; }
+        }
+
+        if (firstOnCurve >= 0) {
+            startX = (float)outline->points[firstOnCurve].x;
+            startY = (float)outline->points[firstOnCurve].y;
+        } else {
+            startX = (outline->points[contourStart].x + outline->points[contourStart + 1].x) * 0.5f;
+            startY = (outline->points[contourStart].y + outline->points[contourStart + 1].y) * 0.5f;
+            firstOnCurve = contourStart;
+        }
+
+        float penX = startX, penY = startY;
+        int ii = firstOnCurve;
+
+        for (int j = 0; j < numPoints; j++) {
+            int idx = contourStart + ((ii - contourStart + 1) % numPoints);
+            float px = (float)outline->points[idx].x;
+            float py = (float)outline->points[idx].y;
+            char tag = outline->tags[idx];
+
+            if (tag & 1) {
+                float mx = (penX + px) * 0.5f;
+                float my = (penY + py) * 0.5f;
+                EMIT_SEG(penX, penY, mx, my, px, py);
+                penX = px; penY = py;
+            } else if (tag & 2) {
+                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
+                int idx3 = contourStart + ((idx - contourStart + 2) % numPoints);
+                float p1x = px, p1y = py;
+                float p2x = (float)outline->points[idx2].x, p2y = (float)outline->points[idx2].y;
+                float p3x = (float)outline->points[idx3].x, p3y = (float)outline->points[idx3].y;
+
+                if (!emit_cubic_as_quads(penX, penY, p1x, p1y, p2x, p2y, p3x, p3y,
+                                          tolerance_sq, &curveIdx, maxCurves,
+                                          outCurves, outTypes))
+                    return -2;
+
+                penX = p3x; penY = p3y;
+                j += 2;
+                ii = idx3;
+                continue;
+            } else {
+                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
+                float p2x = (float)outline->points[idx2].x;
+                float p2y = (float)outline->points[idx2].y;
+                char tag2 = outline->tags[idx2];
+
+                float endX, endY;
+                if (tag2 & 1) {
+                    endX = p2x; endY = p2y;
+                    EMIT_SEG(penX, penY, px, py, endX, endY);
+                    penX = endX; penY = endY;
+                    j++;
+                    ii = idx2;
+                    continue;
+                } else {
+                    endX = (px + p2x) * 0.5f;
+                    endY = (py + p2y) * 0.5f;
+                    EMIT_SEG(penX, penY, px, py, endX, endY);
+                    penX = endX; penY = endY;
+                }
+            }
+            ii = idx;
+        }
+
+        if (penX != startX || penY != startY) {
+            float mx = (penX + startX) * 0.5f;
+            float my = (penY + startY) * 0.5f;
+            EMIT_SEG(penX, penY, mx, my, startX, startY);
+        }
+
+        if (curveIdx > contourCurveStart) {
+            if (contourIdx >= maxContours) return -3;
+            outContours[contourIdx++] = curveIdx - 1;
+        }
+
+        contourStart = contourEnd + 1;
+    }
+
+    #undef EMIT_SEG
+
+    *outCurveCount = curveIdx;
+    *outContourCount = contourIdx;
+    return 0;
+}
+
+// outline_to_quads into ws, growing the curve budget until the walker fits.
+static int outline_to_quads_grow(const FT_Outline* outline, float tolerance_sq, ut_sdf_workspace* ws,
+                                 float** out_curves, int* out_curve_count,
+                                 int** out_contours, int* out_contour_count) {
+    int max_curves = outline->n_points * 2 + 16;
+    int max_contours = outline->n_contours > 0 ? outline->n_contours : 1;
+    for (;;) {
+        size_t osize = (size_t)max_curves * (8 * sizeof(float) + sizeof(int)) + (size_t)max_contours * sizeof(int);
+        char* obuf = sdf_workspace_reserve(ws, osize);
+        if (!obuf) return -1;
+        float* curves = (float*)obuf;
+        int* types = (int*)(curves + (size_t)max_curves * 8);
+        int* contours = types + max_curves;
+        int rc = outline_to_quads(outline, tolerance_sq, curves, types, out_curve_count, max_curves,
+                                  contours, out_contour_count, max_contours);
+        if (rc == 0) {
+            *out_curves = curves;
+            *out_contours = contours;
+            return 0;
+        }
+        if (rc != -2 || max_curves > (1 << 24)) return rc;
+        max_curves *= 2;
+    }
+}
+
+UNITEXT_EXPORT int ut_ft_outline_decompose(FT_Face face, unsigned int glyph_index,
+                                            float* outCurves, int* outTypes,
+                                            int* outCurveCount, int maxCurves,
+                                            int* outContours, int* outContourCount, int maxContours,
+                                            int* outBearingX, int* outBearingY,
+                                            int* outAdvanceX, int* outWidth, int* outHeight)
+{
+    if (!face || !outCurves || !outTypes || !outCurveCount || !outContours || !outContourCount)
+        return -1;
+
+    const FT_Outline* outline;
+    const FT_Glyph_Metrics* m;
+    bool is_outline;
+    int err = outline_load_unscaled(face, glyph_index, &outline, &m, &is_outline);
+    if (err) return err;
+
+    if (!is_outline) {
+        *outCurveCount = 0;
+        *outContourCount = 0;
+        return 0;
+    }
+
+    if (outBearingX) *outBearingX = (int)(m->horiBearingX);
+    if (outBearingY) *outBearingY = (int)(m->horiBearingY);
+    if (outAdvanceX) *outAdvanceX = (int)(m->horiAdvance);
+    if (outWidth)    *outWidth    = (int)(m->width);
+    if (outHeight)   *outHeight   = (int)(m->height);
+
+    if (outline->n_points <= 0 || outline->n_contours <= 0) {
+        *outCurveCount = 0;
+        *outContourCount = 0;
+        return 0;
+    }
+
+    // tolerance ≈ em / 1024 design units: sub-pixel even at 256-px SDF tiles
+    // (em/256 design units per pixel → tolerance is ~1/4 pixel of the tile).
+    float em = (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
+    float tolerance = em * (1.0f / 1024.0f);
+    float tolerance_sq = tolerance * tolerance;
+
+    return outline_to_quads(outline, tolerance_sq, outCurves, outTypes, outCurveCount, maxCurves,
+                            outContours, outContourCount, maxContours);
+}
+
+// --- Level of detail ---
+//
+// Small sizes do not need em/1024 accuracy. Level L keeps the outline within
+// em/1024 × 4^L design units (level 0 is ut_ft_outline_decompose unchanged):
+// cubics are split at half that tolerance, then each contour is simplified
+// greedily within the other half — a run of consecutive curves collapses to
+// one line, or to one quadratic whose control point is where the run's end
+// tangents meet, when every sample of the run lies near it and vice versa.
+// Contours no larger than the tolerance (sub-pixel dots, slivers) are
+// dropped. ut_outline_lod_for_pixel_size picks the coarsest level that stays
+// within 1/8 px at a given em size.
+
+#include <float.h>
+
+#define UT_OUTLINE_LOD_LEVELS 4
+#define OUTLINE_LOD_MAX_RUN   32   // curves merged into one, at most
+#define OUTLINE_LOD_MAX_STEPS 16   // polyline segments per sampled curve
+
+static float outline_lod_tolerance(FT_Face face, int lod) {
+    float em = (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
+    return em * (1.0f / 1024.0f) * (float)(1 << (2 * lod));
+}
+
+// Flattens quadratic q (6 floats) into steps segments, chord error ≲ tol / 4.
+// Writes steps + 1 points (xy pairs) to pts and returns steps.
+static int lod_flatten(const float* q, float tol, float* pts) {
+    float ddx = q[0] - 2.0f * q[2] + q[4], ddy = q[1] - 2.0f * q[3] + q[5];
+    int steps = (int)ceilf(sqrtf(sqrtf(ddx * ddx + ddy * ddy) / tol));
+    steps = steps < 1 ? 1 : (steps > OUTLINE_LOD_MAX_STEPS ? OUTLINE_LOD_MAX_STEPS : steps);
+    for (int i = 0; i <= steps; i++) {
+        float t = (float)i / (float)steps, mt = 1.0f - t;
+        pts[i * 2]     = mt * mt * q[0] + 2.0f * mt * t * q[2] + t * t * q[4];
+        pts[i * 2 + 1] = mt * mt * q[1] + 2.0f * mt * t * q[3] + t * t * q[5];
+    }
+    return steps;
+}
+
+static float lod_polyline_dist_sq(const float* pts, int segments, float px, float py) {
+    float best = FLT_MAX;
+    for (int i = 0; i < segments; i++) {
+        float ax = pts[i * 2], ay = pts[i * 2 + 1];
+        float dx = pts[i * 2 + 2] - ax, dy = pts[i * 2 + 3] - ay;
+        float len_sq = dx * dx + dy * dy;
+        float t = len_sq > 0.0f ? ((px - ax) * dx + (py - ay) * dy) / len_sq : 0.0f;
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        float ex = ax + dx * t - px, ey = ay + dy * t - py;
+        float d = ex * ex + ey * ey;
+        if (d < best) best = d;
+    }
+    return best;
+}
+
+// True when candidate quadratic cand (6 floats) stays within tol of
+// curves[first..last] and they of it, sampled both ways.
+static bool lod_fits(const float* curves, int first, int last, const float* cand, float tol) {
+    float run_pts[(OUTLINE_LOD_MAX_RUN * OUTLINE_LOD_MAX_STEPS + 1) * 2];
+    float cand_pts[(OUTLINE_LOD_MAX_STEPS + 1) * 2];
+    int run_segments = 0;
+    for (int i = first; i <= last; i++)
+        run_segments += lod_flatten(curves + (size_t)i * 8, tol, run_pts + run_segments * 2);
+    int cand_segments = lod_flatten(cand, tol, cand_pts);
+
+    float tol_sq = tol * tol;
+    for (int i = 1; i < cand_segments; i++)
+        if (lod_polyline_dist_sq(run_pts, run_segments, cand_pts[i * 2], cand_pts[i * 2 + 1]) > tol_sq)
+            return false;
+    for (int i = 1; i < run_segments; i++)
+        if (lod_polyline_dist_sq(cand_pts, cand_segments, run_pts[i * 2], run_pts[i * 2 + 1]) > tol_sq)
+            return false;
+    return true;
+}
+
+// Single curve for curves[first..last]: a line when that fits, else the
+// quadratic through the run's end tangents. False when neither fits.
+static bool lod_merge(const float* curves, int first, int last, float tol, float* out) {
+    const float* a = curves + (size_t)first * 8;
+    const float* b = curves + (size_t)last * 8;
+    float x0 = a[0], y0 = a[1], x1 = b[4], y1 = b[5];
+    out[0] = x0; out[1] = y0; out[4] = x1; out[5] = y1;
+    out[2] = (x0 + x1) * 0.5f;
+    out[3] = (y0 + y1) * 0.5f;
+    if (lod_fits(curves, first, last, out, tol)) return true;
+
+    // Tangents at the run's ends (the chord when a control point is degenerate).
+    float d0x = a[2] - x0, d0y = a[3] - y0;
+    if (d0x * d0x + d0y * d0y < 1e-12f) { d0x = a[4] - x0; d0y = a[5] - y0; }
+    float d1x = x1 - b[2], d1y = y1 - b[3];
+    if (d1x * d1x + d1y * d1y < 1e-12f) { d1x = x1 - b[0]; d1y = y1 - b[1]; }
+    float den = d0x * d1y - d0y * d1x;
+    if (fabsf(den) < 1e-12f) return false;
+    float ex = x1 - x0, ey = y1 - y0;
+    float s = (ex * d1y - ey * d1x) / den;
+    float u = (ex * d0y - ey * d0x) / den;
+    if (s <= 0.0f || u <= 0.0f) return false;
+    out[2] = x0 + d0x * s;
+    out[3] = y0 + d0y * s;
+    return lod_fits(curves, first, last, out, tol);
+}
+
+// Simplifies decomposed curves in place (see above). Contour ends are
+// rewritten to the shortened list; counts shrink, never grow. types may be NULL.
+static void outline_lod_simplify(float* curves, int* types, int* curve_count,
+                                 int* contours, int* contour_count, float tol) {
+    int out_curves = 0, out_contours = 0;
+    int first = 0;
+    for (int c = 0; c < *contour_count; c++) {
+        int last = contours[c];
+
+        float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+        for (int i = first; i <= last; i++) {
+            const float* q = curves + (size_t)i * 8;
+            for (int k = 0; k < 6; k += 2) {
+                min_x = fminf(min_x, q[k]);     max_x = fmaxf(max_x, q[k]);
+                min_y = fminf(min_y, q[k + 1]); max_y = fmaxf(max_y, q[k + 1]);
+            }
+        }
+        if (max_x - min_x <= 2.0f * tol && max_y - min_y <= 2.0f * tol) {
+            first = last + 1;
+            continue;
+        }
+
+        // Writes trail reads (out_curves <= i), so merging in place is safe.
+        for (int i = first; i <= last;) {
+            float merged[6], best[6];
+            memcpy(best, curves + (size_t)i * 8, sizeof(best));
+            int j = i;
+            while (j < last && j + 1 - i < OUTLINE_LOD_MAX_RUN && lod_merge(curves, i, j + 1, tol, merged)) {
+                memcpy(best, merged, sizeof(best));
+                j++;
+            }
+            float* dst = curves + (size_t)out_curves * 8;
+            memcpy(dst, best, sizeof(best));
+            dst[6] = 0;
+            dst[7] = 0;
+            if (types) types[out_curves] = 2;
+            out_curves++;
+            i = j + 1;
+        }
+        contours[out_contours++] = out_curves - 1;
+        first = last + 1;
+    }
+    *curve_count = out_curves;
+    *contour_count = out_contours;
+}
+
+// Coarsest LOD level within 1/8 px for glyphs drawn at pixel_size px per em.
+UNITEXT_EXPORT int ut_outline_lod_for_pixel_size(float pixel_size) {
+    int lod = 0;
+    while (lod + 1 < UT_OUTLINE_LOD_LEVELS && pixel_size * (float)(1 << (2 * (lod + 1))) <= 128.0f) lod++;
+    return lod;
+}
+
+// ut_ft_outline_decompose at LOD level lod (0..UT_OUTLINE_LOD_LEVELS-1, see
+// above); buffers sized for level 0 always suffice. Returns -1 for an
+// out-of-range level.
+UNITEXT_EXPORT int ut_ft_outline_decompose_lod(FT_Face face, unsigned int glyph_index, int lod,
+                                                float* outCurves, int* outTypes,
+                                                int* outCurveCount, int maxCurves,
+                                                int* outContours, int* outContourCount, int maxContours,
+                                                int* outBearingX, int* outBearingY,
+                                                int* outAdvanceX, int* outWidth, int* outHeight)
+{
+    if (!face || lod < 0 || lod >= UT_OUTLINE_LOD_LEVELS) return -1;
+    if (lod == 0)
+        return ut_ft_outline_decompose(face, glyph_index, outCurves, outTypes, outCurveCount, maxCurves,
+                                       outContours, outContourCount, maxContours,
+                                       outBearingX, outBearingY, outAdvanceX, outWidth, outHeight);
+    if (!outCurves || !outTypes || !outCurveCount || !outContours || !outContourCount) return -1;
+
+    const FT_Outline* outline;
+    const FT_Glyph_Metrics* m;
+    bool is_outline;
+    int err = outline_load_unscaled(face, glyph_index, &outline, &m, &is_outline);
+    if (err) return err;
+    *outCurveCount = 0;
+    *outContourCount = 0;
+    if (!is_outline) return 0;
+
+    if (outBearingX) *outBearingX = (int)(m->horiBearingX);
+    if (outBearingY) *outBearingY = (int)(m->horiBearingY);
+    if (outAdvanceX) *outAdvanceX = (int)(m->horiAdvance);
+    if (outWidth)    *outWidth    = (int)(m->width);
+    if (outHeight)   *outHeight   = (int)(m->height);
+    if (outline->n_points <= 0 || outline->n_contours <= 0) return 0;
+
+    float half = outline_lod_tolerance(face, lod) * 0.5f;
+    int rc = outline_to_quads(outline, half * half, outCurves, outTypes, outCurveCount, maxCurves,
+                              outContours, outContourCount, maxContours);
+    if (rc) return rc;
+    outline_lod_simplify(outCurves, outTypes, outCurveCount, outContours, outContourCount, half);
+    return 0;
+}
+
+// --- Packed curves: 12 bytes per quadratic ---
+//
+// The float layout above spends 36 bytes per curve (8 floats, two always 0,
+// plus a type that is always 2). The packed layout stores 6 × 16-bit values
+// (p0.x, p0.y, ctrl.x, ctrl.y, p2.x, p2.y) scaled by a per-font factor:
+// - UT_CURVE_FORMAT_I16:  int16 round(v × scale); scale = 2^shift, the
+//   largest (≤ 16) that keeps twice the face's bbox in range — 1/4..1/8 unit
+//   for typical em sizes.
+// - UT_CURVE_FORMAT_HALF: half-float v × scale; scale = 1 / units_per_EM.
+// Bit 0 of ctrl.x flags the last curve of a contour (decoders mask it off;
+// it costs ctrl.x one quantum / one half ulp), so no contour array is needed.
+
+#define UT_CURVE_FORMAT_I16  1
+#define UT_CURVE_FORMAT_HALF 2
+
+// Packs curves (8-float layout) into out (6 × uint16 per curve). contour_ends
+// are the last curve index of each contour, as from the decomposers.
+// Returns 0, -1 on bad args, or -4 when an I16 value falls outside int16.
+UNITEXT_EXPORT int ut_curves_pack(const float* curves, int curve_count,
+                                  const int* contour_ends, int contour_count,
+                                  int format, float scale, uint16_t* out) {
+    if (curve_count < 0 || (curve_count > 0 && (!curves || !out))) return -1;
+    if (contour_count > 0 && !contour_ends) return -1;
+    if (format != UT_CURVE_FORMAT_I16 && format != UT_CURVE_FORMAT_HALF) return -1;
+
+    int next_end = 0;
+    for (int i = 0; i < curve_count; i++) {
+        const float* c = curves + (size_t)i * 8;
+        uint16_t* dst = out + (size_t)i * 6;
+        for (int k = 0; k < 6; k++) {
+            float v = c[k] * scale;
+            if (format == UT_CURVE_FORMAT_HALF) {
+                dst[k] = sdf_float_to_half(v);
+            } else {
+                long q = lrintf(v);
+                if (q < -32768 || q > 32767) return -4;
+                dst[k] = (uint16_t)(int16_t)q;
+            }
+        }
+        while (next_end < contour_count && contour_ends[next_end] < i) next_end++;
+        bool end = next_end < contour_count && contour_ends[next_end] == i;
+        dst[2] = (uint16_t)((dst[2] & ~1u) | (end ? 1u : 0u));
+    }
+    return 0;
+}
+
+// Scale ut_ft_outline_decompose_packed applies for a face and format
+// (0 for an unknown format).
+UNITEXT_EXPORT float ut_ft_curve_pack_scale(FT_Face face, int format) {
+    if (!face) return 0.0f;
+    if (format == UT_CURVE_FORMAT_HALF)
+        return 1.0f / (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
+    if (format != UT_CURVE_FORMAT_I16) return 0.0f;
+    long extent = 1;
+    const FT_BBox* b = &face->bbox;
+    FT_Pos edges[4] = { b->xMin, b->yMin, b->xMax, b->yMax };
+    for (int i = 0; i < 4; i++) {
+        long a = edges[i] < 0 ? -(long)edges[i] : (long)edges[i];
+        if (a > extent) extent = a;
+    }
+    // 2× headroom: approximated cubics may place controls outside the bbox.
+    int shift = 0;
+    while (shift < 16 && (extent << (shift + 1)) <= 16383) shift++;
+    return (float)(1 << shift);
+}
+
+// ut_ft_outline_decompose in a packed format: *outCurveCount curves of 6 ×
+// uint16 in outCurves, contour ends flagged in place. Returns -2 when
+// maxCurves is too small (*outCurveCount then holds the count needed, so the
+// caller can grow outCurves and retry), -4 when a coordinate falls outside
+// the font bbox range (I16), else as ut_ft_outline_decompose.
+UNITEXT_EXPORT int ut_ft_outline_decompose_packed(FT_Face face, unsigned int glyph_index, int format,
+                                                   uint16_t* outCurves, int* outCurveCount, int maxCurves,
+                                                   int* outBearingX, int* outBearingY,
+                                                   int* outAdvanceX, int* outWidth, int* outHeight)
+{
+    sdf_workspace_scope workspace_scope;
+    if (!face || !outCurves || !outCurveCount) return -1;
+    float scale = ut_ft_curve_pack_scale(face, format);
+    if (scale == 0.0f) return -1;
+    *outCurveCount = 0;
+
+    const FT_Outline* outline;
+    const FT_Glyph_Metrics* m;
+    bool is_outline;
+    int err = outline_load_unscaled(face, glyph_index, &outline, &m, &is_outline);
+    if (err) return err;
+    if (!is_outline) return 0;
+
+    if (outBearingX) *outBearingX = (int)(m->horiBearingX);
+    if (outBearingY) *outBearingY = (int)(m->horiBearingY);
+    if (outAdvanceX) *outAdvanceX = (int)(m->horiAdvance);
+    if (outWidth)    *outWidth    = (int)(m->width);
+    if (outHeight)   *outHeight   = (int)(m->height);
+
+    if (outline->n_points <= 0 || outline->n_contours <= 0) return 0;
+
+    float em = (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
+    float tolerance = em * (1.0f / 1024.0f);
+    float* curves;
+    int* contours;
+    int curve_count, contour_count;
+    int rc = outline_to_quads_grow(outline, tolerance * tolerance, &t_sdf_outline_workspace,
+                                   &curves, &curve_count, &contours, &contour_count);
+    if (rc) return rc;
+    if (curve_count > maxCurves) {
+        *outCurveCount = curve_count;
+        return -2;
+    }
+
+    rc = ut_curves_pack(curves, curve_count, contours, contour_count, format, scale, outCurves);
+    if (rc) return rc;
+    *outCurveCount = curve_count;
+    return 0;
+}
+
+// =============================================================================
+// Curve Atlas — batch outline decompose with per-glyph band index
+// =============================================================================
+//
+// Decomposes a glyph set (design units, same walker and tolerance as
+// ut_ft_outline_decompose) into one contiguous curve buffer, so callers no
+// longer guess capacities per glyph. Each glyph also gets a band index for
+// rendering straight from curves on the GPU: its curve bbox is cut into
+// `bands` horizontal and `bands` vertical strips, and each strip lists the
+// curves whose control hull overlaps it. A fragment then only tests the curves
+// of its own row (horizontal ray, coverage/winding) and column (vertical ray).
+// Horizontal-band lists are sorted by descending max x and vertical ones by
+// descending max y, so a ray cast toward +x / +y can stop at the first curve
+// that lies entirely behind the sample.
+//
+// Everything lives in one malloc'd block, released by ut_curve_atlas_free:
+//   curves    curve_count × 8 floats (p0, ctrl, p2, 0, 0) — two float4 per curve
+//   contours  per glyph, glyph-relative last curve index of each contour
+//   bands     per glyph, hband_count then vband_count {ref offset, ref count}
+//   band_refs absolute curve indices into curves
+
+typedef struct {
+    int error;              // 0 = ok, else FreeType error (glyph left empty)
+    int curve_offset;       // into curves (in curves, not floats)
+    int curve_count;
+    int contour_offset;     // into contours
+    int contour_count;
+    int band_offset;        // into bands (in bands, not ints)
+    int hband_count;        // horizontal strips (split y), bottom to top
+    int vband_count;        // vertical strips (split x), left to right
+    float min_x, min_y;     // curve bbox the strips divide
+    float max_x, max_y;
+    int bearing_x, bearing_y, advance_x, width, height;   // design units
+} ut_curve_atlas_glyph;
+
+typedef struct {
+    int glyph_count;
+    int curve_count;
+    int contour_count;
+    int band_count;
+    int band_ref_count;
+    ut_curve_atlas_glyph* glyphs;
+    float* curves;
+    int* contours;
+    int* bands;
+    int* band_refs;
+} ut_curve_atlas;
+
+#define CURVE_ATLAS_MAX_BANDS 64
+
+// Grows a malloc'd array to hold at least `need` elements.
+static bool curve_atlas_reserve(void** p, size_t* cap, size_t need, size_t elem) {
+    if (need <= *cap) return true;
+    size_t grown = *cap ? *cap * 2 : 256;
+    if (grown < need) grown = need;
+    void* q = realloc(*p, grown * elem);
+    if (!q) return false;
+    *p = q;
+    *cap = grown;
+    return true;
+}
+
+// Curves of one glyph overlapping [lo, hi] on axis (0 = x, 1 = y), appended
+// to refs sorted by descending max on the other axis. Returns the count.
+static int curve_atlas_band(const float* curves, int first, int count, int axis, float lo, float hi,
+                            int* refs, float* keys) {
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        const float* c = curves + (size_t)(first + i) * 8;
+        float a = fminf(fminf(c[axis], c[axis + 2]), c[axis + 4]);
+        float b = fmaxf(fmaxf(c[axis], c[axis + 2]), c[axis + 4]);
+        if (b < lo || a > hi) continue;
+        int o = axis ^ 1;
+        float key = fmaxf(fmaxf(c[o], c[o + 2]), c[o + 4]);
+        int j = n++;
+        while (j > 0 && keys[j - 1] < key) {
+            refs[j] = refs[j - 1];
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        refs[j] = first + i;
+        keys[j] = key;
+    }
+    return n;
+}
+
+// Decomposes glyph_indices[count] at LOD level lod (see ut_ft_outline_decompose_lod;
+// one atlas per level) into a new atlas with `bands` strips per axis (clamped to
+// 1..64 and to the glyph's curve count). *out_atlas is set whenever the return
+// is not -1; glyphs that failed to load are left empty with their error
+// recorded. Returns 0, -1 on bad args / OOM, else the first FreeType error.
+UNITEXT_EXPORT int ut_ft_outline_decompose_batch_lod(FT_Face face, const unsigned int* glyph_indices, int count,
+                                                      int bands, int lod, ut_curve_atlas** out_atlas) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_atlas) return -1;
+    *out_atlas = nullptr;
+    if (!face || !glyph_indices || count < 0 || lod < 0 || lod >= UT_OUTLINE_LOD_LEVELS) return -1;
+    if (bands < 1) bands = 1;
+    if (bands > CURVE_ATLAS_MAX_BANDS) bands = CURVE_ATLAS_MAX_BANDS;
+
+    // Level 0 flattens cubics at the full tolerance; coarser levels split it
+    // between flattening and simplification.
+    float tolerance = outline_lod_tolerance(face, lod) * (lod ? 0.5f : 1.0f);
+
+    ut_curve_atlas_glyph* glyphs = (ut_curve_atlas_glyph*)calloc(count > 0 ? count : 1, sizeof(ut_curve_atlas_glyph));
+    float* curves = nullptr;
+    int* contours = nullptr;
+    int* band_list = nullptr;
+    int* refs = nullptr;
+    float* keys = nullptr;
+    size_t curve_cap = 0, contour_cap = 0, band_cap = 0, ref_cap = 0, key_cap = 0;
+    size_t curve_total = 0, contour_total = 0, band_total = 0, ref_total = 0;
+    int first_error = 0;
+    bool oom = !glyphs;
+
+    for (int g = 0; g < count && !oom; g++) {
+        ut_curve_atlas_glyph* ag = &glyphs[g];
+        ag->curve_offset = (int)curve_total;
+        ag->contour_offset = (int)contour_total;
+        ag->band_offset = (int)band_total;
+
+        const FT_Outline* outline;
+        const FT_Glyph_Metrics* m;
+        bool is_outline;
+        int err = outline_load_unscaled(face, glyph_indices[g], &outline, &m, &is_outline);
+        if (err) {
+            ag->error = err;
+            if (!first_error) first_error = err;
+            continue;
+        }
+        ag->bearing_x = (int)m->horiBearingX;
+        ag->bearing_y = (int)m->horiBearingY;
+        ag->advance_x = (int)m->horiAdvance;
+        ag->width     = (int)m->width;
+        ag->height    = (int)m->height;
+
+        if (!is_outline || outline->n_points <= 0 || outline->n_contours <= 0)
+            continue;
+
+        float* gc;
+        int* gk;
+        int nc, nk;
+        int rc = outline_to_quads_grow(outline, tolerance * tolerance, &t_sdf_outline_workspace, &gc, &nc, &gk, &nk);
+        if (rc) {
+            ag->error = rc;
+            if (!first_error) first_error = rc;
+            if (rc == -1) oom = true;
+            continue;
+        }
+        if (lod) outline_lod_simplify(gc, nullptr, &nc, gk, &nk, tolerance);
+        if (nc == 0) continue;
+
+        int nb = bands < nc ? bands : nc;
+        if (!curve_atlas_reserve((void**)&curves, &curve_cap, curve_total + nc, 8 * sizeof(float))
+            || !curve_atlas_reserve((void**)&contours, &contour_cap, contour_total + nk, sizeof(int))
+            || !curve_atlas_reserve((void**)&band_list, &band_cap, band_total + (size_t)nb * 2, 2 * sizeof(int))
+            || !curve_atlas_reserve((void**)&refs, &ref_cap, ref_total + (size_t)nc * nb * 2, sizeof(int))
+            || !curve_atlas_reserve((void**)&keys, &key_cap, (size_t)nc, sizeof(float))) {
+            oom = true;
+            break;
+        }
+        memcpy(curves + curve_total * 8, gc, (size_t)nc * 8 * sizeof(float));
+        memcpy(contours + contour_total, gk, (size_t)nk * sizeof(int));
+
+        float min_x = gc[0], max_x = gc[0], min_y = gc[1], max_y = gc[1];
+        for (int i = 0; i < nc; i++) {
+            const float* c = gc + (size_t)i * 8;
+            for (int k = 0; k < 6; k += 2) {
+                min_x = fminf(min_x, c[k]);     max_x = fmaxf(max_x, c[k]);
+                min_y = fminf(min_y, c[k + 1]); max_y = fmaxf(max_y, c[k + 1]);
+            }
+        }
+        ag->min_x = min_x; ag->min_y = min_y;
+        ag->max_x = max_x; ag->max_y = max_y;
+
+        // Strips tile the bbox exactly; each is matched inclusively, so a
+        // curve ending on a boundary is listed in both neighbours.
+        for (int axis = 1; axis >= 0; axis--) {
+            float lo = axis ? min_y : min_x;
+            float step = ((axis ? max_y : max_x) - lo) / (float)nb;
+            for (int b = 0; b < nb; b++) {
+                int n = curve_atlas_band(curves, (int)curve_total, nc, axis, lo + step * b, lo + step * (b + 1),
+                                         refs + ref_total, keys);
+                band_list[band_total * 2]     = (int)ref_total;
+                band_list[band_total * 2 + 1] = n;
+                band_total++;
+                ref_total += n;
+            }
+        }
+
+        ag->curve_count   = nc;
+        ag->contour_count = nk;
+        ag->hband_count   = nb;
+        ag->vband_count   = nb;
+        curve_total   += nc;
+        contour_total += nk;
+    }
+
+    ut_curve_atlas* atlas = nullptr;
+    if (!oom) {
+        size_t size = sizeof(ut_curve_atlas)
+                    + (size_t)count * sizeof(ut_curve_atlas_glyph)
+                    + curve_total * 8 * sizeof(float)
+                    + contour_total * sizeof(int)
+                    + band_total * 2 * sizeof(int)
+                    + ref_total * sizeof(int);
+        atlas = (ut_curve_atlas*)malloc(size);
+        if (atlas) {
+            atlas->glyph_count    = count;
+            atlas->curve_count    = (int)curve_total;
+            atlas->contour_count  = (int)contour_total;
+            atlas->band_count     = (int)band_total;
+            atlas->band_ref_count = (int)ref_total;
+            atlas->glyphs    = (ut_curve_atlas_glyph*)(atlas + 1);
+            atlas->curves    = (float*)(atlas->glyphs + count);
+            atlas->contours  = (int*)(atlas->curves + curve_total * 8);
+            atlas->bands     = atlas->contours + contour_total;
+            atlas->band_refs = atlas->bands + band_total * 2;
+            memcpy(atlas->glyphs, glyphs, (size_t)count * sizeof(ut_curve_atlas_glyph));
+            if (curve_total) memcpy(atlas->curves, curves, curve_total * 8 * sizeof(float));
+            if (contour_total) memcpy(atlas->contours, contours, contour_total * sizeof(int));
+            if (band_total) memcpy(atlas->bands, band_list, band_total * 2 * sizeof(int));
+            if (ref_total) memcpy(atlas->band_refs, refs, ref_total * sizeof(int));
+        }
+    }
+
+    free(glyphs);
+    free(curves);
+    free(contours);
+    free(band_list);
+    free(refs);
+    free(keys);
+    if (!atlas) return -1;
+    *out_atlas = atlas;
+    return first_error;
+}
+
+// Full-detail atlas (LOD level 0).
+UNITEXT_EXPORT int ut_ft_outline_decompose_batch(FT_Face face, const unsigned int* glyph_indices, int count,
+                                                  int bands, ut_curve_atlas** out_atlas) {
+    return ut_ft_outline_decompose_batch_lod(face, glyph_indices, count, bands, 0, out_atlas);
+}
+
+UNITEXT_EXPORT void ut_curve_atlas_free(ut_curve_atlas* atlas) {
+    free(atlas);
+}
+
+// =============================================================================
+// Analytic SDF Glyph Render — exact distance to the quadratic outline
+// =============================================================================
+//
+// Instead of recovering distance from an anti-aliased coverage bitmap, walks the
+// scaled outline into quadratics (outline_to_quads, same walker as
+// ut_ft_outline_decompose) and computes the exact Euclidean distance per texel:
+// - Lines → projection onto the segment
+// - Quadratics → roots of the cubic d/dt |B(t) - p|² = 0 (plus endpoints)
+// - Sign → non-zero (or even-odd, per outline flags) winding of the texel row's
+//   scanline, from crossings with y-monotone curve pieces
+//
+// Acceleration: curves are binned into SDF_ANALYTIC_CELL² texel cells by their
+// control-hull bbox grown by the spread (distances ≥ spread saturate to 0/255,
+// so nothing farther can matter). Each cell's list is then pruned against an
+// upper bound on its texels' nearest distance and sorted by lower bound, so a
+// texel typically evaluates ~1 curve exactly — cost stays ~O(pixels × local
+// curves). Slower per texel than the EDT path, but ~10× more accurate, which
+// lets the same edge quality ship with a smaller spread and tile.
+//
+// Output matches ut_ft_render_sdf_glyph: Alpha8, 128 = edge, inside > 128,
+// padded by spread, bottom-up rows; bitmap bounds follow FreeType's AA bitmap
+// (outline cbox floored/ceiled to whole pixels).
+
+#define SDF_ANALYTIC_CELL 8
+
+struct sdf_quad {
+    float p0x, p0y;                 // B(t) = P0 + 2tA + t²B
+    float ax, ay;                   // A = P1 - P0
+    float bx, by;                   // B = P2 - 2·P1 + P0
+    float bb;                       // B·B
+    float inv_len_sq;               // line: 1 / |P2 - P0|² (0 for a point)
+    float minx, miny, maxx, maxy;   // control-hull bbox
+    int line;                       // B ≈ 0 → exact segment P0 → P2
+};
+
+struct sdf_ymono {                  // y-monotone quadratic piece (scanline winding)
+    float x0, y0, x1, y1, x2, y2;
+    float ylo, yhi;
+    int dir;                        // +1 upward, -1 downward
+};
+
+struct sdf_crossing {
+    float x;
+    int dir;
+};
+
+static void sdf_quad_init(sdf_quad* q, float x0, float y0, float cx, float cy, float x2, float y2) {
+    q->p0x = x0; q->p0y = y0;
+    q->ax = cx - x0; q->ay = cy - y0;
+    q->bx = x2 - 2.0f * cx + x0; q->by = y2 - 2.0f * cy + y0;
+    q->bb = q->bx * q->bx + q->by * q->by;
+    float aa = q->ax * q->ax + q->ay * q->ay;
+    // Decomposed lines carry control = midpoint, so B is ~0 up to rounding.
+    q->line = q->bb <= aa * 1e-8f;
+    float dx = x2 - x0, dy = y2 - y0;
+    float len_sq = dx * dx + dy * dy;
+    q->inv_len_sq = len_sq > 0.0f ? 1.0f / len_sq : 0.0f;
+    q->minx = fminf(x0, fminf(cx, x2)); q->maxx = fmaxf(x0, fmaxf(cx, x2));
+    q->miny = fminf(y0, fminf(cy, y2)); q->maxy = fmaxf(y0, fmaxf(cy, y2));
+}
+
+// Real roots of t³ + a·t² + b·t + c = 0.
+static int sdf_solve_cubic_normed(double a, double b, double c, double* r) {
+    double a2 = a * a;
+    double q = (a2 - 3.0 * b) / 9.0;
+    double rr = (a * (2.0 * a2 - 9.0 * b) + 27.0 * c) / 54.0;
+    double r2 = rr * rr;
+    double q3 = q * q * q;
+    a /= 3.0;
+    if (r2 < q3) {
+        double t = rr / sqrt(q3);
+        t = t < -1.0 ? -1.0 : (t > 1.0 ? 1.0 : t);
+        t = acos(t) / 3.0;
+        // cos(t ± 2π/3) = -cos(t)/2 ∓ sin(t)·√3/2 — one cos/sin pair instead of three cos.
+        double ct = cos(t), st = sin(t) * 0.86602540378443865;
+        double m = -2.0 * sqrt(q);
+        r[0] = m * ct - a;
+        r[1] = m * (-0.5 * ct - st) - a;
+        r[2] = m * (-0.5 * ct + st) - a;
+        return 3;
+    }
+    double u = -(rr < 0.0 ? -1.0 : 1.0) * cbrt(fabs(rr) + sqrt(r2 - q3));
+    double v = u == 0.0 ? 0.0 : q / u;
+    r[0] = (u + v) - a;
+    return 1;
+}
+
+static float sdf_quad_dist_sq(const sdf_quad* q, float px, float py) {
+    float mx = q->p0x - px, my = q->p0y - py;
+    if (q->line) {
+        float dx = 2.0f * q->ax + q->bx, dy = 2.0f * q->ay + q->by;
+        float t = -(mx * dx + my * dy) * q->inv_len_sq;
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        float ex = mx + t * dx, ey = my + t * dy;
+        return ex * ex + ey * ey;
+    }
+
+    // Endpoints first, then interior stationary points of |B(t) - p|².
+    float ex2 = mx + 2.0f * q->ax + q->bx, ey2 = my + 2.0f * q->ay + q->by;
+    float best = fminf(mx * mx + my * my, ex2 * ex2 + ey2 * ey2);
+
+    double inv_a = 1.0 / (double)q->bb;
+    double b = 3.0 * ((double)q->ax * q->bx + (double)q->ay * q->by) * inv_a;
+    double c = (2.0 * ((double)q->ax * q->ax + (double)q->ay * q->ay) + (double)mx * q->bx + (double)my * q->by) * inv_a;
+    double d = ((double)mx * q->ax + (double)my * q->ay) * inv_a;
+    double roots[3];
+    int n = sdf_solve_cubic_normed(b, c, d, roots);
+    for (int i = 0; i < n; i++) {
+        double t = roots[i];
+        if (t <= 0.0 || t >= 1.0) continue;
+        double ex = mx + t * (2.0 * q->ax + t * q->bx);
+        double ey = my + t * (2.0 * q->ay + t * q->by);
+        float dd = (float)(ex * ex + ey * ey);
+        if (dd < best) best = dd;
+    }
+    return best;
+}
+
+static void sdf_ymono_push(sdf_ymono* out, int* count,
+                           float x0, float y0, float x1, float y1, float x2, float y2) {
+    if (y0 == y2) return;  // horizontal (monotone ⇒ flat): never crosses a scanline
+    sdf_ymono* m = &out[(*count)++];
+    m->x0 = x0; m->y0 = y0; m->x1 = x1; m->y1 = y1; m->x2 = x2; m->y2 = y2;
+    m->dir = y2 > y0 ? 1 : -1;
+    m->ylo = y2 > y0 ? y0 : y2;
+    m->yhi = y2 > y0 ? y2 : y0;
+}
+
+// Splits a quadratic at its y-extremum so every piece is y-monotone.
+static void sdf_ymono_split(sdf_ymono* out, int* count,
+                            float x0, float y0, float cx, float cy, float x2, float y2) {
+    float den = y0 - 2.0f * cy + y2;
+    float t = den != 0.0f ? (y0 - cy) / den : -1.0f;
+    if (t <= 0.0f || t >= 1.0f) {
+        sdf_ymono_push(out, count, x0, y0, cx, cy, x2, y2);
+        return;
+    }
+    float ax = x0 + (cx - x0) * t, ay = y0 + (cy - y0) * t;
+    float bx = cx + (x2 - cx) * t, by = cy + (y2 - cy) * t;
+    float mx = ax + (bx - ax) * t, my = ay + (by - ay) * t;
+    sdf_ymono_push(out, count, x0, y0, ax, ay, mx, my);
+    sdf_ymono_push(out, count, mx, my, bx, by, x2, y2);
+}
+
+// x where a y-monotone piece crosses scanline yc (ylo <= yc < yhi).
+static float sdf_ymono_cross_x(const sdf_ymono* m, float yc) {
+    double a = (double)m->y0 - 2.0 * m->y1 + m->y2;
+    double b = 2.0 * ((double)m->y1 - m->y0);
+    double c = (double)m->y0 - yc;
+    double t;
+    if (fabs(a) < 1e-9) {
+        t = -c / b;
+    } else {
+        double disc = b * b - 4.0 * a * c;
+        double sq = disc > 0.0 ? sqrt(disc) : 0.0;
+        double qq = -0.5 * (b + (b < 0.0 ? -sq : sq));
+        double t0 = qq / a;
+        double t1 = qq != 0.0 ? c / qq : t0;
+        // Monotone ⇒ exactly one root in [0, 1]; pick the one nearest the range.
+        double e0 = t0 < 0.0 ? -t0 : (t0 > 1.0 ? t0 - 1.0 : 0.0);
+        double e1 = t1 < 0.0 ? -t1 : (t1 > 1.0 ? t1 - 1.0 : 0.0);
+        t = e0 <= e1 ? t0 : t1;
+    }
+    t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    double mt = 1.0 - t;
+    return (float)(mt * mt * m->x0 + 2.0 * mt * t * m->x1 + t * t * m->x2);
+}
+
+static inline void sdf_cell_range(float lo, float hi, float cutoff, int cells, int* c0, int* c1) {
+    int a = (int)floorf((lo - cutoff) / SDF_ANALYTIC_CELL);
+    int b = (int)floorf((hi + cutoff) / SDF_ANALYTIC_CELL);
+    *c0 = a < 0 ? 0 : a;
+    *c1 = b >= cells ? cells - 1 : b;
+}
+
+// Decomposes a scaled (26.6) outline into quadratics inside the thread's outline
+// workspace (cubic tolerance 2/64 = 1/32 px). *out_contours holds the last
+// curve index of each contour.
+static int sdf_decompose_scaled(const FT_Outline* outline, float** out_curves, int* out_curve_count,
+                                int** out_contours, int* out_contour_count) {
+    const float tolerance = 2.0f;
+    return outline_to_quads_grow(outline, tolerance * tolerance, &t_sdf_outline_workspace,
+                                 out_curves, out_curve_count, out_contours, out_contour_count);
+}
+
+// Control-hull bbox {minx, miny, maxx, maxy} of a decomposed 26.6 curve in grid space.
+static inline void sdf_curve_box(const float* c, float ox, float oy, float* box) {
+    const float k26 = 1.0f / 64.0f;
+    box[0] = fminf(c[0], fminf(c[2], c[4])) * k26 - ox;
+    box[1] = fminf(c[1], fminf(c[3], c[5])) * k26 - oy;
+    box[2] = fmaxf(c[0], fmaxf(c[2], c[4])) * k26 - ox;
+    box[3] = fmaxf(c[1], fmaxf(c[3], c[5])) * k26 - oy;
+}
+
+// Cell binning over a pw × ph texel grid: every item whose bbox (grown by
+// cutoff) touches a cell is listed in it. sdf_cells_touched sizes the item
+// array; sdf_cells_fill builds the CSR (start[cells + 1], items[]) from boxes
+// {minx, miny, maxx, maxy} found every box_stride bytes.
+static inline size_t sdf_cells_touched(const float* box, float cutoff, int cw, int ch) {
+    int cx0, cx1, cy0, cy1;
+    sdf_cell_range(box[0], box[2], cutoff, cw, &cx0, &cx1);
+    sdf_cell_range(box[1], box[3], cutoff, ch, &cy0, &cy1);
+    return cx0 <= cx1 && cy0 <= cy1 ? (size_t)(cx1 - cx0 + 1) * (cy1 - cy0 + 1) : 0;
+}
+
+static void sdf_cells_fill(const float* boxes, size_t box_stride, int n, float cutoff, int cw, int ch,
+                           int* start, int* items) {
+    int cells = cw * ch;
+    memset(start, 0, (size_t)(cells + 1) * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        const float* b = (const float*)((const char*)boxes + i * box_stride);
+        int cx0, cx1, cy0, cy1;
+        sdf_cell_range(b[0], b[2], cutoff, cw, &cx0, &cx1);
+        sdf_cell_range(b[1], b[3], cutoff, ch, &cy0, &cy1);
+        for (int cy = cy0; cy <= cy1; cy++)
+            for (int cx = cx0; cx <= cx1; cx++) start[cy * cw + cx + 1]++;
+    }
+    for (int i = 0; i < cells; i++) start[i + 1] += start[i];
+    for (int i = 0; i < n; i++) {
+        const float* b = (const float*)((const char*)boxes + i * box_stride);
+        int cx0, cx1, cy0, cy1;
+        sdf_cell_range(b[0], b[2], cutoff, cw, &cx0, &cx1);
+        sdf_cell_range(b[1], b[3], cutoff, ch, &cy0, &cy1);
+        for (int cy = cy0; cy <= cy1; cy++)
+            for (int cx = cx0; cx <= cx1; cx++) items[start[cy * cw + cx]++] = i;
+    }
+    // Fill advanced every start to its cell's end; shift back.
+    for (int i = cells; i > 0; i--) start[i] = start[i - 1];
+    start[0] = 0;
+}
+
+// Scanline yc crossings of all y-monotone pieces, sorted by x. Returns count.
+static int sdf_row_crossings(const sdf_ymono* monos, int mono_count, float yc, sdf_crossing* xs) {
+    int nx = 0;
+    for (int i = 0; i < mono_count; i++) {
+        const sdf_ymono* mo = &monos[i];
+        if (yc < mo->ylo || yc >= mo->yhi) continue;
+        sdf_crossing cr = { sdf_ymono_cross_x(mo, yc), mo->dir };
+        int j = nx++;
+        while (j > 0 && xs[j - 1].x > cr.x) { xs[j] = xs[j - 1]; j--; }
+        xs[j] = cr;
+    }
+    return nx;
+}
+
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph_analytic(FT_Face face, unsigned int glyph_index,
+                                                    int load_flags, int spread,
+                                                    ut_sdf_glyph_result* out_result) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face) { out_result->success = -1; return -1; }
+
+    // Step 1: Load scaled outline (26.6)
+    FT_Error err = FT_Load_Glyph(face, glyph_index, load_flags);
+    if (err) { out_result->success = (int)err; return (int)err; }
+
+    // Bitmap-only glyphs (sbix/CBDT) have no outline to measure — use the EDT path.
+    if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+        return ut_ft_render_sdf_glyph(face, glyph_index, load_flags, spread, out_result);
+
+    // Step 2: Outline metrics (identical to the coverage path)
+    FT_Glyph_Metrics* m = &face->glyph->metrics;
+    out_result->metric_width     = (int)(m->width >> 6);
+    out_result->metric_height    = (int)(m->height >> 6);
+    out_result->metric_bearing_x = (int)(m->horiBearingX >> 6);
+    out_result->metric_bearing_y = (int)(m->horiBearingY >> 6);
+    out_result->metric_advance_x = (int)m->horiAdvance; // raw 26.6
+
+    FT_Outline* outline = &face->glyph->outline;
+    FT_BBox cbox;
+    FT_Outline_Get_CBox(outline, &cbox);
+    int x_min = (int)(cbox.xMin >> 6), x_max = (int)((cbox.xMax + 63) >> 6);
+    int y_min = (int)(cbox.yMin >> 6), y_max = (int)((cbox.yMax + 63) >> 6);
+    int bw = outline->n_points > 0 ? x_max - x_min : 0;
+    int bh = outline->n_points > 0 ? y_max - y_min : 0;
+
+    // Zero-size glyph (space, control chars)
+    if (bw <= 0 || bh <= 0) {
+        out_result->bitmap_left = x_min;
+        out_result->bitmap_top  = y_max;
+        out_result->success = 0;
+        return 0;
+    }
+
+    // Step 3: Decompose into quadratics
+    float* curves;
+    int* contours;
+    int curve_count, contour_count;
+    err = sdf_decompose_scaled(outline, &curves, &curve_count, &contours, &contour_count);
+    if (err) { out_result->success = (int)err; return (int)err; }
+
+    int pw = bw + 2 * spread;
+    int ph = bh + 2 * spread;
+    int cw = (pw + SDF_ANALYTIC_CELL - 1) / SDF_ANALYTIC_CELL;
+    int ch = (ph + SDF_ANALYTIC_CELL - 1) / SDF_ANALYTIC_CELL;
+    int cells = cw * ch;
+    float cutoff = spread > 0 ? (float)spread : 1.0f;
+    float cutoff_sq = cutoff * cutoff;
+
+    // Grid space: pixels, origin at the padded bitmap's bottom-left corner
+    float ox = (float)(x_min - spread), oy = (float)(y_min - spread);
+    const float k26 = 1.0f / 64.0f;
+
+    // Step 4: Count cell bins → size the workspace in one go
+    size_t items = 0;
+    for (int i = 0; i < curve_count; i++) {
+        float box[4];
+        sdf_curve_box(curves + i * 8, ox, oy, box);
+        items += sdf_cells_touched(box, cutoff, cw, ch);
+    }
+
+    size_t ws_size = (size_t)curve_count * sizeof(sdf_quad)
+                   + (size_t)curve_count * 2 * sizeof(sdf_ymono)
+                   + (size_t)curve_count * 2 * sizeof(sdf_crossing)
+                   + (size_t)(cells + 1) * sizeof(int)       // cell_start
+                   + (size_t)cells * sizeof(float)           // cell_bound
+                   + items * sizeof(int)                     // cell_items
+                   + items * sizeof(float);                  // cell_lb
+    char* buf = sdf_workspace_reserve(&t_sdf_workspace, ws_size);
+    if (!buf) { out_result->success = -1; return -1; }
+
+    sdf_quad*     quads      = (sdf_quad*)buf;
+    sdf_ymono*    monos      = (sdf_ymono*)(quads + curve_count);
+    sdf_crossing* xs         = (sdf_crossing*)(monos + curve_count * 2);
+    int*          cell_start = (int*)(xs + curve_count * 2);
+    float*        cell_bound = (float*)(cell_start + cells + 1);
+    int*          cell_items = (int*)(cell_bound + cells);
+    float*        cell_lb    = (float*)(cell_items + items);
+
+    int mono_count = 0;
+    for (int i = 0; i < curve_count; i++) {
+        const float* c = curves + i * 8;
+        float x0 = c[0] * k26 - ox, y0 = c[1] * k26 - oy;
+        float x1 = c[2] * k26 - ox, y1 = c[3] * k26 - oy;
+        float x2 = c[4] * k26 - ox, y2 = c[5] * k26 - oy;
+        sdf_quad_init(&quads[i], x0, y0, x1, y1, x2, y2);
+        sdf_ymono_split(monos, &mono_count, x0, y0, x1, y1, x2, y2);
+    }
+
+    sdf_cells_fill(&quads[0].minx, sizeof(sdf_quad), curve_count, cutoff, cw, ch, cell_start, cell_items);
+
+    // Prune each cell's list: no texel in the cell is farther than
+    // U = min_i dist(center, curve_i) + half-diagonal from its nearest curve,
+    // so curves whose bbox is farther than U from the cell can never win.
+    // Compacts the CSR in place (write cursor never passes the read cursor).
+    const float half_diag = SDF_ANALYTIC_CELL * 0.70710678f;
+    int write = 0;
+    for (int cy = 0; cy < ch; cy++) {
+        for (int cx = 0; cx < cw; cx++) {
+            int c = cy * cw + cx;
+            int begin = cell_start[c], end = cell_start[c + 1];
+            float rx0 = (float)(cx * SDF_ANALYTIC_CELL), rx1 = rx0 + SDF_ANALYTIC_CELL;
+            float ry0 = (float)(cy * SDF_ANALYTIC_CELL), ry1 = ry0 + SDF_ANALYTIC_CELL;
+            float ccx = rx0 + SDF_ANALYTIC_CELL * 0.5f, ccy = ry0 + SDF_ANALYTIC_CELL * 0.5f;
+
+            float bound_sq = cutoff_sq;
+            for (int it = begin; it < end; it++) {
+                float u = sqrtf(sdf_quad_dist_sq(&quads[cell_items[it]], ccx, ccy)) + half_diag;
+                if (u * u < bound_sq) bound_sq = u * u;
+            }
+            // Slightly inflated so the curve that realized the bound is still
+            // strictly below it and gets evaluated exactly.
+            cell_bound[c] = bound_sq < cutoff_sq ? bound_sq * 1.0001f + 1e-4f : cutoff_sq;
+
+            // Kept items are ordered by that cell-to-bbox lower bound, so the
+            // texel loop can stop at the first one that cannot beat its best.
+            cell_start[c] = write;
+            for (int it = begin; it < end; it++) {
+                int qi = cell_items[it];
+                const sdf_quad* q = &quads[qi];
+                float dx = fmaxf(fmaxf(q->minx - rx1, rx0 - q->maxx), 0.0f);
+                float dy = fmaxf(fmaxf(q->miny - ry1, ry0 - q->maxy), 0.0f);
+                float lb = dx * dx + dy * dy;
+                if (lb > bound_sq) continue;
+                int j = write++;
+                while (j > cell_start[c] && cell_lb[j - 1] > lb) {
+                    cell_items[j] = cell_items[j - 1];
+                    cell_lb[j] = cell_lb[j - 1];
+                    j--;
+                }
+                cell_items[j] = qi;
+                cell_lb[j] = lb;
             }
         }
+    }
+    cell_start[cells] = write;
 
-        if (firstOnCurve < 0) {
-            // All off-curve - create midpoint
-            FT_Vector* p0 = &outline->points[contourStart];
-            FT_Vector* p1 = &outline->points[contourStart + 1];
-            double mx = (p0->x + p1->x) / 2.0;
-            double my = (p0->y + p1->y) / 2.0;
-            path->move_to(mx, my);
-            firstOnCurve = contourStart;
-        } else {
-            FT_Vector* p = &outline->points[firstOnCurve];
-            path->move_to(p->x, p->y);
+    unsigned char* sdf = (unsigned char*)malloc((size_t)pw * ph);
+    if (!sdf) { out_result->success = -1; return -1; }
+
+    bool even_odd = (outline->flags & FT_OUTLINE_EVEN_ODD_FILL) != 0;
+    float inv_spread = spread > 0 ? 128.0f / (float)spread : 128.0f;
+
+    // Step 5: Per row — scanline crossings for sign, cell lists for distance.
+    // Rows are produced bottom-up, so no Y-flip is needed.
+    for (int y = 0; y < ph; y++) {
+        float yc = (float)y + 0.5f;
+
+        int nx = sdf_row_crossings(monos, mono_count, yc, xs);
+
+        unsigned char* dst = sdf + (size_t)y * pw;
+        const int* row_cells = cell_start + (y / SDF_ANALYTIC_CELL) * cw;
+        const float* row_bound = cell_bound + (y / SDF_ANALYTIC_CELL) * cw;
+        int winding = 0, xi = 0;
+        for (int x = 0; x < pw; x++) {
+            float xc = (float)x + 0.5f;
+            while (xi < nx && xs[xi].x < xc) winding += xs[xi++].dir;
+            bool inside = even_odd ? (winding & 1) != 0 : winding != 0;
+
+            // Start from the cell's upper bound; any curve at or beyond it
+            // cannot be nearest, so only a few pass the bbox test.
+            int cell = x / SDF_ANALYTIC_CELL;
+            float best = row_bound[cell];
+            for (int it = row_cells[cell]; it < row_cells[cell + 1]; it++) {
+                if (cell_lb[it] >= best) break;
+                const sdf_quad* q = &quads[cell_items[it]];
+                float dx = fmaxf(fmaxf(q->minx - xc, xc - q->maxx), 0.0f);
+                float dy = fmaxf(fmaxf(q->miny - yc, yc - q->maxy), 0.0f);
+                if (dx * dx + dy * dy >= best) continue;
+                float dd = sdf_quad_dist_sq(q, xc, yc);
+                if (dd < best) best = dd;
+            }
+            if (best > cutoff_sq) best = cutoff_sq;
+
+            dst[x] = inside ? sdf_quantize_texel(0.0f, best, inv_spread)
+                            : sdf_quantize_texel(best, 0.0f, inv_spread);
         }
+    }
 
-        int i = firstOnCurve;
-        int numPoints = contourEnd - contourStart + 1;
+    // Step 6: Fill result
+    out_result->bmp_width   = pw;
+    out_result->bmp_height  = ph;
+    out_result->bmp_pitch   = pw;
+    out_result->bitmap_left = x_min - spread;
+    out_result->bitmap_top  = y_max + spread;
+    out_result->bmp_buffer  = sdf;
+    out_result->success = 0;
+    return 0;
+}
 
-        for (int j = 0; j < numPoints; j++) {
-            int idx = contourStart + ((i - contourStart + 1) % numPoints);
-            FT_Vector* p = &outline->points[idx];
-            char tag = outline->tags[idx];
+// =============================================================================
+// SDF Backend Selection + Comparative Benchmark
+// =============================================================================
+//
+// One entry point over every SDF generator in the library, so quality and cost
+// can be compared per font:
+// - EDT      → ut_ft_render_sdf_glyph (AA coverage + Euclidean distance transform)
+// - FT_SDF   → FreeType's `sdf` module, straight from the outline
+// - FT_BSDF  → FreeType's `bsdf` module over the AA coverage bitmap
+// - ANALYTIC → ut_ft_render_sdf_glyph_analytic (exact distance to the outline)
+// All four share the output contract of ut_ft_render_sdf_glyph: Alpha8,
+// 128 = edge, inside > 128, padded by spread, bottom-up rows. The FreeType
+// backends set the module's spread on the face's library (valid range 2..32,
+// else FreeType's error is returned) — like ut_ft_set_sdf_spread, not
+// thread-safe against other renders on the same library.
+
+#define UT_SDF_BACKEND_EDT      0
+#define UT_SDF_BACKEND_FT_SDF   1
+#define UT_SDF_BACKEND_FT_BSDF  2
+#define UT_SDF_BACKEND_ANALYTIC 3
+
+// FreeType `sdf` / `bsdf` render of the loaded-then-rendered slot, flipped to
+// bottom-up rows in a malloc'd buffer.
+static int sdf_render_freetype(FT_Face face, unsigned int glyph_index, int load_flags, int spread,
+                               bool from_bitmap, ut_sdf_glyph_result* out_result) {
+    FT_UInt s = (FT_UInt)spread;
+    FT_Error err = FT_Property_Set(face->glyph->library, from_bitmap ? "bsdf" : "sdf", "spread", &s);
+    if (err) { out_result->success = (int)err; return (int)err; }
 
-            if (tag & 1) { // On curve
-                path->line_to(p->x, p->y);
-            } else if (tag & 2) { // Cubic
-                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
-                int idx3 = contourStart + ((idx - contourStart + 2) % numPoints);
-                FT_Vector* p2 = &outline->points[idx2];
-                FT_Vector* p3 = &outline->points[idx3];
-                path->cubic_to(p->x, p->y, p2->x, p2->y, p3->x, p3->y);
-                j += 2;
-                i = idx3;
-                continue;
-            } else { // Quadratic (conic)
-                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
-                FT_Vector* p2 = &outline->points[idx2];
-                char tag2 = outline->tags[idx2];
+    err = FT_Load_Glyph(face, glyph_index, load_flags);
+    if (err) { out_result->success = (int)err; return (int)err; }
 
-                double cx = p->x;
-                double cy = p->y;
-                double ex, ey;
+    // Bitmap-only glyphs (sbix/CBDT) carry color, which neither module reads.
+    if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+        return ut_ft_render_sdf_glyph(face, glyph_index, load_flags, spread, out_result);
 
-                if (tag2 & 1) { // Next is on-curve
-                    ex = p2->x;
-                    ey = p2->y;
-                    path->quad_to(cx, cy, ex, ey);
-                    j++;
-                    i = idx2;
-                    continue;
-                } else { // Next is also off-curve
-                    ex = (p->x + p2->x) / 2.0;
-                    ey = (p->y + p2->y) / 2.0;
-                    path->quad_to(cx, cy, ex, ey);
+    FT_Glyph_Metrics* m = &face->glyph->metrics;
+    out_result->metric_width     = (int)(m->width >> 6);
+    out_result->metric_height    = (int)(m->height >> 6);
+    out_result->metric_bearing_x = (int)(m->horiBearingX >> 6);
+    out_result->metric_bearing_y = (int)(m->horiBearingY >> 6);
+    out_result->metric_advance_x = (int)m->horiAdvance; // raw 26.6
+
+    // bsdf runs when the slot already holds a bitmap.
+    if (from_bitmap) err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+    if (!err) err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF);
+    if (err) { out_result->success = (int)err; return (int)err; }
+
+    const FT_Bitmap* b = &face->glyph->bitmap;
+    int w = (int)b->width, h = (int)b->rows;
+    out_result->bitmap_left = face->glyph->bitmap_left;
+    out_result->bitmap_top  = face->glyph->bitmap_top;
+    if (w <= 0 || h <= 0 || !b->buffer) {
+        out_result->success = 0;
+        return 0;
+    }
+
+    unsigned char* sdf = (unsigned char*)malloc((size_t)w * h);
+    if (!sdf) { out_result->success = -1; return -1; }
+    // FreeType rows run top-down for a positive pitch.
+    for (int y = 0; y < h; y++) {
+        const unsigned char* src = b->pitch >= 0 ? b->buffer + (size_t)y * b->pitch
+                                                 : b->buffer + (size_t)(h - 1 - y) * -b->pitch;
+        memcpy(sdf + (size_t)(h - 1 - y) * w, src, (size_t)w);
+    }
+
+    out_result->bmp_width  = w;
+    out_result->bmp_height = h;
+    out_result->bmp_pitch  = w;
+    out_result->bmp_buffer = sdf;
+    out_result->success = 0;
+    return 0;
+}
+
+// ut_ft_render_sdf_glyph with the generator picked per call (UT_SDF_BACKEND_*).
+// Returns -1 for an unknown backend.
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph_ex(FT_Face face, unsigned int glyph_index,
+                                              int load_flags, int spread, int backend,
+                                              ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face) { out_result->success = -1; return -1; }
+
+    switch (backend) {
+        case UT_SDF_BACKEND_EDT:
+            return ut_ft_render_sdf_glyph(face, glyph_index, load_flags, spread, out_result);
+        case UT_SDF_BACKEND_FT_SDF:
+            return sdf_render_freetype(face, glyph_index, load_flags, spread, false, out_result);
+        case UT_SDF_BACKEND_FT_BSDF:
+            return sdf_render_freetype(face, glyph_index, load_flags, spread, true, out_result);
+        case UT_SDF_BACKEND_ANALYTIC:
+            return ut_ft_render_sdf_glyph_analytic(face, glyph_index, load_flags, spread, out_result);
+        default:
+            out_result->success = -1;
+            return -1;
+    }
+}
+
+typedef struct {
+    double us_per_glyph;  // mean render time (load + rasterize + SDF), buffers freed
+    float max_error;      // px, vs the analytic reference
+    float mean_error;     // px, over texels unsaturated in either tile
+    int glyphs;           // glyphs that rendered with both backend and reference
+    int failures;         // glyphs the backend (or the reference) failed on
+} ut_sdf_bench_stats;
+
+// Code of the texel at pixel (gx, gy) in the shared pixel grid: tiles differ
+// in padding and origin between backends, and texels off the tile read as
+// saturated outside (0).
+static inline int sdf_bench_texel(const ut_sdf_glyph_result* r, int gx, int gy) {
+    int x = gx - r->bitmap_left;
+    int y = gy - (r->bitmap_top - r->bmp_height);  // bottom-up rows
+    if (!r->bmp_buffer || x < 0 || y < 0 || x >= r->bmp_width || y >= r->bmp_height) return 0;
+    return ((const unsigned char*)r->bmp_buffer)[y * r->bmp_pitch + x];
+}
+
+// Benchmarks one backend over glyphs[count] of a face at its current pixel
+// size: timing over `iterations` passes, then one error pass against the
+// analytic backend (exact outline distance, itself quantized to 8 bits, so
+// errors below spread / 256 px are noise; ANALYTIC measures 0 by definition).
+// A corpus run calls this per font and backend. Returns -1 on bad args.
+UNITEXT_EXPORT int ut_sdf_bench_backend(FT_Face face, const unsigned int* glyphs, int count,
+                                        int load_flags, int spread, int backend, int iterations,
+                                        ut_sdf_bench_stats* out_stats) {
+    if (!out_stats) return -1;
+    memset(out_stats, 0, sizeof(ut_sdf_bench_stats));
+    if (!face || !glyphs || count <= 0 || iterations <= 0 || spread <= 0) return -1;
+    if (backend < UT_SDF_BACKEND_EDT || backend > UT_SDF_BACKEND_ANALYTIC) return -1;
+
+    ut_sdf_glyph_result r;
+    double total_us = 0.0;
+    for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < count; i++) {
+            auto t0 = std::chrono::steady_clock::now();
+            ut_ft_render_sdf_glyph_ex(face, glyphs[i], load_flags, spread, backend, &r);
+            auto t1 = std::chrono::steady_clock::now();
+            total_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            free(r.bmp_buffer);
+        }
+    }
+    out_stats->us_per_glyph = total_us / ((double)iterations * count);
+
+    float px_per_code = (float)spread / 128.0f;
+    double error_sum = 0.0;
+    size_t texels = 0;
+    ut_sdf_glyph_result ref;
+    for (int i = 0; i < count; i++) {
+        int err = ut_ft_render_sdf_glyph_ex(face, glyphs[i], load_flags, spread, backend, &r);
+        if (!err) err = ut_ft_render_sdf_glyph_ex(face, glyphs[i], load_flags, spread,
+                                                  UT_SDF_BACKEND_ANALYTIC, &ref);
+        else memset(&ref, 0, sizeof(ref));
+        if (err) {
+            out_stats->failures++;
+        } else {
+            out_stats->glyphs++;
+            // Union of both tiles, so a backend that clips the band is charged for it.
+            int x0 = r.bitmap_left, x1 = r.bitmap_left + r.bmp_width;
+            int y1 = r.bitmap_top, y0 = r.bitmap_top - r.bmp_height;
+            if (ref.bmp_buffer) {
+                if (ref.bitmap_left < x0) x0 = ref.bitmap_left;
+                if (ref.bitmap_left + ref.bmp_width > x1) x1 = ref.bitmap_left + ref.bmp_width;
+                if (ref.bitmap_top > y1) y1 = ref.bitmap_top;
+                if (ref.bitmap_top - ref.bmp_height < y0) y0 = ref.bitmap_top - ref.bmp_height;
+            }
+            for (int gy = y0; gy < y1; gy++) {
+                for (int gx = x0; gx < x1; gx++) {
+                    int a = sdf_bench_texel(&r, gx, gy);
+                    int b = sdf_bench_texel(&ref, gx, gy);
+                    if (a == b && (a == 0 || a == 255)) continue;  // saturated in both
+                    float e = (float)(a > b ? a - b : b - a) * px_per_code;
+                    if (e > out_stats->max_error) out_stats->max_error = e;
+                    error_sum += e;
+                    texels++;
                 }
             }
-            i = idx;
         }
+        free(r.bmp_buffer);
+        free(ref.bmp_buffer);
+    }
+    out_stats->mean_error = texels ? (float)(error_sum / texels) : 0.0f;
+    return 0;
+}
+
+typedef struct {
+    double us_float;    // mean ut_ft_render_sdf_glyph_format time, float EDT
+    double us_int;      // same, fixed-point EDT requested
+    int max_diff;       // largest |fixed - float| texel difference, in format codes
+    float mean_diff;    // over texels that differ
+    long long texels;   // texels compared
+    long long differing;
+    int glyphs;         // glyphs that rendered in both modes
+    int failures;
+} ut_sdf_edt_bench_stats;
+
+// ut_sdf_bench_edt on real glyphs: renders glyphs[count] of a face at its
+// current pixel size in `format` (R8 or R16) with the float and the fixed-point
+// EDT, timing `iterations` passes of each, then compares the tiles texel by
+// texel. R16 renders stay on the float EDT (see Fixed-point EDT), so their
+// speedup and difference are expected to be 1x and 0. Restores the
+// ut_ft_set_sdf_integer_edt setting. Returns -1 on bad args.
+UNITEXT_EXPORT int ut_sdf_bench_edt_glyphs(FT_Face face, const unsigned int* glyphs, int count,
+                                           int load_flags, int spread, int format, int iterations,
+                                           ut_sdf_edt_bench_stats* out_stats) {
+    if (!out_stats) return -1;
+    memset(out_stats, 0, sizeof(ut_sdf_edt_bench_stats));
+    if (!face || !glyphs || count <= 0 || iterations <= 0 || spread <= 0) return -1;
+    if (format != GPU_UPLOAD_FMT_R8 && format != GPU_UPLOAD_FMT_R16) return -1;
+
+    int saved = g_sdf_integer_edt.load(std::memory_order_relaxed);
+    ut_sdf_glyph_result r;
+    double total_us[2] = { 0.0, 0.0 };
+    for (int mode = 0; mode < 2; mode++) {
+        g_sdf_integer_edt.store(mode, std::memory_order_relaxed);
+        for (int it = 0; it < iterations; it++) {
+            for (int i = 0; i < count; i++) {
+                auto t0 = std::chrono::steady_clock::now();
+                ut_ft_render_sdf_glyph_format(face, glyphs[i], load_flags, spread, format, &r);
+                auto t1 = std::chrono::steady_clock::now();
+                total_us[mode] += std::chrono::duration<double, std::micro>(t1 - t0).count();
+                free(r.bmp_buffer);
+            }
+        }
+    }
+    out_stats->us_float = total_us[0] / ((double)iterations * count);
+    out_stats->us_int = total_us[1] / ((double)iterations * count);
+
+    double diff_sum = 0.0;
+    ut_sdf_glyph_result fx;
+    for (int i = 0; i < count; i++) {
+        g_sdf_integer_edt.store(0, std::memory_order_relaxed);
+        int err = ut_ft_render_sdf_glyph_format(face, glyphs[i], load_flags, spread, format, &r);
+        g_sdf_integer_edt.store(1, std::memory_order_relaxed);
+        if (!err) err = ut_ft_render_sdf_glyph_format(face, glyphs[i], load_flags, spread, format, &fx);
+        else memset(&fx, 0, sizeof(fx));
+        // Both modes share padding and origin, so the tiles line up 1:1.
+        if (err || r.bmp_width != fx.bmp_width || r.bmp_height != fx.bmp_height
+            || r.bmp_pitch != fx.bmp_pitch) {
+            out_stats->failures++;
+        } else {
+            out_stats->glyphs++;
+            for (int y = 0; y < r.bmp_height; y++) {
+                const unsigned char* a = (const unsigned char*)r.bmp_buffer + (size_t)y * r.bmp_pitch;
+                const unsigned char* b = (const unsigned char*)fx.bmp_buffer + (size_t)y * fx.bmp_pitch;
+                for (int x = 0; x < r.bmp_width; x++) {
+                    int va, vb;
+                    if (format == GPU_UPLOAD_FMT_R16) {
+                        va = ((const uint16_t*)a)[x];
+                        vb = ((const uint16_t*)b)[x];
+                    } else {
+                        va = a[x];
+                        vb = b[x];
+                    }
+                    int d = va > vb ? va - vb : vb - va;
+                    out_stats->texels++;
+                    if (!d) continue;
+                    out_stats->differing++;
+                    diff_sum += d;
+                    if (d > out_stats->max_diff) out_stats->max_diff = d;
+                }
+            }
+        }
+        free(r.bmp_buffer);
+        free(fx.bmp_buffer);
+    }
+    out_stats->mean_diff = out_stats->differing ? (float)(diff_sum / out_stats->differing) : 0.0f;
+    g_sdf_integer_edt.store(saved, std::memory_order_relaxed);
+    return 0;
+}
+
+// =============================================================================
+// Persistent SDF Glyph Cache
+// =============================================================================
+//
+// Finished SDF tiles + metrics in one append-only file, so warm launches skip
+// FreeType and the EDT entirely. A tile is keyed by font content hash
+// (ut_sdf_cache_font_hash), face index (collections share one hash), glyph
+// index, face scale, variation coordinates, spread, load flags and backend. The file is memory-mapped; lookups copy out
+// of the mapping through an in-memory index built when the file is opened.
+//
+// Several processes (editor + player builds) may share one file:
+// - Records are only ever appended, under an exclusive file lock; the index
+//   scan runs under a shared one.
+// - Each record carries a checksum, so a torn tail (a writer killed mid-append)
+//   stops the scan. The next writer appends over it rather than truncating
+//   (other processes may have the file mapped, and Windows refuses to shrink
+//   a mapped file); whatever stale bytes remain past the new record fail the
+//   checksum the same way.
+// - Before appending, a writer indexes whatever other processes appended since,
+//   and skips the write when the tile is already there.
+// Tiles are zstd-compressed at a negative (fast) level: SDF tiles are mostly
+// saturated runs and smooth ramps, so they shrink to ~40-55% while decoding
+// stays a few µs per tile. A tile that would not shrink is stored raw.
+// A file from another cache format version is refused (open returns NULL) —
+// callers put ut_version() in the file name.
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SDF_CACHE_VERSION    2u
+#define SDF_CACHE_RECORD_TAG 0x52534455u   // "UDSR"
+#define SDF_CACHE_MAX_COORDS 16            // variation axes folded into the key
+#define SDF_CACHE_ZSTD_LEVEL (-1)
+
+static const char SDF_CACHE_MAGIC[8] = { 'U', 'T', 'S', 'D', 'F', 'C', 'A', 'C' };
+
+struct sdf_cache_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;   // sizeof(sdf_cache_record), guards layout changes
+};
+
+struct sdf_cache_key {
+    uint64_t font_hash;
+    uint64_t coords_hash;   // 0 for faces without variations
+    int64_t x_scale;        // face->size->metrics (16.16), covers fractional sizes
+    int64_t y_scale;
+    int64_t face_index;     // FT_Long, named instance bits included
+    uint32_t glyph_index;
+    int32_t spread;
+    int32_t load_flags;
+    int32_t backend;
+};
+
+// 8-byte aligned; followed by stored_size payload bytes and zero padding to 8
+// bytes. The payload is the bmp_width × bmp_height tile (bottom-up Alpha8, as
+// returned by the renderer) as one zstd frame, or raw when stored_size equals
+// the tile size.
+struct sdf_cache_record {
+    uint32_t tag;
+    uint32_t checksum;      // of everything after this field, padding included
+    uint32_t size;          // whole record, padded
+    uint32_t reserved;
+    sdf_cache_key key;
+    int32_t metric_width, metric_height, metric_bearing_x, metric_bearing_y, metric_advance_x;
+    int32_t bmp_width, bmp_height, bitmap_left, bitmap_top;
+    int32_t stored_size;
+};
+
+struct sdf_cache_slot {
+    uint64_t hash;
+    uint64_t offset;        // 0 = empty (offset 0 is the file header)
+};
+
+struct ut_sdf_cache {
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    const unsigned char* map = nullptr;
+    size_t map_len = 0;
+    uint64_t indexed_end = 0;   // end of the last valid record seen
+    sdf_cache_slot* slots = nullptr;
+    size_t slot_count = 0;      // power of two
+    size_t used = 0;
+    ZSTD_DCtx* dctx = nullptr;  // created on the first compressed hit
+    std::mutex mutex;
+};
+
+static inline uint32_t sdf_cache_record_size(int stored_size) {
+    return (uint32_t)((sizeof(sdf_cache_record) + (size_t)stored_size + 7) & ~(size_t)7);
+}
+
+static inline uint32_t sdf_cache_checksum(const sdf_cache_record* r) {
+    const unsigned char* body = (const unsigned char*)r + offsetof(sdf_cache_record, size);
+    return (uint32_t)ut_hash64(body, r->size - offsetof(sdf_cache_record, size), 0);
+}
+
+// --- Platform file layer ---
+
+#ifdef _WIN32
+// Locks a sentinel byte far past any data, so the lock never blocks I/O on
+// the records themselves (Windows byte-range locks are mandatory).
+static void sdf_cache_lock(ut_sdf_cache* c, bool exclusive) {
+    OVERLAPPED ov = {};
+    ov.OffsetHigh = 0x40000000;
+    LockFileEx(c->file, exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, 1, 0, &ov);
+}
+
+static void sdf_cache_unlock(ut_sdf_cache* c) {
+    OVERLAPPED ov = {};
+    ov.OffsetHigh = 0x40000000;
+    UnlockFileEx(c->file, 0, 1, 0, &ov);
+}
+
+static bool sdf_cache_file_open(ut_sdf_cache* c, const char* path) {
+    int n = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+    if (n <= 0) return false;
+    wchar_t* wpath = (wchar_t*)malloc(sizeof(wchar_t) * n);
+    if (!wpath) return false;
+    MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, n);
+    c->file = CreateFileW(wpath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                          nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    free(wpath);
+    return c->file != INVALID_HANDLE_VALUE;
+}
+
+static void sdf_cache_file_close(ut_sdf_cache* c) {
+    if (c->file != INVALID_HANDLE_VALUE) CloseHandle(c->file);
+}
+
+static uint64_t sdf_cache_file_size(ut_sdf_cache* c) {
+    LARGE_INTEGER size;
+    return GetFileSizeEx(c->file, &size) ? (uint64_t)size.QuadPart : 0;
+}
+
+static bool sdf_cache_file_write(ut_sdf_cache* c, const void* data, size_t size, uint64_t offset) {
+    OVERLAPPED ov = {};
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD written = 0;
+    return WriteFile(c->file, data, (DWORD)size, &written, &ov) && written == size;
+}
+
+static void sdf_cache_unmap(ut_sdf_cache* c) {
+    if (c->map) UnmapViewOfFile(c->map);
+    c->map = nullptr;
+    c->map_len = 0;
+}
+
+static bool sdf_cache_map(ut_sdf_cache* c, uint64_t size) {
+    sdf_cache_unmap(c);
+    HANDLE mapping = CreateFileMappingW(c->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) return false;
+    c->map = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+    CloseHandle(mapping);  // the view keeps the mapping alive
+    c->map_len = c->map ? (size_t)size : 0;
+    return c->map != nullptr;
+}
+#else
+static void sdf_cache_lock(ut_sdf_cache* c, bool exclusive) {
+    while (flock(c->fd, exclusive ? LOCK_EX : LOCK_SH) != 0 && errno == EINTR) {}
+}
+
+static void sdf_cache_unlock(ut_sdf_cache* c) {
+    flock(c->fd, LOCK_UN);
+}
+
+static bool sdf_cache_file_open(ut_sdf_cache* c, const char* path) {
+    c->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    return c->fd >= 0;
+}
+
+static void sdf_cache_file_close(ut_sdf_cache* c) {
+    if (c->fd >= 0) close(c->fd);
+}
+
+static uint64_t sdf_cache_file_size(ut_sdf_cache* c) {
+    struct stat st;
+    return fstat(c->fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+static bool sdf_cache_file_write(ut_sdf_cache* c, const void* data, size_t size, uint64_t offset) {
+    const char* p = (const char*)data;
+    while (size > 0) {
+        ssize_t n = pwrite(c->fd, p, size, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return true;
+}
+
+static void sdf_cache_unmap(ut_sdf_cache* c) {
+    if (c->map) munmap((void*)c->map, c->map_len);
+    c->map = nullptr;
+    c->map_len = 0;
+}
+
+static bool sdf_cache_map(ut_sdf_cache* c, uint64_t size) {
+    sdf_cache_unmap(c);
+    void* p = mmap(nullptr, (size_t)size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (p == MAP_FAILED) return false;
+    c->map = (const unsigned char*)p;
+    c->map_len = (size_t)size;
+    return true;
+}
+#endif
+
+// --- Index ---
+
+static const sdf_cache_record* sdf_cache_find(const ut_sdf_cache* c, const sdf_cache_key* key, uint64_t hash) {
+    if (!c->slot_count || !c->map) return nullptr;  // unmapped after a failed remap
+    size_t mask = c->slot_count - 1;
+    for (size_t i = (size_t)hash & mask; c->slots[i].offset; i = (i + 1) & mask) {
+        if (c->slots[i].hash != hash || c->slots[i].offset >= c->map_len) continue;
+        const sdf_cache_record* r = (const sdf_cache_record*)(c->map + c->slots[i].offset);
+        if (memcmp(&r->key, key, sizeof(sdf_cache_key)) == 0) return r;
+    }
+    return nullptr;
+}
+
+static bool sdf_cache_insert(ut_sdf_cache* c, uint64_t hash, uint64_t offset) {
+    if ((c->used + 1) * 2 > c->slot_count) {
+        size_t count = c->slot_count ? c->slot_count * 2 : 1024;
+        sdf_cache_slot* slots = (sdf_cache_slot*)calloc(count, sizeof(sdf_cache_slot));
+        if (!slots) return false;
+        for (size_t i = 0; i < c->slot_count; i++) {
+            if (!c->slots[i].offset) continue;
+            size_t j = (size_t)c->slots[i].hash & (count - 1);
+            while (slots[j].offset) j = (j + 1) & (count - 1);
+            slots[j] = c->slots[i];
+        }
+        free(c->slots);
+        c->slots = slots;
+        c->slot_count = count;
+    }
+    size_t mask = c->slot_count - 1;
+    size_t i = (size_t)hash & mask;
+    while (c->slots[i].offset) i = (i + 1) & mask;
+    c->slots[i].hash = hash;
+    c->slots[i].offset = offset;
+    c->used++;
+    return true;
+}
+
+// Maps the whole file and indexes records past indexed_end, stopping at the
+// first one that is truncated or fails its checksum. Caller holds a file lock.
+// Returns the file size (> indexed_end when a torn tail follows).
+static uint64_t sdf_cache_sync(ut_sdf_cache* c) {
+    uint64_t size = sdf_cache_file_size(c);
+    if (size <= c->indexed_end) return size;
+    if (size > c->map_len && !sdf_cache_map(c, size)) return size;
+
+    uint64_t pos = c->indexed_end;
+    while (pos + sizeof(sdf_cache_record) <= size) {
+        const sdf_cache_record* r = (const sdf_cache_record*)(c->map + pos);
+        if (r->tag != SDF_CACHE_RECORD_TAG || r->bmp_width < 0 || r->bmp_height < 0) break;
+        if (r->stored_size < 0 || (int64_t)r->stored_size > (int64_t)r->bmp_width * r->bmp_height) break;
+        if (r->size != sdf_cache_record_size(r->stored_size) || pos + r->size > size) break;
+        if (r->checksum != sdf_cache_checksum(r)) break;
+        // A record another process appended twice (both rendered it before
+        // either wrote) is indexed once.
+        uint64_t hash = ut_hash64(&r->key, sizeof(sdf_cache_key), 0);
+        if (!sdf_cache_find(c, &r->key, hash) && !sdf_cache_insert(c, hash, pos)) break;
+        pos += r->size;
+    }
+    c->indexed_end = pos;
+    return size;
+}
+
+// --- API ---
+
+// Content hash of a font file, for the cache key. Hash the same bytes that
+// were passed to ut_ft_new_memory_face.
+UNITEXT_EXPORT unsigned long long ut_sdf_cache_font_hash(const void* data, long size) {
+    if (!data || size <= 0) return 0;
+    return ut_hash64(data, (size_t)size, 0x5DF0CAC4Eull);
+}
+
+UNITEXT_EXPORT void ut_sdf_cache_close(ut_sdf_cache* c) {
+    if (!c) return;
+    sdf_cache_unmap(c);
+    sdf_cache_file_close(c);
+    free(c->slots);
+    if (c->dctx) ZSTD_freeDCtx(c->dctx);
+    delete c;
+}
+
+// Opens (creating if missing) the cache file at a UTF-8 path and indexes it.
+// Returns NULL when the file cannot be opened or mapped, or was written by
+// another cache format version.
+UNITEXT_EXPORT ut_sdf_cache* ut_sdf_cache_open(const char* path) {
+    if (!path) return nullptr;
+    ut_sdf_cache* c = new ut_sdf_cache();
+    if (!sdf_cache_file_open(c, path)) {
+        delete c;
+        return nullptr;
+    }
+
+    sdf_cache_file_header expected;
+    memcpy(expected.magic, SDF_CACHE_MAGIC, sizeof(expected.magic));
+    expected.version = SDF_CACHE_VERSION;
+    expected.record_size = (uint32_t)sizeof(sdf_cache_record);
+
+    // First opener writes the header; everyone checks it.
+    sdf_cache_lock(c, true);
+    bool ok = true;
+    if (sdf_cache_file_size(c) == 0)
+        ok = sdf_cache_file_write(c, &expected, sizeof(expected), 0);
+    if (ok) ok = sdf_cache_map(c, sdf_cache_file_size(c));
+    ok = ok && c->map_len >= sizeof(expected) && memcmp(c->map, &expected, sizeof(expected)) == 0;
+    if (ok) {
+        c->indexed_end = sizeof(expected);
+        sdf_cache_sync(c);
+    }
+    sdf_cache_unlock(c);
+
+    if (!ok) {
+        ut_sdf_cache_close(c);
+        return nullptr;
+    }
+    return c;
+}
+
+// Number of tiles in the index.
+UNITEXT_EXPORT int ut_sdf_cache_count(ut_sdf_cache* c) {
+    if (!c) return 0;
+    std::lock_guard<std::mutex> lock(c->mutex);
+    return (int)c->used;
+}
+
+// Copies a record's tile into out_result->bmp_buffer (malloc'd), inflating it
+// when compressed. Caller holds c->mutex. On failure returns -1 with nothing
+// allocated; out_result->success is -1 only when the tile buffer could not be
+// allocated (other failures fall back to a render).
+static int sdf_cache_decode(ut_sdf_cache* c, const sdf_cache_record* r, ut_sdf_glyph_result* out_result) {
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    size_t tile = (size_t)r->bmp_width * r->bmp_height;
+    if (!tile) return 0;
+    out_result->bmp_buffer = malloc(tile);
+    if (!out_result->bmp_buffer) {
+        out_result->success = -1;
+        return -1;
+    }
+    if ((size_t)r->stored_size == tile) {
+        memcpy(out_result->bmp_buffer, r + 1, tile);
+        return 0;
+    }
+    if (!c->dctx) c->dctx = ZSTD_createDCtx();
+    size_t n = c->dctx ? ZSTD_decompressDCtx(c->dctx, out_result->bmp_buffer, tile, r + 1, (size_t)r->stored_size)
+                       : 0;
+    if (c->dctx && !ZSTD_isError(n) && n == tile) return 0;
+    free(out_result->bmp_buffer);
+    out_result->bmp_buffer = nullptr;
+    return -1;
+}
+
+static void sdf_cache_make_key(FT_Face face, unsigned long long font_hash, unsigned int glyph_index,
+                               int load_flags, int spread, int backend, sdf_cache_key* key) {
+    memset(key, 0, sizeof(sdf_cache_key));
+    key->font_hash   = font_hash;
+    key->x_scale     = face->size ? (int64_t)face->size->metrics.x_scale : 0;
+    key->y_scale     = face->size ? (int64_t)face->size->metrics.y_scale : 0;
+    key->face_index  = (int64_t)face->face_index;
+    key->glyph_index = glyph_index;
+    key->spread      = spread;
+    key->load_flags  = load_flags;
+    key->backend     = backend;
+    if (FT_HAS_MULTIPLE_MASTERS(face)) {
+        // Excess coordinates come back as 0, so the axis count is not needed.
+        FT_Fixed coords[SDF_CACHE_MAX_COORDS] = {};
+        if (FT_Get_Var_Blend_Coordinates(face, SDF_CACHE_MAX_COORDS, coords) == 0)
+            key->coords_hash = ut_hash64(coords, sizeof(coords), 0) | 1;
+    }
+}
 
-        path->close();
-        contourStart = contourEnd + 1;
+// ut_ft_render_sdf_glyph_ex through the cache: a hit copies the stored tile
+// and metrics (no FreeType work at all); a miss renders at the face's current
+// size and variation, then appends the tile. bmp_buffer is malloc'd either way
+// (free via ut_ft_free_sdf_buffer). A NULL cache renders uncached. Failed
+// renders are not stored; a failed append only costs the next launch a render.
+UNITEXT_EXPORT int ut_ft_render_sdf_glyph_cached(ut_sdf_cache* cache, unsigned long long font_hash,
+                                                  FT_Face face, unsigned int glyph_index, int load_flags,
+                                                  int spread, int backend, ut_sdf_glyph_result* out_result) {
+    if (!cache || !face || !out_result)
+        return ut_ft_render_sdf_glyph_ex(face, glyph_index, load_flags, spread, backend, out_result);
+
+    sdf_cache_key key;
+    sdf_cache_make_key(face, font_hash, glyph_index, load_flags, spread, backend, &key);
+    uint64_t hash = ut_hash64(&key, sizeof(key), 0);
+
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        const sdf_cache_record* r = sdf_cache_find(cache, &key, hash);
+        if (r && sdf_cache_decode(cache, r, out_result) == 0) {
+            out_result->metric_width     = r->metric_width;
+            out_result->metric_height    = r->metric_height;
+            out_result->metric_bearing_x = r->metric_bearing_x;
+            out_result->metric_bearing_y = r->metric_bearing_y;
+            out_result->metric_advance_x = r->metric_advance_x;
+            out_result->bmp_width   = r->bmp_width;
+            out_result->bmp_height  = r->bmp_height;
+            out_result->bmp_pitch   = r->bmp_width;
+            out_result->bitmap_left = r->bitmap_left;
+            out_result->bitmap_top  = r->bitmap_top;
+            return 0;
+        }
+        // A tile that fails to decode is rendered again; its record stays.
+        if (r && out_result->success == -1) return -1;
     }
 
-    return 1;
-}
+    // Rendering runs outside the lock; the glyph is keyed, not the render.
+    int err = ut_ft_render_sdf_glyph_ex(face, glyph_index, load_flags, spread, backend, out_result);
+    if (err) return err;
+
+    int w = out_result->bmp_buffer ? out_result->bmp_width : 0;
+    int h = out_result->bmp_buffer ? out_result->bmp_height : 0;
+    size_t tile = (size_t)w * h;
+
+    // Tile rows packed, then compressed (also outside the lock).
+    unsigned char* packed = nullptr;
+    unsigned char* frame = nullptr;
+    size_t stored = tile;
+    if (tile) {
+        packed = (unsigned char*)malloc(tile);
+        frame = (unsigned char*)malloc(ZSTD_compressBound(tile));
+        if (!packed || !frame) {
+            free(packed);
+            free(frame);
+            return 0;
+        }
+        for (int y = 0; y < h; y++)
+            memcpy(packed + (size_t)y * w,
+                   (const unsigned char*)out_result->bmp_buffer + (size_t)y * out_result->bmp_pitch, (size_t)w);
+        size_t n = ZSTD_compress(frame, ZSTD_compressBound(tile), packed, tile, SDF_CACHE_ZSTD_LEVEL);
+        if (!ZSTD_isError(n) && n < tile) stored = n;
+    }
 
-UNITEXT_EXPORT int ut_ft_get_outline_info(FT_Face face, int* outNumContours, int* outNumPoints) {
-    if (!face || !face->glyph) return 0;
-    FT_Outline* outline = &face->glyph->outline;
-    if (outNumContours) *outNumContours = outline->n_contours;
-    if (outNumPoints) *outNumPoints = outline->n_points;
-    return 1;
+    uint32_t size = sdf_cache_record_size((int)stored);
+    sdf_cache_record* r = (sdf_cache_record*)calloc(1, size);
+    if (!r) {
+        free(packed);
+        free(frame);
+        return 0;
+    }
+    r->tag  = SDF_CACHE_RECORD_TAG;
+    r->size = size;
+    r->key  = key;
+    r->metric_width     = out_result->metric_width;
+    r->metric_height    = out_result->metric_height;
+    r->metric_bearing_x = out_result->metric_bearing_x;
+    r->metric_bearing_y = out_result->metric_bearing_y;
+    r->metric_advance_x = out_result->metric_advance_x;
+    r->bmp_width   = w;
+    r->bmp_height  = h;
+    r->bitmap_left = out_result->bitmap_left;
+    r->bitmap_top  = out_result->bitmap_top;
+    r->stored_size = (int32_t)stored;
+    if (stored) memcpy(r + 1, stored < tile ? frame : packed, stored);
+    free(packed);
+    free(frame);
+    r->checksum = sdf_cache_checksum(r);
+
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    sdf_cache_lock(cache, true);
+    uint64_t file_size = sdf_cache_sync(cache);
+    if (!sdf_cache_find(cache, &key, hash)) {
+        // Past indexed_end is at most a torn tail; the record goes over it.
+        uint64_t at = cache->indexed_end;
+        uint64_t end = at + size > file_size ? at + size : file_size;
+        if (sdf_cache_file_write(cache, r, size, at) && sdf_cache_map(cache, end)
+            && sdf_cache_insert(cache, hash, at))
+            cache->indexed_end = at + size;
+    }
+    sdf_cache_unlock(cache);
+    free(r);
+    return 0;
 }
 
 // =============================================================================
-// Outline Decompose — manual FT_Outline walking (all-quadratic output)
+// Multi-channel SDF (MSDF / MTSDF) Glyph Render
 // =============================================================================
 //
-// Walks FT_Outline points/tags/contours directly, emitting ALL curves as
-// quadratic Béziers with float-precision implicit midpoints:
-// - On-curve lines → degenerate quadratic (control = midpoint)
-// - Conic (quadratic) → direct output
-// - Cubic (CFF/OTF) → adaptive recursive subdivision (de Casteljau) until
-//   single-quad approximation error < tolerance; matches fontTools.cu2qu /
-//   Skia behaviour. Replaces former fixed split-at-midpoint that visibly
-//   distorted curves on CFF fonts with high curvature.
+// A single distance channel cannot describe two edges meeting at an angle, so
+// magnified single-channel SDF tiles round sharp corners. MSDF (after msdfgen,
+// Chlumský 2015) stores three distances, each to a different subset of the
+// edges; the shader's median(r, g, b) reconstructs the corner, so tiles hold
+// the same edge quality at roughly half the resolution.
 //
-// This produces better SDF quality than FT_Outline_Decompose because:
-// - Float midpoints (a+b)*0.5f vs FreeType's integer (a+b)/2 truncation
-// - Consistent contour starting point (first on-curve by linear search)
-// - No degenerate segment skipping
+// - Edges → outline_to_quads on the scaled outline (same walker as
+//   ut_ft_outline_decompose)
+// - Edge colouring → per contour, corners (tangent turn > ~8°) split the
+//   contour into runs coloured cyan / magenta / yellow so that the two edges of
+//   every corner share exactly one channel; smooth contours are white, and a
+//   one-corner "teardrop" contour is split into thirds
+// - Channel distance → nearest edge carrying that channel (ties → the edge
+//   more orthogonal to the texel), extended past its ends along the end
+//   tangents (pseudo-distance)
+// - True distance and sign → as the analytic path (exact distance, scanline
+//   winding); feeds error correction and the MTSDF alpha channel
+// - Error correction → texels whose channels clash with a neighbour, or whose
+//   median disagrees with the true sign, are flattened to the median / true
+//   distance
 //
-// Output format per curve: 8 floats (p0.x, p0.y, ctrl.x, ctrl.y, p2.x, p2.y, 0, 0)
-// outTypes[i]: always 2 (quadratic)
+// Output is RGBA32 (4 bytes per texel, bmp_pitch = bmp_width × 4 — the
+// GPU_UPLOAD_FMT_RGBA32 layout), padded by spread, bottom-up rows; each
+// channel uses the single-channel encoding (128 = edge, inside > 128).
+// UT_MSDF_MODE_MSDF writes 255 to alpha, UT_MSDF_MODE_MTSDF the true SDF
+// (for outlines / shadows that need real distance away from corners).
+// Channel distances saturate at the spread like the single-channel paths.
+
+#define UT_MSDF_MODE_MSDF   0
+#define UT_MSDF_MODE_MTSDF  1
+
+#define MSDF_RED      1
+#define MSDF_GREEN    2
+#define MSDF_BLUE     4
+#define MSDF_YELLOW   (MSDF_RED | MSDF_GREEN)
+#define MSDF_MAGENTA  (MSDF_RED | MSDF_BLUE)
+#define MSDF_CYAN     (MSDF_GREEN | MSDF_BLUE)
+#define MSDF_WHITE    (MSDF_RED | MSDF_GREEN | MSDF_BLUE)
+
+// sin(3 rad): a turn sharper than ~8° between two edges is a corner.
+#define MSDF_CORNER_CROSS 0.14112000806f
+
+struct msdf_edge {
+    float p0x, p0y, p1x, p1y, p2x, p2y;  // quadratic (a line carries p1 = midpoint)
+    float minx, miny, maxx, maxy;        // control-hull bbox
+    int line;
+    int color;                           // MSDF_* channel mask
+};
+
+struct msdf_dist {
+    float d;    // signed distance; sign follows the contour direction
+    float dot;  // |cos| between the end tangent and the end → texel offset (0 in the interior)
+    float t;    // parameter of the nearest point, projected past the ends (< 0 or > 1)
+};
+
+static void msdf_edge_set(msdf_edge* e, float x0, float y0, float cx, float cy, float x2, float y2) {
+    e->p0x = x0; e->p0y = y0; e->p1x = cx; e->p1y = cy; e->p2x = x2; e->p2y = y2;
+    float ax = cx - x0, ay = cy - y0;
+    float bx = x2 - 2.0f * cx + x0, by = y2 - 2.0f * cy + y0;
+    e->line = bx * bx + by * by <= (ax * ax + ay * ay) * 1e-8f;
+    e->minx = fminf(x0, fminf(cx, x2)); e->maxx = fmaxf(x0, fmaxf(cx, x2));
+    e->miny = fminf(y0, fminf(cy, y2)); e->maxy = fmaxf(y0, fmaxf(cy, y2));
+    e->color = MSDF_WHITE;
+}
 
-// Adaptive cubic→quadratic via recursive de Casteljau.
-// For cubic [P0,P1,P2,P3] the single-quad approximation has control point
-//   Q1 = (3*P1 + 3*P2 - P0 - P3) / 4
-// and max deviation from the cubic of |P3 - 3*P2 + 3*P1 - P0| * sqrt(3) / 36
-// (standard bound; squared form avoids sqrt). Recurses with depth cap to
-// prevent runaway on pathological inputs.
-static bool emit_cubic_as_quads(
-    float p0x, float p0y, float p1x, float p1y,
-    float p2x, float p2y, float p3x, float p3y,
-    float tolerance_sq, int depth,
-    int* curveIdx, int maxCurves,
-    float* outCurves, int* outTypes)
-{
-    float ex = p3x - 3.0f * p2x + 3.0f * p1x - p0x;
-    float ey = p3y - 3.0f * p2y + 3.0f * p1y - p0y;
-    float err_sq = (ex * ex + ey * ey) * (1.0f / 432.0f);
+// Tangent (unnormalized) at t = 0 / t = 1, falling back to the chord when the
+// control point sits on that end.
+static inline void msdf_edge_dir(const msdf_edge* e, int end, float* dx, float* dy) {
+    float x = end ? e->p2x - e->p1x : e->p1x - e->p0x;
+    float y = end ? e->p2y - e->p1y : e->p1y - e->p0y;
+    if (x == 0.0f && y == 0.0f) { x = e->p2x - e->p0x; y = e->p2y - e->p0y; }
+    *dx = x; *dy = y;
+}
 
-    if (err_sq <= tolerance_sq || depth >= 8) {
-        if (*curveIdx >= maxCurves) return false;
-        float q1x = (3.0f * p1x + 3.0f * p2x - p0x - p3x) * 0.25f;
-        float q1y = (3.0f * p1y + 3.0f * p2y - p0y - p3y) * 0.25f;
-        float* dst = outCurves + (*curveIdx) * 8;
-        dst[0] = p0x; dst[1] = p0y;
-        dst[2] = q1x; dst[3] = q1y;
-        dst[4] = p3x; dst[5] = p3y;
-        dst[6] = 0;   dst[7] = 0;
-        outTypes[*curveIdx] = 2;
-        (*curveIdx)++;
-        return true;
+static inline float msdf_nonzero_sign(float v) { return v > 0.0f ? 1.0f : -1.0f; }
+
+static inline float msdf_abs_cos(float ax, float ay, float bx, float by) {
+    float la = sqrtf(ax * ax + ay * ay), lb = sqrtf(bx * bx + by * by);
+    return la > 0.0f && lb > 0.0f ? fabsf((ax * bx + ay * by) / (la * lb)) : 0.0f;
+}
+
+static msdf_dist msdf_edge_distance(const msdf_edge* e, float px, float py) {
+    msdf_dist r;
+    if (e->line) {
+        float abx = e->p2x - e->p0x, aby = e->p2y - e->p0y;
+        float aqx = px - e->p0x, aqy = py - e->p0y;
+        float len_sq = abx * abx + aby * aby;
+        float t = len_sq > 0.0f ? (aqx * abx + aqy * aby) / len_sq : 0.0f;
+        float eqx = (t > 0.5f ? e->p2x : e->p0x) - px;
+        float eqy = (t > 0.5f ? e->p2y : e->p0y) - py;
+        float end = sqrtf(eqx * eqx + eqy * eqy);
+        float cr = aqx * aby - aqy * abx;
+        r.t = t;
+        if (t > 0.0f && t < 1.0f) {
+            float ortho = cr / sqrtf(len_sq);
+            if (fabsf(ortho) < end) { r.d = ortho; r.dot = 0.0f; return r; }
+        }
+        r.d = msdf_nonzero_sign(cr) * end;
+        r.dot = msdf_abs_cos(abx, aby, eqx, eqy);
+        return r;
+    }
+
+    // |B(t) - p|² stationary points: same cubic as sdf_quad_dist_sq.
+    float qax = e->p0x - px, qay = e->p0y - py;
+    float ax = e->p1x - e->p0x, ay = e->p1y - e->p0y;
+    float bx = e->p2x - 2.0f * e->p1x + e->p0x, by = e->p2y - 2.0f * e->p1y + e->p0y;
+    float d0x, d0y, d1x, d1y;
+    msdf_edge_dir(e, 0, &d0x, &d0y);
+    msdf_edge_dir(e, 1, &d1x, &d1y);
+
+    float best = sqrtf(qax * qax + qay * qay);
+    float d = msdf_nonzero_sign(d0x * qay - d0y * qax) * best;
+    float t = -(qax * d0x + qay * d0y) / (d0x * d0x + d0y * d0y);
+    float e2x = e->p2x - px, e2y = e->p2y - py;
+    float dist = sqrtf(e2x * e2x + e2y * e2y);
+    if (dist < best) {
+        best = dist;
+        d = msdf_nonzero_sign(d1x * e2y - d1y * e2x) * dist;
+        t = ((px - e->p1x) * d1x + (py - e->p1y) * d1y) / (d1x * d1x + d1y * d1y);
     }
 
-    float m01x = (p0x + p1x) * 0.5f,   m01y = (p0y + p1y) * 0.5f;
-    float m12x = (p1x + p2x) * 0.5f,   m12y = (p1y + p2y) * 0.5f;
-    float m23x = (p2x + p3x) * 0.5f,   m23y = (p2y + p3y) * 0.5f;
-    float m012x = (m01x + m12x) * 0.5f, m012y = (m01y + m12y) * 0.5f;
-    float m123x = (m12x + m23x) * 0.5f, m123y = (m12y + m23y) * 0.5f;
-    float mx = (m012x + m123x) * 0.5f,  my = (m012y + m123y) * 0.5f;
+    double inv_a = 1.0 / ((double)bx * bx + (double)by * by);
+    double cb = 3.0 * ((double)ax * bx + (double)ay * by) * inv_a;
+    double cc = (2.0 * ((double)ax * ax + (double)ay * ay) + (double)qax * bx + (double)qay * by) * inv_a;
+    double cd = ((double)qax * ax + (double)qay * ay) * inv_a;
+    double roots[3];
+    int n = sdf_solve_cubic_normed(cb, cc, cd, roots);
+    for (int i = 0; i < n; i++) {
+        float ti = (float)roots[i];
+        if (ti <= 0.0f || ti >= 1.0f) continue;
+        float qex = qax + ti * (2.0f * ax + ti * bx);
+        float qey = qay + ti * (2.0f * ay + ti * by);
+        dist = sqrtf(qex * qex + qey * qey);
+        if (dist <= best) {
+            float tx = ax + ti * bx, ty = ay + ti * by;
+            best = dist;
+            d = msdf_nonzero_sign(tx * qey - ty * qex) * dist;
+            t = ti;
+        }
+    }
 
-    if (!emit_cubic_as_quads(p0x, p0y, m01x, m01y, m012x, m012y, mx, my,
-                             tolerance_sq, depth + 1, curveIdx, maxCurves, outCurves, outTypes))
-        return false;
-    return emit_cubic_as_quads(mx, my, m123x, m123y, m23x, m23y, p3x, p3y,
-                               tolerance_sq, depth + 1, curveIdx, maxCurves, outCurves, outTypes);
+    r.d = d; r.t = t; r.dot = 0.0f;
+    if (t < 0.0f)      r.dot = msdf_abs_cos(d0x, d0y, qax, qay);
+    else if (t > 1.0f) r.dot = msdf_abs_cos(d1x, d1y, e2x, e2y);
+    return r;
 }
 
-UNITEXT_EXPORT int ut_ft_outline_decompose(FT_Face face, unsigned int glyph_index,
-                                            float* outCurves, int* outTypes,
-                                            int* outCurveCount, int maxCurves,
-                                            int* outContours, int* outContourCount, int maxContours,
-                                            int* outBearingX, int* outBearingY,
-                                            int* outAdvanceX, int* outWidth, int* outHeight)
-{
-    if (!face || !outCurves || !outTypes || !outCurveCount || !outContours || !outContourCount)
-        return -1;
+// Nearer edge wins; at equal distance (a shared corner) the more orthogonal one.
+static inline bool msdf_dist_less(const msdf_dist* a, const msdf_dist* b) {
+    float fa = fabsf(a->d), fb = fabsf(b->d);
+    return fa < fb || (fa == fb && a->dot < b->dot);
+}
+
+// Beyond an end, distance to the end's tangent line instead of the end point,
+// so the two channels of a corner keep straight edges through it.
+static float msdf_pseudo_distance(const msdf_edge* e, const msdf_dist* sd, float px, float py) {
+    float d = sd->d;
+    if (sd->t < 0.0f || sd->t > 1.0f) {
+        int end = sd->t > 1.0f;
+        float dx, dy;
+        msdf_edge_dir(e, end, &dx, &dy);
+        float len = sqrtf(dx * dx + dy * dy);
+        if (len > 0.0f) {
+            dx /= len; dy /= len;
+            float qx = px - (end ? e->p2x : e->p0x), qy = py - (end ? e->p2y : e->p0y);
+            float ts = qx * dx + qy * dy;
+            if (end ? ts > 0.0f : ts < 0.0f) {
+                float pd = qx * dy - qy * dx;
+                if (fabsf(pd) <= fabsf(d)) d = pd;
+            }
+        }
+    }
+    return d;
+}
 
-    FT_Error err = FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_BITMAP | FT_LOAD_NO_SCALE);
-    if (err) return (int)err;
+static inline bool msdf_is_corner(float ax, float ay, float bx, float by) {
+    float la = sqrtf(ax * ax + ay * ay), lb = sqrtf(bx * bx + by * by);
+    if (la <= 0.0f || lb <= 0.0f) return false;
+    float dot = (ax * bx + ay * by) / (la * lb);
+    float cr = (ax * by - ay * bx) / (la * lb);
+    return dot <= 0.0f || fabsf(cr) > MSDF_CORNER_CROSS;
+}
 
-    if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
-        *outCurveCount = 0;
-        *outContourCount = 0;
-        return 0;
+// Next colour in the cyan → magenta → yellow cycle that avoids `banned`.
+static void msdf_switch_color(int* color, unsigned* seed, int banned) {
+    int combined = *color & banned;
+    if (combined == MSDF_RED || combined == MSDF_GREEN || combined == MSDF_BLUE) {
+        *color = combined ^ MSDF_WHITE;
+        return;
     }
+    if (*color == 0 || *color == MSDF_WHITE) {
+        static const int start[3] = { MSDF_CYAN, MSDF_MAGENTA, MSDF_YELLOW };
+        *color = start[*seed % 3];
+        *seed /= 3;
+        return;
+    }
+    int shifted = *color << (1 + (*seed & 1));
+    *color = (shifted | shifted >> 3) & MSDF_WHITE;
+    *seed >>= 1;
+}
 
-    FT_Glyph_Metrics* m = &face->glyph->metrics;
-    if (outBearingX) *outBearingX = (int)(m->horiBearingX);
-    if (outBearingY) *outBearingY = (int)(m->horiBearingY);
-    if (outAdvanceX) *outAdvanceX = (int)(m->horiAdvance);
-    if (outWidth)    *outWidth    = (int)(m->width);
-    if (outHeight)   *outHeight   = (int)(m->height);
+static void msdf_edge_split(const msdf_edge* e, float t, msdf_edge* a, msdf_edge* b) {
+    float ax = e->p0x + (e->p1x - e->p0x) * t, ay = e->p0y + (e->p1y - e->p0y) * t;
+    float bx = e->p1x + (e->p2x - e->p1x) * t, by = e->p1y + (e->p2y - e->p1y) * t;
+    float mx = ax + (bx - ax) * t, my = ay + (by - ay) * t;
+    msdf_edge src = *e;  // a or b may alias e
+    msdf_edge_set(a, src.p0x, src.p0y, ax, ay, mx, my);
+    msdf_edge_set(b, mx, my, bx, by, src.p2x, src.p2y);
+}
 
-    FT_Outline* outline = &face->glyph->outline;
-    if (outline->n_points <= 0 || outline->n_contours <= 0) {
-        *outCurveCount = 0;
-        *outContourCount = 0;
-        return 0;
+// Colours edges[0, *count) of one closed contour in place. A teardrop with
+// fewer than three edges is split first, so *count can grow by up to 2.
+static void msdf_color_contour(msdf_edge* edges, int* count, int* corners) {
+    int m = *count;
+    int corner_count = 0;
+    float px, py;
+    msdf_edge_dir(&edges[m - 1], 1, &px, &py);
+    for (int i = 0; i < m; i++) {
+        float dx, dy;
+        msdf_edge_dir(&edges[i], 0, &dx, &dy);
+        if (msdf_is_corner(px, py, dx, dy)) corners[corner_count++] = i;
+        msdf_edge_dir(&edges[i], 1, &px, &py);
     }
 
-    // tolerance ≈ em / 1024 design units: sub-pixel even at 256-px SDF tiles
-    // (em/256 design units per pixel → tolerance is ~1/4 pixel of the tile).
-    float em = (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
-    float tolerance = em * (1.0f / 1024.0f);
-    float tolerance_sq = tolerance * tolerance;
+    unsigned seed = 0;
+    if (corner_count == 0) {
+        for (int i = 0; i < m; i++) edges[i].color = MSDF_WHITE;
+        return;
+    }
 
-    int curveIdx = 0;
-    int contourIdx = 0;
+    if (corner_count == 1) {
+        int colors[3] = { MSDF_WHITE, MSDF_WHITE, 0 };
+        msdf_switch_color(&colors[0], &seed, 0);
+        colors[2] = colors[0];
+        msdf_switch_color(&colors[2], &seed, 0);
+        int corner = corners[0];
+        if (m == 1) {
+            msdf_edge_split(&edges[0], 1.0f / 3.0f, &edges[0], &edges[1]);
+            msdf_edge_split(&edges[1], 0.5f, &edges[1], &edges[2]);
+            m = 3;
+        } else if (m == 2) {
+            msdf_edge_split(&edges[1], 0.5f, &edges[2], &edges[3]);
+            msdf_edge_split(&edges[0], 0.5f, &edges[0], &edges[1]);
+            corner *= 2;
+            m = 4;
+        }
+        // Symmetric thirds from the corner: first colour, white, second colour.
+        for (int i = 0; i < m; i++) {
+            int third = (int)(3.0 + 2.875 * i / (m - 1) - 1.4375 + 0.5) - 3;
+            edges[(corner + i) % m].color = colors[1 + third];
+        }
+        *count = m;
+        return;
+    }
 
-    #define EMIT_SEG(ax, ay, bx, by, cx, cy) do { \
-        if (curveIdx >= maxCurves) return -2; \
-        float* dst = outCurves + curveIdx * 8; \
-        dst[0] = (float)(ax); dst[1] = (float)(ay); \
-        dst[2] = (float)(bx); dst[3] = (float)(by); \
-        dst[4] = (float)(cx); dst[5] = (float)(cy); \
-        dst[6] = 0; dst[7] = 0; \
-        outTypes[curveIdx] = 2; \
-        curveIdx++; \
-    } while(0)
+    int spline = 0;
+    int start = corners[0];
+    int color = MSDF_WHITE;
+    msdf_switch_color(&color, &seed, 0);
+    int initial = color;
+    for (int i = 0; i < m; i++) {
+        int index = (start + i) % m;
+        if (spline + 1 < corner_count && corners[spline + 1] == index) {
+            ++spline;
+            msdf_switch_color(&color, &seed, spline == corner_count - 1 ? initial : 0);
+        }
+        edges[index].color = color;
+    }
+}
 
-    int contourStart = 0;
-    for (int c = 0; c < outline->n_contours; c++) {
-        int contourEnd = outline->contours[c];
-        int numPoints = contourEnd - contourStart + 1;
-        if (numPoints < 2) { contourStart = contourEnd + 1; continue; }
+static inline float msdf_median(float a, float b, float c) {
+    return fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+}
 
-        int contourCurveStart = curveIdx;
-        float startX, startY;
-        int firstOnCurve = -1;
-        for (int i = contourStart; i <= contourEnd; i++) {
-            if (outline->tags[i] & 1) { firstOnCurve = i; break; }
+// Neighbouring texels a, b clash when their channels change by more than one
+// texel of distance while disagreeing about which channel changes; only the
+// one farther from an edge is flagged (msdfgen's legacy clash test).
+static bool msdf_detect_clash(const float* a, const float* b, float threshold) {
+    float a0 = a[0], a1 = a[1], a2 = a[2];
+    float b0 = b[0], b1 = b[1], b2 = b[2];
+    float tmp;
+    if (fabsf(b0 - a0) < fabsf(b1 - a1)) {
+        tmp = a0; a0 = a1; a1 = tmp;
+        tmp = b0; b0 = b1; b1 = tmp;
+    }
+    if (fabsf(b1 - a1) < fabsf(b2 - a2)) {
+        tmp = a1; a1 = a2; a2 = tmp;
+        tmp = b1; b1 = b2; b2 = tmp;
+        if (fabsf(b0 - a0) < fabsf(b1 - a1)) {
+            tmp = a0; a0 = a1; a1 = tmp;
+            tmp = b0; b0 = b1; b1 = tmp;
         }
+    }
+    return fabsf(b1 - a1) >= threshold
+        && !(b0 == b1 && b0 == b2)
+        && fabsf(a2) >= fabsf(b2);
+}
 
-        if (firstOnCurve >= 0) {
-            startX = (float)outline->points[firstOnCurve].x;
-            startY = (float)outline->points[firstOnCurve].y;
-        } else {
-            startX = (outline->points[contourStart].x + outline->points[contourStart + 1].x) * 0.5f;
-            startY = (outline->points[contourStart].y + outline->points[contourStart + 1].y) * 0.5f;
-            firstOnCurve = contourStart;
+// One clash pass over the 4-float texels {r, g, b, true}: flag first, then
+// flatten flagged texels to their median. diagonal selects the neighbour set.
+static void msdf_fix_clashes(float* field, int pw, int ph, unsigned char* flags, bool diagonal) {
+    const float threshold = diagonal ? 1.001f * 1.41421356f : 1.001f;
+    for (int y = 0; y < ph; y++) {
+        for (int x = 0; x < pw; x++) {
+            const float* a = field + ((size_t)y * pw + x) * 4;
+            bool clash = false;
+            if (!diagonal) {
+                clash = (x > 0 && msdf_detect_clash(a, a - 4, threshold))
+                     || (x < pw - 1 && msdf_detect_clash(a, a + 4, threshold))
+                     || (y > 0 && msdf_detect_clash(a, a - (size_t)pw * 4, threshold))
+                     || (y < ph - 1 && msdf_detect_clash(a, a + (size_t)pw * 4, threshold));
+            } else {
+                const float* dn = a - (size_t)pw * 4;
+                const float* up = a + (size_t)pw * 4;
+                clash = (x > 0 && y > 0 && msdf_detect_clash(a, dn - 4, threshold))
+                     || (x < pw - 1 && y > 0 && msdf_detect_clash(a, dn + 4, threshold))
+                     || (x > 0 && y < ph - 1 && msdf_detect_clash(a, up - 4, threshold))
+                     || (x < pw - 1 && y < ph - 1 && msdf_detect_clash(a, up + 4, threshold));
+            }
+            flags[(size_t)y * pw + x] = clash;
         }
+    }
+    for (size_t i = 0; i < (size_t)pw * ph; i++) {
+        if (!flags[i]) continue;
+        float* t = field + i * 4;
+        t[0] = t[1] = t[2] = msdf_median(t[0], t[1], t[2]);
+    }
+}
 
-        float penX = startX, penY = startY;
-        int ii = firstOnCurve;
+static inline unsigned char msdf_quantize(float dist, float inv_spread) {
+    float val = 128.0f - dist * inv_spread;
+    val = val < -1.0f ? -1.0f : (val > 256.0f ? 256.0f : val);
+    int ival = (int)(val + 0.5f);
+    return (unsigned char)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
+}
 
-        for (int j = 0; j < numPoints; j++) {
-            int idx = contourStart + ((ii - contourStart + 1) % numPoints);
-            float px = (float)outline->points[idx].x;
-            float py = (float)outline->points[idx].y;
-            char tag = outline->tags[idx];
+UNITEXT_EXPORT int ut_ft_render_msdf_glyph(FT_Face face, unsigned int glyph_index,
+                                           int load_flags, int spread, int mode,
+                                           ut_sdf_glyph_result* out_result) {
+    sdf_workspace_scope workspace_scope;
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face || (mode != UT_MSDF_MODE_MSDF && mode != UT_MSDF_MODE_MTSDF)) {
+        out_result->success = -1;
+        return -1;
+    }
 
-            if (tag & 1) {
-                float mx = (penX + px) * 0.5f;
-                float my = (penY + py) * 0.5f;
-                EMIT_SEG(penX, penY, mx, my, px, py);
-                penX = px; penY = py;
-            } else if (tag & 2) {
-                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
-                int idx3 = contourStart + ((idx - contourStart + 2) % numPoints);
-                float p1x = px, p1y = py;
-                float p2x = (float)outline->points[idx2].x, p2y = (float)outline->points[idx2].y;
-                float p3x = (float)outline->points[idx3].x, p3y = (float)outline->points[idx3].y;
+    // Step 1: Load scaled outline (26.6)
+    FT_Error err = FT_Load_Glyph(face, glyph_index, load_flags);
+    if (err) { out_result->success = (int)err; return (int)err; }
 
-                if (!emit_cubic_as_quads(penX, penY, p1x, p1y, p2x, p2y, p3x, p3y,
-                                          tolerance_sq, 0, &curveIdx, maxCurves,
-                                          outCurves, outTypes))
-                    return -2;
+    // Bitmap-only glyphs (sbix/CBDT) have no edges to colour — widen the EDT
+    // result to RGBA (equal channels: median = the single-channel SDF).
+    if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
+        int rc = ut_ft_render_sdf_glyph(face, glyph_index, load_flags, spread, out_result);
+        if (rc || !out_result->bmp_buffer) return rc;
+        int w = out_result->bmp_width, h = out_result->bmp_height;
+        unsigned char* src = (unsigned char*)out_result->bmp_buffer;
+        unsigned char* rgba = (unsigned char*)malloc((size_t)w * h * 4);
+        if (!rgba) {
+            free(src);
+            memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+            out_result->success = -1;
+            return -1;
+        }
+        for (size_t i = 0; i < (size_t)w * h; i++) {
+            rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = src[i];
+            rgba[i * 4 + 3] = mode == UT_MSDF_MODE_MTSDF ? src[i] : 255;
+        }
+        free(src);
+        out_result->bmp_buffer = rgba;
+        out_result->bmp_pitch = w * 4;
+        return 0;
+    }
 
-                penX = p3x; penY = p3y;
-                j += 2;
-                ii = idx3;
-                continue;
-            } else {
-                int idx2 = contourStart + ((idx - contourStart + 1) % numPoints);
-                float p2x = (float)outline->points[idx2].x;
-                float p2y = (float)outline->points[idx2].y;
-                char tag2 = outline->tags[idx2];
+    // Step 2: Outline metrics (identical to the coverage path)
+    FT_Glyph_Metrics* m = &face->glyph->metrics;
+    out_result->metric_width     = (int)(m->width >> 6);
+    out_result->metric_height    = (int)(m->height >> 6);
+    out_result->metric_bearing_x = (int)(m->horiBearingX >> 6);
+    out_result->metric_bearing_y = (int)(m->horiBearingY >> 6);
+    out_result->metric_advance_x = (int)m->horiAdvance; // raw 26.6
 
-                float endX, endY;
-                if (tag2 & 1) {
-                    endX = p2x; endY = p2y;
-                    EMIT_SEG(penX, penY, px, py, endX, endY);
-                    penX = endX; penY = endY;
-                    j++;
-                    ii = idx2;
-                    continue;
-                } else {
-                    endX = (px + p2x) * 0.5f;
-                    endY = (py + p2y) * 0.5f;
-                    EMIT_SEG(penX, penY, px, py, endX, endY);
-                    penX = endX; penY = endY;
+    FT_Outline* outline = &face->glyph->outline;
+    FT_BBox cbox;
+    FT_Outline_Get_CBox(outline, &cbox);
+    int x_min = (int)(cbox.xMin >> 6), x_max = (int)((cbox.xMax + 63) >> 6);
+    int y_min = (int)(cbox.yMin >> 6), y_max = (int)((cbox.yMax + 63) >> 6);
+    int bw = outline->n_points > 0 ? x_max - x_min : 0;
+    int bh = outline->n_points > 0 ? y_max - y_min : 0;
+
+    // Zero-size glyph (space, control chars)
+    if (bw <= 0 || bh <= 0) {
+        out_result->bitmap_left = x_min;
+        out_result->bitmap_top  = y_max;
+        out_result->success = 0;
+        return 0;
+    }
+
+    // Step 3: Decompose into quadratics
+    float* curves;
+    int* contours;
+    int curve_count, contour_count;
+    err = sdf_decompose_scaled(outline, &curves, &curve_count, &contours, &contour_count);
+    if (err) { out_result->success = (int)err; return (int)err; }
+
+    int pw = bw + 2 * spread;
+    int ph = bh + 2 * spread;
+    int cw = (pw + SDF_ANALYTIC_CELL - 1) / SDF_ANALYTIC_CELL;
+    int ch = (ph + SDF_ANALYTIC_CELL - 1) / SDF_ANALYTIC_CELL;
+    int cells = cw * ch;
+    float cutoff = spread > 0 ? (float)spread : 1.0f;
+    float ox = (float)(x_min - spread), oy = (float)(y_min - spread);
+
+    // Step 4: Size the workspace (teardrop splits add up to 2 edges per contour)
+    int edge_cap = curve_count + 2 * contour_count;
+    size_t items = 0;
+    for (int i = 0; i < curve_count; i++) {
+        float box[4];
+        sdf_curve_box(curves + i * 8, ox, oy, box);
+        items += sdf_cells_touched(box, cutoff, cw, ch);
+    }
+    // A split edge lies inside its parent's control hull, so it bins into at
+    // most the parent's cells: three pieces per teardrop parent at worst.
+    items *= 3;
+
+    size_t texels = (size_t)pw * ph;
+    size_t ws_size = (size_t)edge_cap * sizeof(msdf_edge)
+                   + (size_t)curve_count * 2 * sizeof(sdf_ymono)
+                   + (size_t)curve_count * 2 * sizeof(sdf_crossing)
+                   + texels * 4 * sizeof(float)              // field {r, g, b, true}
+                   + (size_t)(cells + 1) * sizeof(int)       // cell_start
+                   + items * sizeof(int)                     // cell_items
+                   + items * sizeof(float)                   // cell_lb
+                   + (size_t)edge_cap * sizeof(int)          // corners
+                   + texels;                                 // clash flags
+    char* buf = sdf_workspace_reserve(&t_sdf_workspace, ws_size);
+    if (!buf) { out_result->success = -1; return -1; }
+
+    msdf_edge*    edges      = (msdf_edge*)buf;
+    sdf_ymono*    monos      = (sdf_ymono*)(edges + edge_cap);
+    sdf_crossing* xs         = (sdf_crossing*)(monos + curve_count * 2);
+    float*        field      = (float*)(xs + curve_count * 2);
+    int*          cell_start = (int*)(field + texels * 4);
+    int*          cell_items = cell_start + cells + 1;
+    float*        cell_lb    = (float*)(cell_items + items);
+    int*          corners    = (int*)(cell_lb + items);
+    unsigned char* flags     = (unsigned char*)(corners + edge_cap);
+
+    // Step 5: Edges per contour + colouring; y-monotone pieces for the sign
+    const float k26 = 1.0f / 64.0f;
+    int edge_count = 0, mono_count = 0, first = 0;
+    for (int k = 0; k < contour_count; k++) {
+        int last = contours[k];
+        int base = edge_count;
+        for (int i = first; i <= last; i++) {
+            const float* c = curves + i * 8;
+            float x0 = c[0] * k26 - ox, y0 = c[1] * k26 - oy;
+            float x1 = c[2] * k26 - ox, y1 = c[3] * k26 - oy;
+            float x2 = c[4] * k26 - ox, y2 = c[5] * k26 - oy;
+            msdf_edge_set(&edges[edge_count++], x0, y0, x1, y1, x2, y2);
+            sdf_ymono_split(monos, &mono_count, x0, y0, x1, y1, x2, y2);
+        }
+        int m = edge_count - base;
+        if (m > 0) {
+            msdf_color_contour(edges + base, &m, corners);
+            edge_count = base + m;
+        }
+        first = last + 1;
+    }
+
+    sdf_cells_fill(&edges[0].minx, sizeof(msdf_edge), edge_count, cutoff, cw, ch, cell_start, cell_items);
+
+    // Order each cell's list by cell-to-bbox lower bound (early exit below).
+    for (int cy = 0; cy < ch; cy++) {
+        for (int cx = 0; cx < cw; cx++) {
+            int c = cy * cw + cx;
+            float rx0 = (float)(cx * SDF_ANALYTIC_CELL), rx1 = rx0 + SDF_ANALYTIC_CELL;
+            float ry0 = (float)(cy * SDF_ANALYTIC_CELL), ry1 = ry0 + SDF_ANALYTIC_CELL;
+            for (int it = cell_start[c]; it < cell_start[c + 1]; it++) {
+                int ei = cell_items[it];
+                const msdf_edge* e = &edges[ei];
+                float dx = fmaxf(fmaxf(e->minx - rx1, rx0 - e->maxx), 0.0f);
+                float dy = fmaxf(fmaxf(e->miny - ry1, ry0 - e->maxy), 0.0f);
+                float lb = dx * dx + dy * dy;
+                int j = it;
+                while (j > cell_start[c] && cell_lb[j - 1] > lb) {
+                    cell_items[j] = cell_items[j - 1];
+                    cell_lb[j] = cell_lb[j - 1];
+                    j--;
                 }
+                cell_items[j] = ei;
+                cell_lb[j] = lb;
             }
-            ii = idx;
         }
+    }
 
-        if (penX != startX || penY != startY) {
-            float mx = (penX + startX) * 0.5f;
-            float my = (penY + startY) * 0.5f;
-            EMIT_SEG(penX, penY, mx, my, startX, startY);
-        }
+    // Edge distances are signed by contour direction; flip so that, for the
+    // outline's fill orientation, outside is positive like the SDF encoding.
+    float orient = FT_Outline_Get_Orientation(outline) == FT_ORIENTATION_TRUETYPE ? -1.0f : 1.0f;
+    bool even_odd = (outline->flags & FT_OUTLINE_EVEN_ODD_FILL) != 0;
 
-        if (curveIdx > contourCurveStart) {
-            if (contourIdx >= maxContours) return -3;
-            outContours[contourIdx++] = curveIdx - 1;
+    // Step 6: Per texel — nearest edge per channel, pseudo-distance, true distance
+    for (int y = 0; y < ph; y++) {
+        float yc = (float)y + 0.5f;
+        int nx = sdf_row_crossings(monos, mono_count, yc, xs);
+
+        const int* row_cells = cell_start + (y / SDF_ANALYTIC_CELL) * cw;
+        float* row = field + (size_t)y * pw * 4;
+        int winding = 0, xi = 0;
+        for (int x = 0; x < pw; x++) {
+            float xc = (float)x + 0.5f;
+            while (xi < nx && xs[xi].x < xc) winding += xs[xi++].dir;
+            bool inside = even_odd ? (winding & 1) != 0 : winding != 0;
+
+            msdf_dist best[3];
+            int best_edge[3] = { -1, -1, -1 };
+            for (int ci = 0; ci < 3; ci++) { best[ci].d = cutoff; best[ci].dot = 1.0f; best[ci].t = 0.0f; }
+            float worst_sq = cutoff * cutoff;
+
+            int cell = x / SDF_ANALYTIC_CELL;
+            for (int it = row_cells[cell]; it < row_cells[cell + 1]; it++) {
+                if (cell_lb[it] > worst_sq) break;
+                int ei = cell_items[it];
+                const msdf_edge* e = &edges[ei];
+                float dx = fmaxf(fmaxf(e->minx - xc, xc - e->maxx), 0.0f);
+                float dy = fmaxf(fmaxf(e->miny - yc, yc - e->maxy), 0.0f);
+                if (dx * dx + dy * dy > worst_sq) continue;
+                msdf_dist sd = msdf_edge_distance(e, xc, yc);
+                bool improved = false;
+                for (int ci = 0; ci < 3; ci++) {
+                    if (!(e->color & (1 << ci)) || !msdf_dist_less(&sd, &best[ci])) continue;
+                    best[ci] = sd;
+                    best_edge[ci] = ei;
+                    improved = true;
+                }
+                if (improved) {
+                    float w = fmaxf(fabsf(best[0].d), fmaxf(fabsf(best[1].d), fabsf(best[2].d)));
+                    worst_sq = w * w;
+                }
+            }
+
+            // Every edge carries at least two channels, so the true distance is
+            // the smallest channel winner; its sign comes from the winding.
+            float true_dist = fminf(fabsf(best[0].d), fminf(fabsf(best[1].d), fabsf(best[2].d)));
+            float* t = row + (size_t)x * 4;
+            for (int ci = 0; ci < 3; ci++) {
+                float d;
+                if (best_edge[ci] < 0) {
+                    d = inside ? -cutoff : cutoff;
+                } else {
+                    d = orient * msdf_pseudo_distance(&edges[best_edge[ci]], &best[ci], xc, yc);
+                    d = d < -cutoff ? -cutoff : (d > cutoff ? cutoff : d);
+                }
+                t[ci] = d;
+            }
+            t[3] = inside ? -true_dist : true_dist;
         }
+    }
 
-        contourStart = contourEnd + 1;
+    // Step 7: Error correction — neighbour clashes, then sign disagreements
+    msdf_fix_clashes(field, pw, ph, flags, false);
+    msdf_fix_clashes(field, pw, ph, flags, true);
+    for (size_t i = 0; i < texels; i++) {
+        float* t = field + i * 4;
+        if (msdf_median(t[0], t[1], t[2]) * t[3] < 0.0f) t[0] = t[1] = t[2] = t[3];
     }
 
-    #undef EMIT_SEG
+    // Step 8: Quantize to RGBA32 (rows already bottom-up)
+    unsigned char* rgba = (unsigned char*)malloc(texels * 4);
+    if (!rgba) { out_result->success = -1; return -1; }
+    float inv_spread = spread > 0 ? 128.0f / (float)spread : 128.0f;
+    for (size_t i = 0; i < texels; i++) {
+        const float* t = field + i * 4;
+        rgba[i * 4 + 0] = msdf_quantize(t[0], inv_spread);
+        rgba[i * 4 + 1] = msdf_quantize(t[1], inv_spread);
+        rgba[i * 4 + 2] = msdf_quantize(t[2], inv_spread);
+        rgba[i * 4 + 3] = mode == UT_MSDF_MODE_MTSDF ? msdf_quantize(t[3], inv_spread) : 255;
+    }
 
-    *outCurveCount = curveIdx;
-    *outContourCount = contourIdx;
+    // Step 9: Fill result
+    out_result->bmp_width   = pw;
+    out_result->bmp_height  = ph;
+    out_result->bmp_pitch   = pw * 4;
+    out_result->bitmap_left = x_min - spread;
+    out_result->bitmap_top  = y_max + spread;
+    out_result->bmp_buffer  = rgba;
+    out_result->success = 0;
     return 0;
 }
 
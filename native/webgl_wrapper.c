@@ -14,6 +14,7 @@
 #include <hb.h>
 #include <hb-ot.h>
 #include <hb-ft.h>
+#include "gpu_upload_common.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -179,43 +180,123 @@ EXPORT FT_GlyphSlot ut_ft_get_glyph_slot(FT_Face face) {
 
 #define EDT_INF 1e20f
 
-static void edt_1d(const float* f, float* d, int* v, float* z, int n) {
-    int k = 0;
-    v[0] = 0;
-    z[0] = -EDT_INF;
-    z[1] = +EDT_INF;
-    for (int q = 1; q < n; q++) {
-        float s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k])))
+// Narrow-band, in place: results below cutoff are exact (bit-identical to the
+// full transform), the rest stay >= cutoff. Sites are texels below cutoff,
+// minus the inside of zero runs; each parabola only writes the texels it owns
+// within reach of cutoff. fv[n] = site value scratch.
+static void edt_1d_band(float* f, float* fv, int* v, float* z, int n, float cutoff) {
+    int k = -1;
+    for (int q = 0; q < n; q++) {
+        float fq = f[q];
+        if (!(fq < cutoff)) continue;
+        if (fq == 0.0f && q > 0 && q < n - 1 && f[q - 1] == 0.0f && f[q + 1] == 0.0f) continue;
+        if (k < 0) {
+            k = 0;
+            v[0] = q;
+            fv[0] = fq;
+            z[0] = -EDT_INF;
+            z[1] = +EDT_INF;
+            continue;
+        }
+        float s = ((fq + (float)(q * q)) - (fv[k] + (float)(v[k] * v[k])))
                   / (float)(2 * q - 2 * v[k]);
         while (s <= z[k]) {
             k--;
-            s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k])))
+            s = ((fq + (float)(q * q)) - (fv[k] + (float)(v[k] * v[k])))
                 / (float)(2 * q - 2 * v[k]);
         }
         k++;
         v[k] = q;
+        fv[k] = fq;
         z[k] = s;
         z[k + 1] = +EDT_INF;
     }
-    k = 0;
-    for (int q = 0; q < n; q++) {
-        while (z[k + 1] < (float)q) k++;
-        d[q] = (float)((q - v[k]) * (q - v[k])) + f[v[k]];
+    if (k < 0) return;
+
+    if ((k + 1) * 8 > n) {
+        k = 0;
+        for (int q = 0; q < n; q++) {
+            while (z[k + 1] < (float)q) k++;
+            if (f[q] != 0.0f) f[q] = (float)((q - v[k]) * (q - v[k])) + fv[k];
+        }
+        return;
+    }
+
+    for (int j = 0; j <= k; j++) {
+        float reach = sqrtf(cutoff - fv[j]);
+        float lo = fmaxf(fmaxf(floorf(z[j]) + 1.0f, ceilf((float)v[j] - reach)), 0.0f);
+        float hi = fminf(fminf(floorf(z[j + 1]), floorf((float)v[j] + reach)), (float)(n - 1));
+        for (int q = (int)lo; q <= (int)hi; q++)
+            if (f[q] != 0.0f) f[q] = (float)((q - v[j]) * (q - v[j])) + fv[j];
     }
 }
 
-// 2D squared EDT in-place. grid[w*h], row-major.
+// 2D squared EDT in-place. grid[w*h], row-major. Exact below cutoff (squared).
 // Caller provides workspace: f[maxdim], d[maxdim], z[maxdim+1], v[maxdim].
-static void edt_2d(float* grid, int w, int h, float* f, float* d, float* z, int* v) {
+static void edt_2d(float* grid, int w, int h, float* f, float* d, float* z, int* v, float cutoff) {
     for (int x = 0; x < w; x++) {
         for (int y = 0; y < h; y++) f[y] = grid[y * w + x];
-        edt_1d(f, d, v, z, h);
-        for (int y = 0; y < h; y++) grid[y * w + x] = d[y];
+        edt_1d_band(f, d, v, z, h, cutoff);
+        for (int y = 0; y < h; y++) grid[y * w + x] = f[y];
     }
-    for (int y = 0; y < h; y++) {
-        edt_1d(grid + y * w, d, v, z, w);
-        memcpy(grid + y * w, d, w * sizeof(float));
+    for (int y = 0; y < h; y++) edt_1d_band(grid + y * w, d, v, z, w, cutoff);
+}
+
+// Squared narrow-band cutoff: one texel beyond where R8/R16 saturate.
+static float sdf_band_cutoff(int spread) {
+    float r = (float)(spread > 0 ? spread : 1) + 1.0f;
+    return r * r;
+}
+
+// === SDF Workspace ===
+// Grown to the largest glyph seen and reused. Single-threaded: one static
+// default workspace stands in for the native per-thread one, held to the same
+// retain limit after each render.
+
+#define SDF_WORKSPACE_RETAIN_DEFAULT (4 << 20)
+
+typedef struct ut_sdf_workspace {
+    char* buf;
+    size_t cap;
+} ut_sdf_workspace;
+
+static ut_sdf_workspace g_sdf_workspace;
+static long g_sdf_workspace_retain = SDF_WORKSPACE_RETAIN_DEFAULT;
+
+static char* sdf_workspace_reserve(ut_sdf_workspace* ws, size_t size) {
+    if (size > ws->cap) {
+        size_t grown = ws->cap + ws->cap / 2;
+        if (grown > size) size = grown;
+        free(ws->buf);
+        ws->buf = (char*)malloc(size);
+        ws->cap = ws->buf ? size : 0;
     }
+    return ws->buf;
+}
+
+static void sdf_workspace_trim(ut_sdf_workspace* ws, long retain) {
+    if (retain < 0 || ws->cap <= (size_t)retain) return;
+    free(ws->buf);
+    ws->buf = NULL;
+    ws->cap = 0;
+}
+
+EXPORT void ut_sdf_set_workspace_retain_limit(long max_bytes) {
+    g_sdf_workspace_retain = max_bytes;
+}
+
+EXPORT void ut_sdf_release_thread_workspace(void) {
+    sdf_workspace_trim(&g_sdf_workspace, 0);
+}
+
+EXPORT ut_sdf_workspace* ut_sdf_workspace_create(void) {
+    return (ut_sdf_workspace*)calloc(1, sizeof(ut_sdf_workspace));
+}
+
+EXPORT void ut_sdf_workspace_destroy(ut_sdf_workspace* ws) {
+    if (!ws) return;
+    free(ws->buf);
+    free(ws);
 }
 
 // === Combined SDF Glyph Render (FT_RENDER_MODE_NORMAL + EDT) ===
@@ -230,15 +311,16 @@ typedef struct {
     void* bmp_buffer;
 } ut_sdf_glyph_result;
 
-EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
-                                   int load_flags, int spread,
-                                   ut_sdf_glyph_result* out_result) {
-    if (!out_result) return -1;
-    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
-    if (!face) { out_result->success = -1; return -1; }
+// Load + rasterize, then seed and transform the padded fields inside ws.
+// *out_outside stays NULL for zero-size glyphs.
+static int sdf_render_fields(FT_Face face, unsigned int glyph_index, int load_flags, int spread,
+                             float cutoff, ut_sdf_workspace* ws, ut_sdf_glyph_result* out_result,
+                             float** out_outside, float** out_inside) {
+    *out_outside = NULL;
+    *out_inside  = NULL;
 
     FT_Error err = FT_Load_Glyph(face, glyph_index, load_flags);
-    if (err) { out_result->success = (int)err; return (int)err; }
+    if (err) return (int)err;
 
     FT_Glyph_Metrics* m = &face->glyph->metrics;
     out_result->metric_width     = (int)(m->width >> 6);
@@ -248,7 +330,7 @@ EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
     out_result->metric_advance_x = (int)m->horiAdvance;
 
     err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
-    if (err) { out_result->success = (int)err; return (int)err; }
+    if (err) return (int)err;
 
     FT_Bitmap* b = &face->glyph->bitmap;
     int bw = (int)b->width;
@@ -257,7 +339,6 @@ EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
     if (bw <= 0 || bh <= 0) {
         out_result->bitmap_left = face->glyph->bitmap_left;
         out_result->bitmap_top  = face->glyph->bitmap_top;
-        out_result->success = 0;
         return 0;
     }
 
@@ -266,15 +347,14 @@ EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
     int pcount = pw * ph;
     int maxdim = pw > ph ? pw : ph;
 
-    // One malloc for all workspace: outside + inside + edt_f + edt_d + edt_z + edt_v
     size_t ws_size = (size_t)pcount * sizeof(float) * 2    // outside + inside
                    + (size_t)maxdim * sizeof(float) * 2    // edt_f + edt_d
                    + (size_t)(maxdim + 1) * sizeof(float)  // edt_z
                    + (size_t)maxdim * sizeof(int);          // edt_v
-    char* ws = (char*)malloc(ws_size);
-    if (!ws) { out_result->success = -1; return -1; }
+    char* buf = sdf_workspace_reserve(ws, ws_size);
+    if (!buf) return -1;
 
-    float* outside = (float*)ws;
+    float* outside = (float*)buf;
     float* inside  = outside + pcount;
     float* edt_f   = inside + pcount;
     float* edt_d   = edt_f + maxdim;
@@ -305,41 +385,397 @@ EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
         }
     }
 
-    edt_2d(outside, pw, ph, edt_f, edt_d, edt_z, edt_v);
-    edt_2d(inside, pw, ph, edt_f, edt_d, edt_z, edt_v);
+    edt_2d(outside, pw, ph, edt_f, edt_d, edt_z, edt_v, cutoff);
+    edt_2d(inside, pw, ph, edt_f, edt_d, edt_z, edt_v, cutoff);
 
-    unsigned char* sdf = (unsigned char*)malloc(pcount);
-    if (!sdf) { free(ws); out_result->success = -1; return -1; }
+    out_result->bmp_width   = pw;
+    out_result->bmp_height  = ph;
+    out_result->bitmap_left = face->glyph->bitmap_left - spread;
+    out_result->bitmap_top  = face->glyph->bitmap_top + spread;
+    *out_outside = outside;
+    *out_inside  = inside;
+    return 0;
+}
 
+// Alpha8 quantize with Y-flip; dst rows are dst_pitch bytes apart.
+static void sdf_quantize_fields(const float* outside, const float* inside, int pw, int ph, int spread,
+                                unsigned char* dst, int dst_pitch) {
     float inv_spread = spread > 0 ? 128.0f / (float)spread : 128.0f;
 
     for (int y = 0; y < ph; y++) {
         int src_row = y * pw;
-        int dst_row = (ph - 1 - y) * pw;  // Y-flip
+        unsigned char* dst_row = dst + (ph - 1 - y) * dst_pitch;  // Y-flip
         for (int x = 0; x < pw; x++) {
             float dist = sqrtf(outside[src_row + x]) - sqrtf(inside[src_row + x]);
             float val = 128.0f - dist * inv_spread;
+            val = val < -1.0f ? -1.0f : (val > 256.0f ? 256.0f : val);
             int ival = (int)(val + 0.5f);
-            sdf[dst_row + x] = (unsigned char)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
+            dst_row[x] = (unsigned char)(ival < 0 ? 0 : (ival > 255 ? 255 : ival));
         }
     }
+}
 
-    free(ws);
+// IEEE half from float, round-to-nearest-even (overflow -> +-inf).
+static uint16_t sdf_float_to_half(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000u;
+    x &= 0x7fffffffu;
+    if (x >= 0x47800000u)
+        return (uint16_t)(sign | (x > 0x7f800000u ? 0x7e00u : 0x7c00u));
+    if (x < 0x38800000u) {
+        float a;
+        memcpy(&a, &x, sizeof(a));
+        a += 0.5f;
+        memcpy(&x, &a, sizeof(x));
+        return (uint16_t)(sign | (x - 0x3f000000u));
+    }
+    uint32_t odd = (x >> 13) & 1u;
+    x += 0xc8000fffu + odd;
+    return (uint16_t)(sign | (x >> 13));
+}
 
-    out_result->bmp_width   = pw;
-    out_result->bmp_height  = ph;
-    out_result->bmp_pitch   = pw;
-    out_result->bitmap_left = face->glyph->bitmap_left - spread;
-    out_result->bitmap_top  = face->glyph->bitmap_top + spread;
-    out_result->bmp_buffer  = sdf;
+static int sdf_format_bpp(int format) {
+    switch (format) {
+        case GPU_UPLOAD_FMT_R8:    return 1;
+        case GPU_UPLOAD_FMT_R16:   return 2;
+        case GPU_UPLOAD_FMT_RHALF: return 2;
+        default:                   return 0;
+    }
+}
+
+// R8 = Alpha8, R16 = unorm16 (32768 = edge), RHALF = unclamped signed pixels.
+static void sdf_encode_fields(const float* outside, const float* inside, int pw, int ph, int spread,
+                              int format, unsigned char* dst, int dst_pitch) {
+    if (format == GPU_UPLOAD_FMT_R8) {
+        sdf_quantize_fields(outside, inside, pw, ph, spread, dst, dst_pitch);
+        return;
+    }
+    float inv_spread = spread > 0 ? 32768.0f / (float)spread : 32768.0f;
+    for (int y = 0; y < ph; y++) {
+        const float* o = outside + y * pw;
+        const float* in = inside + y * pw;
+        uint16_t* row = (uint16_t*)(dst + (ph - 1 - y) * dst_pitch);
+        for (int x = 0; x < pw; x++) {
+            if (format == GPU_UPLOAD_FMT_RHALF) {
+                row[x] = sdf_float_to_half(sqrtf(in[x]) - sqrtf(o[x]));
+            } else {
+                float val = 32768.0f - (sqrtf(o[x]) - sqrtf(in[x])) * inv_spread;
+                val = val < 0.0f ? 0.0f : (val > 65535.0f ? 65535.0f : val);
+                row[x] = (uint16_t)(val + 0.5f);
+            }
+        }
+    }
+}
+
+static int sdf_render_glyph(FT_Face face, unsigned int glyph_index,
+                             int load_flags, int spread,
+                             ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face) { out_result->success = -1; return -1; }
+
+    float* outside;
+    float* inside;
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, sdf_band_cutoff(spread),
+                                &g_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    unsigned char* sdf = (unsigned char*)malloc((size_t)pw * ph);
+    if (!sdf) { out_result->success = -1; return -1; }
+
+    sdf_quantize_fields(outside, inside, pw, ph, spread, sdf, pw);
+
+    out_result->bmp_pitch  = pw;
+    out_result->bmp_buffer = sdf;
     out_result->success = 0;
     return 0;
 }
 
+EXPORT int ut_ft_render_sdf_glyph(FT_Face face, unsigned int glyph_index,
+                                   int load_flags, int spread,
+                                   ut_sdf_glyph_result* out_result) {
+    int rc = sdf_render_glyph(face, glyph_index, load_flags, spread, out_result);
+    sdf_workspace_trim(&g_sdf_workspace, g_sdf_workspace_retain);
+    return rc;
+}
+
+static int sdf_render_glyph_format(FT_Face face, unsigned int glyph_index,
+                                    int load_flags, int spread, int format,
+                                    ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    int bpp = sdf_format_bpp(format);
+    if (!face || !bpp) { out_result->success = -1; return -1; }
+
+    float* outside;
+    float* inside;
+    float cutoff = format == GPU_UPLOAD_FMT_RHALF ? EDT_INF : sdf_band_cutoff(spread);
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, cutoff,
+                                &g_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    unsigned char* sdf = (unsigned char*)malloc((size_t)pw * ph * bpp);
+    if (!sdf) { out_result->success = -1; return -1; }
+
+    sdf_encode_fields(outside, inside, pw, ph, spread, format, sdf, pw * bpp);
+
+    out_result->bmp_pitch  = pw * bpp;
+    out_result->bmp_buffer = sdf;
+    out_result->success = 0;
+    return 0;
+}
+
+EXPORT int ut_ft_render_sdf_glyph_format(FT_Face face, unsigned int glyph_index,
+                                          int load_flags, int spread, int format,
+                                          ut_sdf_glyph_result* out_result) {
+    int rc = sdf_render_glyph_format(face, glyph_index, load_flags, spread, format, out_result);
+    sdf_workspace_trim(&g_sdf_workspace, g_sdf_workspace_retain);
+    return rc;
+}
+
+static int sdf_render_glyph_into(FT_Face face, unsigned int glyph_index,
+                                  int load_flags, int spread, ut_sdf_workspace* ws,
+                                  unsigned char* dst, int dst_capacity,
+                                  ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face) { out_result->success = -1; return -1; }
+
+    float* outside;
+    float* inside;
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, sdf_band_cutoff(spread),
+                                ws ? ws : &g_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    if (!dst || dst_capacity < 0 || (size_t)dst_capacity < (size_t)pw * ph) {
+        out_result->success = -2;
+        return -2;
+    }
+
+    sdf_quantize_fields(outside, inside, pw, ph, spread, dst, pw);
+
+    out_result->bmp_pitch  = pw;
+    out_result->bmp_buffer = dst;
+    out_result->success = 0;
+    return 0;
+}
+
+EXPORT int ut_ft_render_sdf_glyph_into(FT_Face face, unsigned int glyph_index,
+                                        int load_flags, int spread, ut_sdf_workspace* ws,
+                                        unsigned char* dst, int dst_capacity,
+                                        ut_sdf_glyph_result* out_result) {
+    int rc = sdf_render_glyph_into(face, glyph_index, load_flags, spread, ws, dst, dst_capacity, out_result);
+    sdf_workspace_trim(&g_sdf_workspace, g_sdf_workspace_retain);
+    return rc;
+}
+
+// Writes the Y-flipped Alpha8 SDF in place into an atlas page region (rows
+// dst_row_pitch bytes apart). Returns -2 if the padded glyph does not fit.
+static int sdf_render_glyph_to_region(FT_Face face, unsigned int glyph_index,
+                                        int load_flags, int spread, ut_sdf_workspace* ws,
+                                        unsigned char* dst, int dst_width, int dst_height,
+                                        int dst_row_pitch, int dst_x, int dst_y,
+                                        ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face || !dst || dst_width <= 0 || dst_height <= 0 || dst_row_pitch < dst_width
+        || dst_x < 0 || dst_y < 0) {
+        out_result->success = -1;
+        return -1;
+    }
+    // Nothing fits at an origin outside the page; reject before rendering.
+    if (dst_x >= dst_width || dst_y >= dst_height) {
+        out_result->success = -2;
+        return -2;
+    }
+
+    float* outside;
+    float* inside;
+    int err = sdf_render_fields(face, glyph_index, load_flags, spread, sdf_band_cutoff(spread),
+                                ws ? ws : &g_sdf_workspace, out_result, &outside, &inside);
+    if (err) { out_result->success = err; return err; }
+    if (!outside) return 0;
+
+    int pw = out_result->bmp_width;
+    int ph = out_result->bmp_height;
+    if (pw > dst_width - dst_x || ph > dst_height - dst_y) {
+        out_result->success = -2;
+        return -2;
+    }
+
+    unsigned char* region = dst + (size_t)dst_y * dst_row_pitch + dst_x;
+    sdf_quantize_fields(outside, inside, pw, ph, spread, region, dst_row_pitch);
+
+    out_result->bmp_pitch  = dst_row_pitch;
+    out_result->bmp_buffer = region;
+    out_result->success = 0;
+    return 0;
+}
+
+EXPORT int ut_ft_render_sdf_glyph_to_region(FT_Face face, unsigned int glyph_index,
+                                              int load_flags, int spread, ut_sdf_workspace* ws,
+                                              unsigned char* dst, int dst_width, int dst_height,
+                                              int dst_row_pitch, int dst_x, int dst_y,
+                                              ut_sdf_glyph_result* out_result) {
+    int rc = sdf_render_glyph_to_region(face, glyph_index, load_flags, spread, ws, dst, dst_width, dst_height, dst_row_pitch, dst_x, dst_y, out_result);
+    sdf_workspace_trim(&g_sdf_workspace, g_sdf_workspace_retain);
+    return rc;
+}
+
+// Analytic mode is native-only (code size); not available on WebGL.
+EXPORT int ut_ft_render_sdf_glyph_analytic(FT_Face face, unsigned int glyph_index,
+                                            int load_flags, int spread,
+                                            ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    out_result->success = -1;
+    return -1;
+}
+
+// MSDF is native-only (code size); not available on WebGL.
+EXPORT int ut_ft_render_msdf_glyph(FT_Face face, unsigned int glyph_index,
+                                   int load_flags, int spread, int mode,
+                                   ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    out_result->success = -1;
+    return -1;
+}
+
+#define UT_SDF_BACKEND_EDT      0
+#define UT_SDF_BACKEND_FT_SDF   1
+#define UT_SDF_BACKEND_FT_BSDF  2
+#define UT_SDF_BACKEND_ANALYTIC 3
+
+// The WebGL FreeType build has no sdf / bsdf modules and no analytic path, so
+// only the coverage EDT backend is available; the others return -1.
+EXPORT int ut_ft_render_sdf_glyph_ex(FT_Face face, unsigned int glyph_index,
+                                      int load_flags, int spread, int backend,
+                                      ut_sdf_glyph_result* out_result) {
+    if (!out_result) return -1;
+    memset(out_result, 0, sizeof(ut_sdf_glyph_result));
+    if (!face || backend != UT_SDF_BACKEND_EDT) { out_result->success = -1; return -1; }
+    return ut_ft_render_sdf_glyph(face, glyph_index, load_flags, spread, out_result);
+}
+
+typedef struct {
+    double us_per_glyph;
+    float max_error;
+    float mean_error;
+    int glyphs;
+    int failures;
+} ut_sdf_bench_stats;
+
+// Not available on WebGL.
+EXPORT int ut_sdf_bench_backend(FT_Face face, const unsigned int* glyphs, int count,
+                                int load_flags, int spread, int backend, int iterations,
+                                ut_sdf_bench_stats* out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(ut_sdf_bench_stats));
+    return -1;
+}
+
+typedef struct {
+    double us_float;
+    double us_int;
+    int max_diff;
+    float mean_diff;
+    long long texels;
+    long long differing;
+    int glyphs;
+    int failures;
+} ut_sdf_edt_bench_stats;
+
+// Not available on WebGL.
+EXPORT int ut_sdf_bench_edt_glyphs(FT_Face face, const unsigned int* glyphs, int count,
+                                   int load_flags, int spread, int format, int iterations,
+                                   ut_sdf_edt_bench_stats* out_stats) {
+    if (out_stats) memset(out_stats, 0, sizeof(ut_sdf_edt_bench_stats));
+    return -1;
+}
+
+// No persistent file system on WebGL — the SDF cache never opens and cached
+// renders go straight to the renderer.
+typedef struct ut_sdf_cache ut_sdf_cache;
+
+EXPORT unsigned long long ut_sdf_cache_font_hash(const void* data, long size) {
+    return 0;
+}
+
+EXPORT ut_sdf_cache* ut_sdf_cache_open(const char* path) {
+    return NULL;
+}
+
+EXPORT void ut_sdf_cache_close(ut_sdf_cache* cache) {
+}
+
+EXPORT int ut_sdf_cache_count(ut_sdf_cache* cache) {
+    return 0;
+}
+
+EXPORT int ut_ft_render_sdf_glyph_cached(ut_sdf_cache* cache, unsigned long long font_hash,
+                                          FT_Face face, unsigned int glyph_index, int load_flags,
+                                          int spread, int backend, ut_sdf_glyph_result* out_result) {
+    return ut_ft_render_sdf_glyph_ex(face, glyph_index, load_flags, spread, backend, out_result);
+}
+
 EXPORT void ut_ft_free_sdf_buffer(void* buffer) {
     free(buffer);
 }
 
+// No threads on WebGL — the batch renders sequentially on the calling face.
+EXPORT int ut_ft_render_sdf_glyphs_batch(FT_Face face, const unsigned int* glyph_indices, int count,
+                                          int pixel_size, int load_flags, int spread,
+                                          int max_threads, ut_sdf_glyph_result* out_results) {
+    if (!face || !glyph_indices || !out_results || count < 0) return -1;
+    if (pixel_size > 0) {
+        FT_Error err = FT_Set_Pixel_Sizes(face, 0, (FT_UInt)pixel_size);
+        if (err) return (int)err;
+    }
+    int first_error = 0;
+    for (int i = 0; i < count; i++) {
+        int err = ut_ft_render_sdf_glyph(face, glyph_indices[i], load_flags, spread, &out_results[i]);
+        if (err && !first_error) first_error = err;
+    }
+    return first_error;
+}
+
+// No face clones on WebGL.
+EXPORT void ut_ft_release_sdf_clones(void) {
+}
+
+// No threads on WebGL — single glyphs always run a serial EDT.
+EXPORT void ut_ft_set_sdf_parallel_threshold(int pixel_count) {
+}
+
+// WebGL keeps the float EDT — wasm float division is not the bottleneck there.
+EXPORT void ut_ft_set_sdf_integer_edt(int enabled) {
+}
+
+// WebGL builds without SIMD intrinsics — the SDF passes always run scalar.
+EXPORT const char* ut_ft_get_sdf_kernel_name(void) {
+    return "scalar";
+}
+
+// Not available on WebGL.
+EXPORT double ut_sdf_bench_edt(int size, int iterations, int variant) {
+    return -1.0;
+}
+
+// Not available on WebGL.
+EXPORT int ut_sdf_check_edt_fix(int max_spread) {
+    return -1;
+}
+
 // =============================================================================
 // HarfBuzz Unified API (ut_hb_*)
 // =============================================================================
@@ -420,6 +856,14 @@ EXPORT void ut_hb_buffer_add_codepoints(hb_buffer_t* buffer, const unsigned int*
     hb_buffer_add_codepoints(buffer, text, text_length, item_offset, item_length);
 }
 
+EXPORT void ut_hb_buffer_add_utf16(hb_buffer_t* buffer, const uint16_t* text, int text_length, unsigned int item_offset, int item_length) {
+    hb_buffer_add_utf16(buffer, text, text_length, item_offset, item_length);
+}
+
+EXPORT void ut_hb_buffer_add_utf8(hb_buffer_t* buffer, const char* text, int text_length, unsigned int item_offset, int item_length) {
+    hb_buffer_add_utf8(buffer, text, text_length, item_offset, item_length);
+}
+
 EXPORT unsigned int ut_hb_buffer_get_length(const hb_buffer_t* buffer) {
     return hb_buffer_get_length(buffer);
 }
@@ -432,6 +876,131 @@ EXPORT hb_glyph_position_t* ut_hb_buffer_get_glyph_positions(hb_buffer_t* buffer
     return hb_buffer_get_glyph_positions(buffer, length);
 }
 
+// Shape plan cache (see unitext_native.cpp): compiled plans per hb_face_t,
+// keyed by segment properties, features and normalized coords, run through
+// hb_shape_plan_execute, off by default. Single-threaded here, so no lock and
+// no hash.
+#define SHAPE_PLAN_CACHE_SLOTS 32
+
+typedef struct {
+    unsigned int last_use;
+    hb_segment_properties_t props;
+    hb_feature_t* features;
+    unsigned int num_features;
+    int* coords;
+    unsigned int num_coords;
+    hb_shape_plan_t* plan;
+} shape_plan_entry;
+
+typedef struct {
+    shape_plan_entry entries[SHAPE_PLAN_CACHE_SLOTS];
+    int count;
+    unsigned int clock;
+} shape_plan_cache;
+
+static hb_user_data_key_t g_shape_plan_cache_key;
+static int g_shape_plan_cache_enabled = 0;
+static unsigned int g_shape_plan_hits = 0;
+static unsigned int g_shape_plan_misses = 0;
+
+static void shape_plan_entry_free(shape_plan_entry* e) {
+    hb_shape_plan_destroy(e->plan);
+    free(e->features);
+    free(e->coords);
+    memset(e, 0, sizeof(*e));
+}
+
+static void shape_plan_cache_destroy(void* data) {
+    shape_plan_cache* c = (shape_plan_cache*)data;
+    for (int i = 0; i < c->count; i++) shape_plan_entry_free(&c->entries[i]);
+    free(c);
+}
+
+static shape_plan_cache* shape_plan_cache_of(hb_face_t* face) {
+    shape_plan_cache* c = (shape_plan_cache*)hb_face_get_user_data(face, &g_shape_plan_cache_key);
+    if (c) return c;
+    c = (shape_plan_cache*)calloc(1, sizeof(shape_plan_cache));
+    if (!c) return NULL;
+    if (!hb_face_set_user_data(face, &g_shape_plan_cache_key, c, shape_plan_cache_destroy, 0)) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+static void shape_with_plan_cache(hb_font_t* font, hb_buffer_t* buffer,
+                                  const hb_feature_t* features, unsigned int num_features) {
+    hb_face_t* face = hb_font_get_face(font);
+    shape_plan_cache* c = g_shape_plan_cache_enabled && hb_buffer_get_length(buffer) > 0
+                        ? shape_plan_cache_of(face) : NULL;
+    if (!c) {
+        hb_shape(font, buffer, features, num_features);
+        return;
+    }
+    if (!features) num_features = 0;
+
+    hb_segment_properties_t props;
+    hb_buffer_get_segment_properties(buffer, &props);
+    unsigned int num_coords = 0;
+    const int* coords = hb_font_get_var_coords_normalized(font, &num_coords);
+    if (!coords) num_coords = 0;
+
+    shape_plan_entry* hit = NULL;
+    for (int i = 0; i < c->count && !hit; i++) {
+        shape_plan_entry* e = &c->entries[i];
+        if (e->props.direction == props.direction && e->props.script == props.script
+            && e->props.language == props.language
+            && e->num_features == num_features && e->num_coords == num_coords
+            && (!num_features || memcmp(e->features, features, num_features * sizeof(hb_feature_t)) == 0)
+            && (!num_coords || memcmp(e->coords, coords, num_coords * sizeof(int)) == 0))
+            hit = e;
+    }
+
+    if (hit) {
+        g_shape_plan_hits++;
+    } else {
+        g_shape_plan_misses++;
+        shape_plan_entry e;
+        memset(&e, 0, sizeof(e));
+        e.props = props;
+        e.num_features = num_features;
+        e.num_coords = num_coords;
+        e.features = num_features ? (hb_feature_t*)malloc(num_features * sizeof(hb_feature_t)) : NULL;
+        e.coords = num_coords ? (int*)malloc(num_coords * sizeof(int)) : NULL;
+        if ((num_features && !e.features) || (num_coords && !e.coords)) {
+            shape_plan_entry_free(&e);
+            hb_shape(font, buffer, features, num_features);
+            return;
+        }
+        if (num_features) memcpy(e.features, features, num_features * sizeof(hb_feature_t));
+        if (num_coords) memcpy(e.coords, coords, num_coords * sizeof(int));
+        e.plan = hb_shape_plan_create2(face, &props, features, num_features, coords, num_coords, NULL);
+
+        int slot = c->count;
+        if (slot == SHAPE_PLAN_CACHE_SLOTS) {
+            slot = 0;
+            for (int i = 1; i < c->count; i++)
+                if (c->entries[i].last_use < c->entries[slot].last_use) slot = i;
+            shape_plan_entry_free(&c->entries[slot]);
+        } else {
+            c->count++;
+        }
+        c->entries[slot] = e;
+        hit = &c->entries[slot];
+    }
+    hit->last_use = ++c->clock;
+    hb_shape_plan_execute(hit->plan, font, buffer, features, num_features);
+}
+
+EXPORT void ut_hb_shape_plan_cache_set_enabled(int enabled) {
+    g_shape_plan_cache_enabled = enabled ? 1 : 0;
+}
+
+EXPORT void ut_hb_shape_plan_cache_stats(unsigned int* out_hits, unsigned int* out_misses) {
+    if (out_hits) *out_hits = g_shape_plan_hits;
+    if (out_misses) *out_misses = g_shape_plan_misses;
+}
+
 EXPORT void ut_hb_shape(hb_font_t* font, hb_buffer_t* buffer, const hb_feature_t* features, unsigned int num_features) {
     hb_shape(font, buffer, features, num_features);
 }
@@ -449,7 +1018,7 @@ EXPORT int ut_hb_shape_run(
     hb_buffer_set_script(buffer, (hb_script_t)script_tag);
     hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
     hb_buffer_add_codepoints(buffer, codepoints, text_length, item_offset, item_length);
-    hb_shape(font, buffer, features, num_features);
+    shape_with_plan_cache(font, buffer, features, num_features);
     unsigned int count = 0;
     *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
     *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
@@ -480,13 +1049,588 @@ EXPORT int ut_hb_shape_run_lang(
         hb_buffer_set_language(buffer, language);
     hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
     hb_buffer_add_codepoints(buffer, codepoints, text_length, item_offset, item_length);
-    hb_shape(font, buffer, features, num_features);
+    shape_with_plan_cache(font, buffer, features, num_features);
+    unsigned int count = 0;
+    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
+    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
+    return (int)count;
+}
+
+// ut_hb_shape_run_lang over UTF-16 text (e.g. a pinned C# string), without a
+// managed UTF-32 copy. item_offset/item_length and the returned clusters are
+// UTF-16 code units; unpaired surrogates shape as U+FFFD.
+EXPORT int ut_hb_shape_run_utf16(
+    hb_font_t* font, hb_buffer_t* buffer,
+    const uint16_t* text, int text_length,
+    unsigned int item_offset, int item_length,
+    hb_direction_t direction, unsigned int script_tag, hb_language_t language, unsigned int flags,
+    const hb_feature_t* features, unsigned int num_features,
+    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, direction);
+    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
+    if (language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
+    hb_buffer_add_utf16(buffer, text, text_length, item_offset, item_length);
+    shape_with_plan_cache(font, buffer, features, num_features);
     unsigned int count = 0;
     *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
     *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
     return (int)count;
 }
 
+// ut_hb_shape_run_lang over UTF-8 text. item_offset/item_length and the
+// returned clusters are bytes; invalid sequences shape as U+FFFD.
+EXPORT int ut_hb_shape_run_utf8(
+    hb_font_t* font, hb_buffer_t* buffer,
+    const char* text, int text_length,
+    unsigned int item_offset, int item_length,
+    hb_direction_t direction, unsigned int script_tag, hb_language_t language, unsigned int flags,
+    const hb_feature_t* features, unsigned int num_features,
+    hb_glyph_info_t** out_infos, hb_glyph_position_t** out_positions)
+{
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, direction);
+    hb_buffer_set_script(buffer, (hb_script_t)script_tag);
+    if (language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)flags);
+    hb_buffer_add_utf8(buffer, text, text_length, item_offset, item_length);
+    shape_with_plan_cache(font, buffer, features, num_features);
+    unsigned int count = 0;
+    *out_infos = hb_buffer_get_glyph_infos(buffer, &count);
+    *out_positions = hb_buffer_get_glyph_positions(buffer, &count);
+    return (int)count;
+}
+
+// --- Batched runs ---
+//
+// A paragraph's script/font runs shaped in one call, glyphs packed into a
+// caller-owned array instead of handed out as pointers into hb_buffer_t
+// internals (which the next run would invalidate). Records follow run order,
+// and within a run HarfBuzz's output order (visual, so RTL runs come out
+// reversed).
+
+#include <limits.h>
+
+typedef struct {
+    hb_font_t* font;
+    unsigned int offset;            // item_offset into the batch's text, in code units
+    int length;                     // item_length; -1 = to the end of the text
+    hb_direction_t direction;
+    unsigned int script_tag;
+    hb_language_t language;         // HB_LANGUAGE_INVALID = buffer default
+    unsigned int flags;             // hb_buffer_flags_t
+    const hb_feature_t* features;
+    unsigned int num_features;
+} ut_hb_run;
+
+typedef struct {
+    unsigned int glyph_id;
+    unsigned int cluster;
+    int x_advance;
+    int y_advance;
+    int x_offset;
+    int y_offset;
+    int run_index;
+} ut_hb_glyph;
+
+// Batch text in one of HarfBuzz's input encodings. Offsets, lengths and
+// clusters are all in its code units.
+typedef struct {
+    const void* data;
+    int length;
+    int unit;       // bytes per code unit: 4 = codepoints, 2 = UTF-16, 1 = UTF-8
+} hb_text;
+
+static unsigned int hb_text_at(const hb_text* t, unsigned int i) {
+    if (t->unit == 4) return ((const unsigned int*)t->data)[i];
+    if (t->unit == 2) return ((const uint16_t*)t->data)[i];
+    return ((const unsigned char*)t->data)[i];
+}
+
+// Code units [offset, offset + length) as a text of their own.
+static hb_text hb_text_slice(const hb_text* t, unsigned int offset, unsigned int length) {
+    hb_text s = { (const char*)t->data + (size_t)offset * t->unit, (int)length, t->unit };
+    return s;
+}
+
+static int hb_run_valid(const ut_hb_run* run, int text_length) {
+    if (!run->font || run->offset > (unsigned int)text_length) return 0;
+    return run->length < 0 || (unsigned int)run->length <= (unsigned int)text_length - run->offset;
+}
+
+// Shapes one run into buffer; returns its glyph count.
+static unsigned int hb_shape_run_into(hb_buffer_t* buffer, const hb_text* text, const ut_hb_run* run) {
+    hb_buffer_clear_contents(buffer);
+    hb_buffer_set_direction(buffer, run->direction);
+    hb_buffer_set_script(buffer, (hb_script_t)run->script_tag);
+    if (run->language != HB_LANGUAGE_INVALID)
+        hb_buffer_set_language(buffer, run->language);
+    hb_buffer_set_flags(buffer, (hb_buffer_flags_t)run->flags);
+    if (text->unit == 2)
+        hb_buffer_add_utf16(buffer, (const uint16_t*)text->data, text->length, run->offset, run->length);
+    else if (text->unit == 1)
+        hb_buffer_add_utf8(buffer, (const char*)text->data, text->length, run->offset, run->length);
+    else
+        hb_buffer_add_codepoints(buffer, (const hb_codepoint_t*)text->data, text->length, run->offset, run->length);
+    shape_with_plan_cache(run->font, buffer, run->features, run->num_features);
+    return hb_buffer_get_length(buffer);
+}
+
+// --- Word cache ---
+//
+// Same as the native word cache: an opt-in LRU of segments (a word plus its
+// trailing spaces) shaped on their own, spliced into ut_hb_shape_runs_batch
+// output only across boundaries HarfBuzz marks safe to concat, and only for
+// runs that start and end at a space or the text ends. Single-threaded here,
+// so no lock; FNV-1a instead of the native hash.
+
+#define WORD_CACHE_BUCKETS 4096
+#define WORD_CACHE_MAX_LENGTH 64    // code units; longer segments (unspaced scripts) shape the run whole
+
+typedef struct word_cache_entry {
+    unsigned long long hash;
+    unsigned long long font_id;
+    unsigned int font_serial;
+    hb_segment_properties_t props;
+    unsigned int flags;
+    unsigned int length;        // code units
+    int unit;                   // bytes per code unit
+    unsigned int num_features;
+    unsigned int num_coords;
+    unsigned int glyph_count;
+    int start_safe;             // logical first glyph clear of UNSAFE_TO_CONCAT
+    int end_safe;               // logical last glyph clear of UNSAFE_TO_CONCAT
+    size_t bytes;
+    struct word_cache_entry* hash_next;
+    struct word_cache_entry* lru_prev;    // toward most recent
+    struct word_cache_entry* lru_next;    // toward least recent
+    // Followed by features[num_features], coords[num_coords], glyphs[glyph_count]
+    // (clusters relative to the segment, visual order) and the segment's
+    // length * unit text bytes.
+} word_cache_entry;
+
+typedef struct {
+    unsigned long long hash;
+    unsigned long long font_id;
+    unsigned int font_serial;
+    hb_segment_properties_t props;
+    unsigned int flags;
+    const void* text;
+    unsigned int length;
+    int unit;
+    const hb_feature_t* features;
+    unsigned int num_features;
+    const int* coords;
+    unsigned int num_coords;
+} word_cache_key;
+
+static word_cache_entry* g_word_buckets[WORD_CACHE_BUCKETS];
+static word_cache_entry* g_word_lru_head = NULL;   // most recent
+static word_cache_entry* g_word_lru_tail = NULL;
+static size_t g_word_max_bytes = 0;
+static size_t g_word_used_bytes = 0;
+static int g_word_entries = 0;
+static unsigned int g_word_cache_hits = 0;
+static unsigned int g_word_cache_misses = 0;
+static unsigned int g_word_cache_fallbacks = 0;
+static unsigned long long g_word_next_font_id = 1;
+static hb_user_data_key_t g_word_cache_font_key;
+
+static unsigned long long word_hash(const void* data, size_t size, unsigned long long h) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+static hb_feature_t* word_entry_features(word_cache_entry* e) { return (hb_feature_t*)(e + 1); }
+static int* word_entry_coords(word_cache_entry* e) { return (int*)(word_entry_features(e) + e->num_features); }
+static ut_hb_glyph* word_entry_glyphs(word_cache_entry* e) {
+    return (ut_hb_glyph*)(word_entry_coords(e) + e->num_coords);
+}
+static char* word_entry_text(word_cache_entry* e) { return (char*)(word_entry_glyphs(e) + e->glyph_count); }
+
+// Per-font id that is never reused (hb_font_t addresses are). 0 for inert fonts.
+static unsigned long long word_cache_font_id(hb_font_t* font) {
+    unsigned long long* id = (unsigned long long*)hb_font_get_user_data(font, &g_word_cache_font_key);
+    if (id) return *id;
+    id = (unsigned long long*)malloc(sizeof(unsigned long long));
+    if (!id) return 0;
+    *id = g_word_next_font_id++;
+    if (!hb_font_set_user_data(font, &g_word_cache_font_key, id, free, 0)) {
+        free(id);
+        return 0;
+    }
+    return *id;
+}
+
+static int word_cache_entry_matches(word_cache_entry* e, const word_cache_key* k) {
+    return e->hash == k->hash && e->font_id == k->font_id && e->font_serial == k->font_serial
+        && e->props.direction == k->props.direction && e->props.script == k->props.script
+        && e->props.language == k->props.language && e->flags == k->flags
+        && e->length == k->length && e->unit == k->unit
+        && e->num_features == k->num_features && e->num_coords == k->num_coords
+        && memcmp(word_entry_text(e), k->text, (size_t)k->length * k->unit) == 0
+        && (!k->num_features || memcmp(word_entry_features(e), k->features, k->num_features * sizeof(hb_feature_t)) == 0)
+        && (!k->num_coords || memcmp(word_entry_coords(e), k->coords, k->num_coords * sizeof(int)) == 0);
+}
+
+static void word_cache_unlink(word_cache_entry* e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next; else g_word_lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev; else g_word_lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void word_cache_push_front(word_cache_entry* e) {
+    e->lru_prev = NULL;
+    e->lru_next = g_word_lru_head;
+    if (g_word_lru_head) g_word_lru_head->lru_prev = e; else g_word_lru_tail = e;
+    g_word_lru_head = e;
+}
+
+static void word_cache_evict(word_cache_entry* e) {
+    word_cache_entry** link = &g_word_buckets[e->hash & (WORD_CACHE_BUCKETS - 1)];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+    word_cache_unlink(e);
+    g_word_used_bytes -= e->bytes;
+    g_word_entries--;
+    free(e);
+}
+
+static word_cache_entry* word_cache_find(const word_cache_key* k) {
+    for (word_cache_entry* e = g_word_buckets[k->hash & (WORD_CACHE_BUCKETS - 1)]; e; e = e->hash_next) {
+        if (!word_cache_entry_matches(e, k)) continue;
+        if (g_word_lru_head != e) {
+            word_cache_unlink(e);
+            word_cache_push_front(e);
+        }
+        return e;
+    }
+    return NULL;
+}
+
+static word_cache_entry* word_cache_insert(const word_cache_key* k, int start_safe, int end_safe,
+                                           const hb_glyph_info_t* infos, const hb_glyph_position_t* pos,
+                                           unsigned int glyph_count) {
+    size_t bytes = sizeof(word_cache_entry) + k->num_features * sizeof(hb_feature_t)
+                 + k->num_coords * sizeof(int) + glyph_count * sizeof(ut_hb_glyph)
+                 + (size_t)k->length * k->unit;
+    // Evict from the cold end; a single segment over the cap still gets cached.
+    while (g_word_lru_tail && g_word_used_bytes + bytes > g_word_max_bytes) word_cache_evict(g_word_lru_tail);
+    word_cache_entry* e = (word_cache_entry*)malloc(bytes);
+    if (!e) return NULL;
+    memset(e, 0, sizeof(word_cache_entry));
+    e->hash = k->hash;
+    e->font_id = k->font_id;
+    e->font_serial = k->font_serial;
+    e->props = k->props;
+    e->flags = k->flags;
+    e->length = k->length;
+    e->unit = k->unit;
+    e->num_features = k->num_features;
+    e->num_coords = k->num_coords;
+    e->glyph_count = glyph_count;
+    e->start_safe = start_safe;
+    e->end_safe = end_safe;
+    e->bytes = bytes;
+    if (k->num_features) memcpy(word_entry_features(e), k->features, k->num_features * sizeof(hb_feature_t));
+    if (k->num_coords) memcpy(word_entry_coords(e), k->coords, k->num_coords * sizeof(int));
+    ut_hb_glyph* g = word_entry_glyphs(e);
+    for (unsigned int i = 0; i < glyph_count; i++) {
+        g[i].glyph_id  = infos[i].codepoint;
+        g[i].cluster   = infos[i].cluster;
+        g[i].x_advance = pos[i].x_advance;
+        g[i].y_advance = pos[i].y_advance;
+        g[i].x_offset  = pos[i].x_offset;
+        g[i].y_offset  = pos[i].y_offset;
+        g[i].run_index = 0;
+    }
+    memcpy(word_entry_text(e), k->text, (size_t)k->length * k->unit);
+    word_cache_entry** bucket = &g_word_buckets[k->hash & (WORD_CACHE_BUCKETS - 1)];
+    e->hash_next = *bucket;
+    *bucket = e;
+    word_cache_push_front(e);
+    g_word_used_bytes += bytes;
+    g_word_entries++;
+    return e;
+}
+
+static int word_glyph_unsafe(const hb_glyph_info_t* info) {
+    return (hb_glyph_info_get_glyph_flags(info) & (HB_GLYPH_FLAG_UNSAFE_TO_BREAK | HB_GLYPH_FLAG_UNSAFE_TO_CONCAT)) != 0;
+}
+
+static unsigned int* g_word_bounds = NULL;
+static size_t g_word_bounds_cap = 0;
+static ut_hb_glyph* g_word_staged = NULL;
+static size_t g_word_staged_cap = 0;
+static size_t g_word_staged_count = 0;
+
+static int word_reserve(void** buf, size_t* cap, size_t count, size_t elem) {
+    if (count <= *cap) return 1;
+    size_t grown = *cap + *cap / 2;
+    if (grown < count) grown = count;
+    void* p = realloc(*buf, grown * elem);
+    if (!p) return 0;
+    *buf = p;
+    *cap = grown;
+    return 1;
+}
+
+// Shapes `run` segment by segment through the word cache into g_word_staged
+// (run order, like hb_shape output). Returns 0 when the run has to be shaped
+// whole instead.
+static int word_cache_shape_run(hb_buffer_t* buffer, const hb_text* text, const ut_hb_run* run, int run_index) {
+    unsigned int start = run->offset;
+    unsigned int end = run->length < 0 ? (unsigned int)text->length : start + (unsigned int)run->length;
+    if (start == end) return 0;
+    if (start > 0 && hb_text_at(text, start - 1) != ' ') return 0;
+    if (end < (unsigned int)text->length && hb_text_at(text, end) != ' ' && hb_text_at(text, end - 1) != ' ')
+        return 0;
+
+    unsigned long long font_id = word_cache_font_id(run->font);
+    if (!font_id) return 0;
+
+    // Segment boundaries: after each run of spaces.
+    size_t n_bounds = 0;
+    if (!word_reserve((void**)&g_word_bounds, &g_word_bounds_cap, 1, sizeof(unsigned int))) return 0;
+    g_word_bounds[n_bounds++] = start;
+    for (unsigned int i = start; i < end;) {
+        while (i < end && hb_text_at(text, i) != ' ') i++;
+        while (i < end && hb_text_at(text, i) == ' ') i++;
+        if (i - g_word_bounds[n_bounds - 1] > WORD_CACHE_MAX_LENGTH) return 0;
+        if (!word_reserve((void**)&g_word_bounds, &g_word_bounds_cap, n_bounds + 1, sizeof(unsigned int))) return 0;
+        g_word_bounds[n_bounds++] = i;
+    }
+
+    word_cache_key k;
+    k.font_id = font_id;
+    k.font_serial = hb_font_get_serial(run->font);
+    k.props.direction = run->direction;
+    k.props.script = (hb_script_t)run->script_tag;
+    k.props.language = run->language;
+    k.features = run->num_features ? run->features : NULL;
+    k.num_features = k.features ? run->num_features : 0;
+    k.coords = hb_font_get_var_coords_normalized(run->font, &k.num_coords);
+    if (!k.coords) k.num_coords = 0;
+    k.unit = text->unit;
+    unsigned long long seed[6] = { font_id, k.font_serial, (unsigned long long)run->direction,
+                                   (unsigned long long)run->script_tag, (unsigned long long)(uintptr_t)run->language,
+                                   (unsigned long long)text->unit };
+    unsigned long long base_hash = word_hash(seed, sizeof(seed), 0xcbf29ce484222325ULL);
+    base_hash = word_hash(k.features, k.num_features * sizeof(hb_feature_t), base_hash);
+    base_hash = word_hash(k.coords, k.num_coords * sizeof(int), base_hash);
+
+    int backward = HB_DIRECTION_IS_BACKWARD(run->direction);
+    int segments = (int)n_bounds - 1;
+    g_word_staged_count = 0;
+    for (int s = 0; s < segments; s++) {
+        // HarfBuzz emits backward runs in visual order, last segment first.
+        int seg = backward ? segments - 1 - s : s;
+        unsigned int seg_start = g_word_bounds[seg], seg_end = g_word_bounds[seg + 1];
+        unsigned int flags = (run->flags & ~(unsigned int)(HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT))
+                           | HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT;
+        if (seg_start == start) flags |= run->flags & HB_BUFFER_FLAG_BOT;
+        if (seg_end == end)     flags |= run->flags & HB_BUFFER_FLAG_EOT;
+        k.flags = flags;
+        hb_text seg_text = hb_text_slice(text, seg_start, seg_end - seg_start);
+        k.text = seg_text.data;
+        k.length = seg_end - seg_start;
+        k.hash = word_hash(&flags, sizeof(flags), word_hash(k.text, (size_t)k.length * k.unit, base_hash));
+
+        // The run's own ends are buffer ends either way; only splices need checking.
+        int need_start = seg_start != start, need_end = seg_end != end;
+        word_cache_entry* e = word_cache_find(&k);
+        int hit = e != NULL;
+        if (!e) {
+            g_word_cache_misses++;
+            ut_hb_run seg_run = *run;
+            seg_run.offset = 0;
+            seg_run.length = (int)k.length;
+            seg_run.flags = flags;
+            unsigned int n = hb_shape_run_into(buffer, &seg_text, &seg_run);
+            const hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, NULL);
+            const hb_glyph_position_t* pos = hb_buffer_get_glyph_positions(buffer, NULL);
+            int start_safe = n > 0 && !word_glyph_unsafe(&infos[backward ? n - 1 : 0]);
+            int end_safe   = n > 0 && !word_glyph_unsafe(&infos[backward ? 0 : n - 1]);
+            e = word_cache_insert(&k, start_safe, end_safe, infos, pos, n);
+            if (!e) return 0;
+        }
+        if ((need_start && !e->start_safe) || (need_end && !e->end_safe)) return 0;
+        if (hit) g_word_cache_hits++;
+
+        if (!word_reserve((void**)&g_word_staged, &g_word_staged_cap, g_word_staged_count + e->glyph_count,
+                          sizeof(ut_hb_glyph)))
+            return 0;
+        const ut_hb_glyph* g = word_entry_glyphs(e);
+        ut_hb_glyph* dst = g_word_staged + g_word_staged_count;
+        for (unsigned int i = 0; i < e->glyph_count; i++) {
+            dst[i] = g[i];
+            dst[i].cluster += seg_start;
+            dst[i].run_index = run_index;
+        }
+        g_word_staged_count += e->glyph_count;
+    }
+    return 1;
+}
+
+EXPORT void ut_hb_word_cache_enable(long max_bytes) {
+    g_word_max_bytes = max_bytes > 0 ? (size_t)max_bytes : 0;
+    while (g_word_lru_tail && g_word_used_bytes > g_word_max_bytes) word_cache_evict(g_word_lru_tail);
+}
+
+EXPORT void ut_hb_word_cache_stats(int* out_entries, long* out_bytes, unsigned int* out_hits,
+                                   unsigned int* out_misses, unsigned int* out_fallbacks) {
+    if (out_entries)   *out_entries   = g_word_entries;
+    if (out_bytes)     *out_bytes     = (long)g_word_used_bytes;
+    if (out_hits)      *out_hits      = g_word_cache_hits;
+    if (out_misses)    *out_misses    = g_word_cache_misses;
+    if (out_fallbacks) *out_fallbacks = g_word_cache_fallbacks;
+}
+
+static int hb_shape_runs(hb_buffer_t* buffer, const hb_text* text, const ut_hb_run* runs, int run_count,
+                         ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    if (out_glyph_count) *out_glyph_count = 0;
+    if (!buffer || !out_glyph_count || text->length < 0 || (text->length && !text->data)
+        || run_count < 0 || (run_count && !runs) || capacity < 0 || (capacity && !out_glyphs))
+        return -1;
+    for (int r = 0; r < run_count; r++)
+        if (!hb_run_valid(&runs[r], text->length)) return -1;
+
+    size_t total = 0;
+    for (int r = 0; r < run_count; r++) {
+        if (g_word_max_bytes) {
+            if (word_cache_shape_run(buffer, text, &runs[r], r)) {
+                if (total < (size_t)capacity) {
+                    size_t fit = (size_t)capacity - total < g_word_staged_count
+                               ? (size_t)capacity - total : g_word_staged_count;
+                    memcpy(out_glyphs + total, g_word_staged, fit * sizeof(ut_hb_glyph));
+                }
+                total += g_word_staged_count;
+                continue;
+            }
+            g_word_cache_fallbacks++;
+        }
+        unsigned int n = hb_shape_run_into(buffer, text, &runs[r]);
+        if (total < (size_t)capacity) {
+            const hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, NULL);
+            const hb_glyph_position_t* pos = hb_buffer_get_glyph_positions(buffer, NULL);
+            size_t fit = (size_t)capacity - total < n ? (size_t)capacity - total : n;
+            ut_hb_glyph* dst = out_glyphs + total;
+            for (size_t i = 0; i < fit; i++) {
+                dst[i].glyph_id  = infos[i].codepoint;
+                dst[i].cluster   = infos[i].cluster;
+                dst[i].x_advance = pos[i].x_advance;
+                dst[i].y_advance = pos[i].y_advance;
+                dst[i].x_offset  = pos[i].x_offset;
+                dst[i].y_offset  = pos[i].y_offset;
+                dst[i].run_index = r;
+            }
+        }
+        total += n;
+    }
+    if (total > INT_MAX) return -1;
+    *out_glyph_count = (int)total;
+    return total > (size_t)capacity ? -2 : 0;
+}
+
+// Shapes runs[run_count] over codepoints[text_length] (every run sees the
+// whole text as context) through `buffer`, writing up to `capacity` records
+// to out_glyphs. *out_glyph_count is always the total the batch produced.
+// Returns 0, -1 on bad args, or -2 when the total exceeds capacity — the
+// records that fit are written, so a sizing pass is a call with
+// capacity 0 / out_glyphs NULL, then grow and retry. Served from the word
+// cache when it is enabled.
+EXPORT int ut_hb_shape_runs_batch(hb_buffer_t* buffer, const unsigned int* codepoints, int text_length,
+                                  const ut_hb_run* runs, int run_count,
+                                  ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    hb_text text = { codepoints, text_length, 4 };
+    return hb_shape_runs(buffer, &text, runs, run_count, out_glyphs, capacity, out_glyph_count);
+}
+
+// Same over UTF-16 text: run offsets/lengths and glyph clusters are UTF-16 code units.
+EXPORT int ut_hb_shape_runs_batch_utf16(hb_buffer_t* buffer, const uint16_t* text, int text_length,
+                                        const ut_hb_run* runs, int run_count,
+                                        ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    hb_text t = { text, text_length, 2 };
+    return hb_shape_runs(buffer, &t, runs, run_count, out_glyphs, capacity, out_glyph_count);
+}
+
+// Same over UTF-8 text: run offsets/lengths and glyph clusters are bytes.
+EXPORT int ut_hb_shape_runs_batch_utf8(hb_buffer_t* buffer, const char* text, int text_length,
+                                       const ut_hb_run* runs, int run_count,
+                                       ut_hb_glyph* out_glyphs, int capacity, int* out_glyph_count) {
+    hb_text t = { text, text_length, 1 };
+    return hb_shape_runs(buffer, &t, runs, run_count, out_glyphs, capacity, out_glyph_count);
+}
+
+// --- Parallel paragraphs ---
+//
+// No threads on WebGL — paragraphs are shaped in order through one buffer.
+
+typedef struct {
+    const void* text;
+    int text_length;            // code units
+    int text_unit;              // bytes per code unit: 4 (or 0) = code points, 2 = UTF-16, 1 = UTF-8
+    const ut_hb_run* runs;      // buffer flags (BOT/EOT, ...) come from each run's flags
+    int run_count;
+    // Buffer settings; all zero = HarfBuzz's defaults
+    int cluster_level;          // hb_buffer_cluster_level_t
+    unsigned int replacement;   // code point for invalid UTF-8/16; 0 = U+FFFD
+    unsigned int invisible;     // glyph for default ignorables; 0 = the space glyph
+    unsigned int not_found;     // glyph for unmapped code points
+    ut_hb_glyph* out_glyphs;    // this paragraph's slice
+    int capacity;
+    int glyph_count;            // out: total the paragraph produced
+    int result;                 // out: ut_hb_shape_runs_batch return value
+} ut_hb_paragraph;
+
+static hb_buffer_t* g_paragraph_buffer = NULL;
+
+// Shapes one paragraph through buffer, applying its buffer settings first
+// (the buffer is reused, so every paragraph sets all of them).
+static void hb_paragraph_shape(hb_buffer_t* buffer, ut_hb_paragraph* p) {
+    int unit = p->text_unit ? p->text_unit : 4;
+    if (unit != 1 && unit != 2 && unit != 4) {
+        p->glyph_count = 0;
+        p->result = -1;
+        return;
+    }
+    hb_buffer_set_cluster_level(buffer, (hb_buffer_cluster_level_t)p->cluster_level);
+    hb_buffer_set_replacement_codepoint(buffer, p->replacement ? p->replacement : HB_BUFFER_REPLACEMENT_CODEPOINT_DEFAULT);
+    hb_buffer_set_invisible_glyph(buffer, p->invisible);
+    hb_buffer_set_not_found_glyph(buffer, p->not_found);
+    hb_text t = { p->text, p->text_length, unit };
+    p->result = hb_shape_runs(buffer, &t, p->runs, p->run_count, p->out_glyphs, p->capacity, &p->glyph_count);
+}
+
+EXPORT int ut_hb_shape_paragraphs(ut_hb_paragraph* paragraphs, int count, int max_threads) {
+    if (!paragraphs || count < 0) return -1;
+    if (count == 0) return 0;
+    if (!g_paragraph_buffer) {
+        g_paragraph_buffer = hb_buffer_create();
+        if (!hb_buffer_allocation_successful(g_paragraph_buffer)) {
+            hb_buffer_destroy(g_paragraph_buffer);
+            g_paragraph_buffer = NULL;
+            for (int i = 0; i < count; i++) {
+                paragraphs[i].glyph_count = 0;
+                paragraphs[i].result = -1;
+            }
+            return -1;
+        }
+    }
+    int first_error = 0;
+    for (int i = 0; i < count; i++) {
+        ut_hb_paragraph* p = &paragraphs[i];
+        hb_paragraph_shape(g_paragraph_buffer, p);
+        if (p->result && !first_error) first_error = p->result;
+    }
+    return first_error;
+}
+
 // =============================================================================
 // HarfBuzz Variable Font API (ut_hb_*)
 // =============================================================================
@@ -680,6 +1824,467 @@ EXPORT int ut_ft_outline_decompose(FT_Face face, unsigned int glyph_index,
     return 0;
 }
 
+// Packed curves (see unitext_native.cpp): 6 × uint16 per quadratic, contour
+// ends flagged in bit 0 of ctrl.x.
+#define UT_CURVE_FORMAT_I16  1
+#define UT_CURVE_FORMAT_HALF 2
+
+EXPORT int ut_curves_pack(const float* curves, int curve_count,
+                          const int* contour_ends, int contour_count,
+                          int format, float scale, uint16_t* out) {
+    if (curve_count < 0 || (curve_count > 0 && (!curves || !out))) return -1;
+    if (contour_count > 0 && !contour_ends) return -1;
+    if (format != UT_CURVE_FORMAT_I16 && format != UT_CURVE_FORMAT_HALF) return -1;
+
+    int next_end = 0;
+    for (int i = 0; i < curve_count; i++) {
+        const float* c = curves + (size_t)i * 8;
+        uint16_t* dst = out + (size_t)i * 6;
+        for (int k = 0; k < 6; k++) {
+            float v = c[k] * scale;
+            if (format == UT_CURVE_FORMAT_HALF) {
+                dst[k] = sdf_float_to_half(v);
+            } else {
+                long q = lrintf(v);
+                if (q < -32768 || q > 32767) return -4;
+                dst[k] = (uint16_t)(int16_t)q;
+            }
+        }
+        while (next_end < contour_count && contour_ends[next_end] < i) next_end++;
+        int end = next_end < contour_count && contour_ends[next_end] == i;
+        dst[2] = (uint16_t)((dst[2] & ~1u) | (end ? 1u : 0u));
+    }
+    return 0;
+}
+
+EXPORT float ut_ft_curve_pack_scale(FT_Face face, int format) {
+    if (!face) return 0.0f;
+    if (format == UT_CURVE_FORMAT_HALF)
+        return 1.0f / (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
+    if (format != UT_CURVE_FORMAT_I16) return 0.0f;
+    long extent = 1;
+    const FT_BBox* b = &face->bbox;
+    FT_Pos edges[4] = { b->xMin, b->yMin, b->xMax, b->yMax };
+    for (int i = 0; i < 4; i++) {
+        long a = edges[i] < 0 ? -(long)edges[i] : (long)edges[i];
+        if (a > extent) extent = a;
+    }
+    int shift = 0;
+    while (shift < 16 && (extent << (shift + 1)) <= 16383) shift++;
+    return (float)(1 << shift);
+}
+
+// Decomposes through ut_ft_outline_decompose into scratch that starts at
+// maxCurves and doubles until the glyph fits (a contour holds at least one
+// curve, so the curve capacity also bounds contours). On -2 *outCurveCount
+// holds the count needed, as on native.
+EXPORT int ut_ft_outline_decompose_packed(FT_Face face, unsigned int glyph_index, int format,
+                                           uint16_t* outCurves, int* outCurveCount, int maxCurves,
+                                           int* outBearingX, int* outBearingY,
+                                           int* outAdvanceX, int* outWidth, int* outHeight)
+{
+    if (!face || !outCurves || !outCurveCount || maxCurves < 0) return -1;
+    float scale = ut_ft_curve_pack_scale(face, format);
+    if (scale == 0.0f) return -1;
+    *outCurveCount = 0;
+
+    int n = maxCurves > 0 ? maxCurves : 1;
+    float* curves;
+    int* contours;
+    int curve_count, contour_count;
+    int rc;
+    for (;;) {
+        curves = (float*)malloc((size_t)n * (8 * sizeof(float) + 2 * sizeof(int)));
+        if (!curves) return -1;
+        int* types = (int*)(curves + (size_t)n * 8);
+        contours = types + n;
+        curve_count = 0;
+        contour_count = 0;
+        rc = ut_ft_outline_decompose(face, glyph_index, curves, types, &curve_count, n,
+                                     contours, &contour_count, n,
+                                     outBearingX, outBearingY, outAdvanceX, outWidth, outHeight);
+        if (rc != -2 || n > (1 << 22)) break;
+        free(curves);
+        n *= 2;
+    }
+    if (!rc && curve_count > maxCurves) {
+        *outCurveCount = curve_count;
+        rc = -2;
+    } else {
+        if (!rc) rc = ut_curves_pack(curves, curve_count, contours, contour_count, format, scale, outCurves);
+        if (!rc) *outCurveCount = curve_count;
+    }
+    free(curves);
+    return rc;
+}
+
+// Outline level of detail (see unitext_native.cpp): level L simplifies the
+// level-0 curves in place to within em/1024 × 4^L design units and drops
+// contours no larger than that.
+
+#include <float.h>
+
+#define UT_OUTLINE_LOD_LEVELS 4
+#define OUTLINE_LOD_MAX_RUN   32   // curves merged into one, at most
+#define OUTLINE_LOD_MAX_STEPS 16   // polyline segments per sampled curve
+
+static float outline_lod_tolerance(FT_Face face, int lod) {
+    float em = (float)(face->units_per_EM > 0 ? face->units_per_EM : 1000);
+    return em * (1.0f / 1024.0f) * (float)(1 << (2 * lod));
+}
+
+// Flattens quadratic q (6 floats) into steps segments, chord error ≲ tol / 4.
+// Writes steps + 1 points (xy pairs) to pts and returns steps.
+static int lod_flatten(const float* q, float tol, float* pts) {
+    float ddx = q[0] - 2.0f * q[2] + q[4], ddy = q[1] - 2.0f * q[3] + q[5];
+    int steps = (int)ceilf(sqrtf(sqrtf(ddx * ddx + ddy * ddy) / tol));
+    steps = steps < 1 ? 1 : (steps > OUTLINE_LOD_MAX_STEPS ? OUTLINE_LOD_MAX_STEPS : steps);
+    for (int i = 0; i <= steps; i++) {
+        float t = (float)i / (float)steps, mt = 1.0f - t;
+        pts[i * 2]     = mt * mt * q[0] + 2.0f * mt * t * q[2] + t * t * q[4];
+        pts[i * 2 + 1] = mt * mt * q[1] + 2.0f * mt * t * q[3] + t * t * q[5];
+    }
+    return steps;
+}
+
+static float lod_polyline_dist_sq(const float* pts, int segments, float px, float py) {
+    float best = FLT_MAX;
+    for (int i = 0; i < segments; i++) {
+        float ax = pts[i * 2], ay = pts[i * 2 + 1];
+        float dx = pts[i * 2 + 2] - ax, dy = pts[i * 2 + 3] - ay;
+        float len_sq = dx * dx + dy * dy;
+        float t = len_sq > 0.0f ? ((px - ax) * dx + (py - ay) * dy) / len_sq : 0.0f;
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        float ex = ax + dx * t - px, ey = ay + dy * t - py;
+        float d = ex * ex + ey * ey;
+        if (d < best) best = d;
+    }
+    return best;
+}
+
+// True when candidate quadratic cand (6 floats) stays within tol of
+// curves[first..last] and they of it, sampled both ways.
+static int lod_fits(const float* curves, int first, int last, const float* cand, float tol) {
+    float run_pts[(OUTLINE_LOD_MAX_RUN * OUTLINE_LOD_MAX_STEPS + 1) * 2];
+    float cand_pts[(OUTLINE_LOD_MAX_STEPS + 1) * 2];
+    int run_segments = 0;
+    for (int i = first; i <= last; i++)
+        run_segments += lod_flatten(curves + (size_t)i * 8, tol, run_pts + run_segments * 2);
+    int cand_segments = lod_flatten(cand, tol, cand_pts);
+
+    float tol_sq = tol * tol;
+    for (int i = 1; i < cand_segments; i++)
+        if (lod_polyline_dist_sq(run_pts, run_segments, cand_pts[i * 2], cand_pts[i * 2 + 1]) > tol_sq)
+            return 0;
+    for (int i = 1; i < run_segments; i++)
+        if (lod_polyline_dist_sq(cand_pts, cand_segments, run_pts[i * 2], run_pts[i * 2 + 1]) > tol_sq)
+            return 0;
+    return 1;
+}
+
+// Single curve for curves[first..last]: a line when that fits, else the
+// quadratic through the run's end tangents. False when neither fits.
+static int lod_merge(const float* curves, int first, int last, float tol, float* out) {
+    const float* a = curves + (size_t)first * 8;
+    const float* b = curves + (size_t)last * 8;
+    float x0 = a[0], y0 = a[1], x1 = b[4], y1 = b[5];
+    out[0] = x0; out[1] = y0; out[4] = x1; out[5] = y1;
+    out[2] = (x0 + x1) * 0.5f;
+    out[3] = (y0 + y1) * 0.5f;
+    if (lod_fits(curves, first, last, out, tol)) return 1;
+
+    // Tangents at the run's ends (the chord when a control point is degenerate).
+    float d0x = a[2] - x0, d0y = a[3] - y0;
+    if (d0x * d0x + d0y * d0y < 1e-12f) { d0x = a[4] - x0; d0y = a[5] - y0; }
+    float d1x = x1 - b[2], d1y = y1 - b[3];
+    if (d1x * d1x + d1y * d1y < 1e-12f) { d1x = x1 - b[0]; d1y = y1 - b[1]; }
+    float den = d0x * d1y - d0y * d1x;
+    if (fabsf(den) < 1e-12f) return 0;
+    float ex = x1 - x0, ey = y1 - y0;
+    float s = (ex * d1y - ey * d1x) / den;
+    float u = (ex * d0y - ey * d0x) / den;
+    if (s <= 0.0f || u <= 0.0f) return 0;
+    out[2] = x0 + d0x * s;
+    out[3] = y0 + d0y * s;
+    return lod_fits(curves, first, last, out, tol);
+}
+
+// Simplifies decomposed curves in place (see above). Contour ends are
+// rewritten to the shortened list; counts shrink, never grow. types may be NULL.
+static void outline_lod_simplify(float* curves, int* types, int* curve_count,
+                                 int* contours, int* contour_count, float tol) {
+    int out_curves = 0, out_contours = 0;
+    int first = 0;
+    for (int c = 0; c < *contour_count; c++) {
+        int last = contours[c];
+
+        float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+        for (int i = first; i <= last; i++) {
+            const float* q = curves + (size_t)i * 8;
+            for (int k = 0; k < 6; k += 2) {
+                min_x = fminf(min_x, q[k]);     max_x = fmaxf(max_x, q[k]);
+                min_y = fminf(min_y, q[k + 1]); max_y = fmaxf(max_y, q[k + 1]);
+            }
+        }
+        if (max_x - min_x <= 2.0f * tol && max_y - min_y <= 2.0f * tol) {
+            first = last + 1;
+            continue;
+        }
+
+        // Writes trail reads (out_curves <= i), so merging in place is safe.
+        for (int i = first; i <= last;) {
+            float merged[6], best[6];
+            memcpy(best, curves + (size_t)i * 8, sizeof(best));
+            int j = i;
+            while (j < last && j + 1 - i < OUTLINE_LOD_MAX_RUN && lod_merge(curves, i, j + 1, tol, merged)) {
+                memcpy(best, merged, sizeof(best));
+                j++;
+            }
+            float* dst = curves + (size_t)out_curves * 8;
+            memcpy(dst, best, sizeof(best));
+            dst[6] = 0;
+            dst[7] = 0;
+            if (types) types[out_curves] = 2;
+            out_curves++;
+            i = j + 1;
+        }
+        contours[out_contours++] = out_curves - 1;
+        first = last + 1;
+    }
+    *curve_count = out_curves;
+    *contour_count = out_contours;
+}
+
+// Coarsest LOD level within 1/8 px for glyphs drawn at pixel_size px per em.
+EXPORT int ut_outline_lod_for_pixel_size(float pixel_size) {
+    int lod = 0;
+    while (lod + 1 < UT_OUTLINE_LOD_LEVELS && pixel_size * (float)(1 << (2 * (lod + 1))) <= 128.0f) lod++;
+    return lod;
+}
+
+// ut_ft_outline_decompose then the simplification pass at half the level's
+// tolerance, like the native path.
+EXPORT int ut_ft_outline_decompose_lod(FT_Face face, unsigned int glyph_index, int lod,
+                                        float* outCurves, int* outTypes,
+                                        int* outCurveCount, int maxCurves,
+                                        int* outContours, int* outContourCount, int maxContours,
+                                        int* outBearingX, int* outBearingY,
+                                        int* outAdvanceX, int* outWidth, int* outHeight)
+{
+    if (!face || lod < 0 || lod >= UT_OUTLINE_LOD_LEVELS) return -1;
+    int rc = ut_ft_outline_decompose(face, glyph_index, outCurves, outTypes, outCurveCount, maxCurves,
+                                     outContours, outContourCount, maxContours,
+                                     outBearingX, outBearingY, outAdvanceX, outWidth, outHeight);
+    if (rc || lod == 0) return rc;
+    outline_lod_simplify(outCurves, outTypes, outCurveCount, outContours, outContourCount,
+                         outline_lod_tolerance(face, lod) * 0.5f);
+    return 0;
+}
+
+// Curve atlas (see unitext_native.cpp): same layout, built on
+// ut_ft_outline_decompose with capacities grown on -2 / -3.
+typedef struct {
+    int error;
+    int curve_offset;
+    int curve_count;
+    int contour_offset;
+    int contour_count;
+    int band_offset;
+    int hband_count;
+    int vband_count;
+    float min_x, min_y;
+    float max_x, max_y;
+    int bearing_x, bearing_y, advance_x, width, height;
+} ut_curve_atlas_glyph;
+
+typedef struct {
+    int glyph_count;
+    int curve_count;
+    int contour_count;
+    int band_count;
+    int band_ref_count;
+    ut_curve_atlas_glyph* glyphs;
+    float* curves;
+    int* contours;
+    int* bands;
+    int* band_refs;
+} ut_curve_atlas;
+
+#define CURVE_ATLAS_MAX_BANDS 64
+
+static int curve_atlas_reserve(void** p, size_t* cap, size_t need, size_t elem) {
+    if (need <= *cap) return 1;
+    size_t grown = *cap ? *cap * 2 : 256;
+    if (grown < need) grown = need;
+    void* q = realloc(*p, grown * elem);
+    if (!q) return 0;
+    *p = q;
+    *cap = grown;
+    return 1;
+}
+
+static int curve_atlas_band(const float* curves, int first, int count, int axis, float lo, float hi,
+                            int* refs, float* keys) {
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        const float* c = curves + (size_t)(first + i) * 8;
+        float a = fminf(fminf(c[axis], c[axis + 2]), c[axis + 4]);
+        float b = fmaxf(fmaxf(c[axis], c[axis + 2]), c[axis + 4]);
+        if (b < lo || a > hi) continue;
+        int o = axis ^ 1;
+        float key = fmaxf(fmaxf(c[o], c[o + 2]), c[o + 4]);
+        int j = n++;
+        while (j > 0 && keys[j - 1] < key) {
+            refs[j] = refs[j - 1];
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        refs[j] = first + i;
+        keys[j] = key;
+    }
+    return n;
+}
+
+EXPORT int ut_ft_outline_decompose_batch_lod(FT_Face face, const unsigned int* glyph_indices, int count,
+                                              int bands, int lod, ut_curve_atlas** out_atlas) {
+    if (!out_atlas) return -1;
+    *out_atlas = NULL;
+    if (!face || !glyph_indices || count < 0 || lod < 0 || lod >= UT_OUTLINE_LOD_LEVELS) return -1;
+    if (bands < 1) bands = 1;
+    if (bands > CURVE_ATLAS_MAX_BANDS) bands = CURVE_ATLAS_MAX_BANDS;
+
+    ut_curve_atlas_glyph* glyphs = (ut_curve_atlas_glyph*)calloc(count > 0 ? count : 1, sizeof(ut_curve_atlas_glyph));
+    float* curves = NULL;
+    int* types = NULL;
+    int* contours = NULL;
+    int* band_list = NULL;
+    int* refs = NULL;
+    float* keys = NULL;
+    size_t curve_cap = 0, type_cap = 0, contour_cap = 0, band_cap = 0, ref_cap = 0, key_cap = 0;
+    size_t curve_total = 0, contour_total = 0, band_total = 0, ref_total = 0;
+    int max_curves = 256, max_contours = 32;
+    int first_error = 0;
+    int oom = !glyphs;
+
+    for (int g = 0; g < count && !oom; g++) {
+        ut_curve_atlas_glyph* ag = &glyphs[g];
+        ag->curve_offset = (int)curve_total;
+        ag->contour_offset = (int)contour_total;
+        ag->band_offset = (int)band_total;
+
+        int nc = 0, nk = 0, rc;
+        for (;;) {
+            if (!curve_atlas_reserve((void**)&curves, &curve_cap, curve_total + max_curves, 8 * sizeof(float))
+                || !curve_atlas_reserve((void**)&types, &type_cap, (size_t)max_curves, sizeof(int))
+                || !curve_atlas_reserve((void**)&contours, &contour_cap, contour_total + max_contours, sizeof(int))) {
+                oom = 1;
+                break;
+            }
+            rc = ut_ft_outline_decompose_lod(face, glyph_indices[g], lod, curves + curve_total * 8, types, &nc,
+                                             max_curves, contours + contour_total, &nk, max_contours,
+                                             &ag->bearing_x, &ag->bearing_y, &ag->advance_x, &ag->width, &ag->height);
+            if (rc == -2 && max_curves < (1 << 24)) max_curves *= 2;
+            else if (rc == -3 && max_contours < (1 << 20)) max_contours *= 2;
+            else break;
+        }
+        if (oom) break;
+        if (rc) {
+            ag->error = rc;
+            if (!first_error) first_error = rc;
+            continue;
+        }
+        if (nc == 0) continue;
+
+        int nb = bands < nc ? bands : nc;
+        if (!curve_atlas_reserve((void**)&band_list, &band_cap, band_total + (size_t)nb * 2, 2 * sizeof(int))
+            || !curve_atlas_reserve((void**)&refs, &ref_cap, ref_total + (size_t)nc * nb * 2, sizeof(int))
+            || !curve_atlas_reserve((void**)&keys, &key_cap, (size_t)nc, sizeof(float))) {
+            oom = 1;
+            break;
+        }
+
+        const float* gc = curves + curve_total * 8;
+        float min_x = gc[0], max_x = gc[0], min_y = gc[1], max_y = gc[1];
+        for (int i = 0; i < nc; i++) {
+            const float* c = gc + (size_t)i * 8;
+            for (int k = 0; k < 6; k += 2) {
+                min_x = fminf(min_x, c[k]);     max_x = fmaxf(max_x, c[k]);
+                min_y = fminf(min_y, c[k + 1]); max_y = fmaxf(max_y, c[k + 1]);
+            }
+        }
+        ag->min_x = min_x; ag->min_y = min_y;
+        ag->max_x = max_x; ag->max_y = max_y;
+
+        for (int axis = 1; axis >= 0; axis--) {
+            float lo = axis ? min_y : min_x;
+            float step = ((axis ? max_y : max_x) - lo) / (float)nb;
+            for (int b = 0; b < nb; b++) {
+                int n = curve_atlas_band(curves, (int)curve_total, nc, axis, lo + step * b, lo + step * (b + 1),
+                                         refs + ref_total, keys);
+                band_list[band_total * 2]     = (int)ref_total;
+                band_list[band_total * 2 + 1] = n;
+                band_total++;
+                ref_total += n;
+            }
+        }
+
+        ag->curve_count   = nc;
+        ag->contour_count = nk;
+        ag->hband_count   = nb;
+        ag->vband_count   = nb;
+        curve_total   += nc;
+        contour_total += nk;
+    }
+
+    ut_curve_atlas* atlas = NULL;
+    if (!oom) {
+        size_t size = sizeof(ut_curve_atlas)
+                    + (size_t)count * sizeof(ut_curve_atlas_glyph)
+                    + curve_total * 8 * sizeof(float)
+                    + contour_total * sizeof(int)
+                    + band_total * 2 * sizeof(int)
+                    + ref_total * sizeof(int);
+        atlas = (ut_curve_atlas*)malloc(size);
+        if (atlas) {
+            atlas->glyph_count    = count;
+            atlas->curve_count    = (int)curve_total;
+            atlas->contour_count  = (int)contour_total;
+            atlas->band_count     = (int)band_total;
+            atlas->band_ref_count = (int)ref_total;
+            atlas->glyphs    = (ut_curve_atlas_glyph*)(atlas + 1);
+            atlas->curves    = (float*)(atlas->glyphs + count);
+            atlas->contours  = (int*)(atlas->curves + curve_total * 8);
+            atlas->bands     = atlas->contours + contour_total;
+            atlas->band_refs = atlas->bands + band_total * 2;
+            memcpy(atlas->glyphs, glyphs, (size_t)count * sizeof(ut_curve_atlas_glyph));
+            if (curve_total) memcpy(atlas->curves, curves, curve_total * 8 * sizeof(float));
+            if (contour_total) memcpy(atlas->contours, contours, contour_total * sizeof(int));
+            if (band_total) memcpy(atlas->bands, band_list, band_total * 2 * sizeof(int));
+            if (ref_total) memcpy(atlas->band_refs, refs, ref_total * sizeof(int));
+        }
+    }
+
+    free(glyphs);
+    free(curves);
+    free(types);
+    free(contours);
+    free(band_list);
+    free(refs);
+    free(keys);
+    if (!atlas) return -1;
+    *out_atlas = atlas;
+    return first_error;
+}
+
+EXPORT int ut_ft_outline_decompose_batch(FT_Face face, const unsigned int* glyph_indices, int count,
+                                          int bands, ut_curve_atlas** out_atlas) {
+    return ut_ft_outline_decompose_batch_lod(face, glyph_indices, count, bands, 0, out_atlas);
+}
+
+EXPORT void ut_curve_atlas_free(ut_curve_atlas* atlas) {
+    free(atlas);
+}
+
 // =============================================================================
 // COLRv1 Stubs (not supported on WebGL)
 // =============================================================================
@@ -892,6 +2497,24 @@ EXPORT int ut_ft_outline_to_blpath(FT_Face face, void* blPath) {
     return 0;
 }
 
+EXPORT int ut_ft_glyph_to_blpath(FT_Face face, unsigned int glyph_index, double scale_x, double scale_y,
+                                 void* blPath) {
+    return 0;
+}
+
+// No outline cache on WebGL — enabling succeeds and every load goes to FreeType.
+EXPORT int ut_ft_outline_cache_enable(FT_Face face, long max_bytes) {
+    return face ? 0 : -1;
+}
+
+EXPORT void ut_ft_outline_cache_stats(FT_Face face, int* out_entries, long* out_bytes,
+                                      unsigned int* out_hits, unsigned int* out_misses) {
+    if (out_entries) *out_entries = 0;
+    if (out_bytes) *out_bytes = 0;
+    if (out_hits) *out_hits = 0;
+    if (out_misses) *out_misses = 0;
+}
+
 EXPORT int ut_ft_get_outline_info(FT_Face face, int* numContours, int* numPoints) {
     if (numContours) *numContours = 0;
     if (numPoints) *numPoints = 0;